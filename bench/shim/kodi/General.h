@@ -0,0 +1,35 @@
+#pragma once
+
+// Stand-in for the dev kit's <kodi/General.h> so the Kodi-free parsers can be built into
+// pvr_bench without Kodi. Only logging is provided: messages are dropped unless
+// PVR_BENCH_VERBOSE is set, in which case they go to stderr.
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+typedef enum ADDON_LOG
+{
+  ADDON_LOG_DEBUG = 0,
+  ADDON_LOG_INFO = 1,
+  ADDON_LOG_WARNING = 2,
+  ADDON_LOG_ERROR = 3,
+  ADDON_LOG_FATAL = 4
+} ADDON_LOG;
+
+namespace kodi
+{
+inline void Log(const ADDON_LOG loglevel, const char* format, ...)
+{
+  static const bool verbose = std::getenv("PVR_BENCH_VERBOSE") != nullptr;
+  if (!verbose)
+    return;
+  static const char* const kLevels[] = {"debug", "info", "warning", "error", "fatal"};
+  std::fprintf(stderr, "[%s] ", kLevels[loglevel]);
+  va_list args;
+  va_start(args, format);
+  std::vfprintf(stderr, format, args);
+  va_end(args);
+  std::fputc('\n', stderr);
+}
+} // namespace kodi
@@ -10,10 +10,14 @@
 #include <cstdint>
 #include <condition_variable>
 #include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
+#include <random>
 #include <string>
 #include <string_view>
 #include <thread>
@@ -21,7 +25,18 @@
 #include <vector>
 
 #include "xtream_client.h"
+#include "channel_cache.h"
+#include "channel_name.h"
+#include "name_filter.h"
+#include "perf_stats.h"
+#include "stream_table.h"
+#include "xmltv_parser.h"
+#include "epg_store.h"
+#include "epg_name_match.h"
+#include "icon_cache.h"
+#include "redirect_cache.h"
 #include "dispatcharr_client.h"
+#include "memory_budget.h"
 
 namespace
 {
@@ -43,12 +58,33 @@ std::string ToLower(std::string s)
   return s;
 }
 
-uint64_t DeterministicHash64(std::string_view s)
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+
+// Scheduled refreshes are spread by +/- this fraction of their interval.
+constexpr double kRefreshJitter = 0.1;
+// Failed loads are retried after 30 s, doubling up to 30 min.
+constexpr int64_t kRetryBaseSeconds = 30;
+constexpr int64_t kRetryMaxSeconds = 30 * 60;
+// With an EPG horizon, an unchanged guide whose horizon was cut this long ago is
+// fetched and parsed again so the window keeps moving with the clock.
+constexpr int64_t kEpgHorizonSlideSeconds = 12 * 60 * 60;
+
+// Automatic epg_parse_threads: the available cores up to eight, but one on 32-bit ARM,
+// where the boxes are low-end and the parse competes with playback.
+unsigned DefaultEpgParseThreads()
+{
+#if (defined(__arm__) && !defined(__aarch64__)) || defined(_M_ARM)
+  return 1;
+#else
+  return std::max(1u, std::min(std::thread::hardware_concurrency(), 8u));
+#endif
+}
+
+uint64_t DeterministicHash64(std::string_view s, uint64_t h = kFnvOffset)
 {
-  // FNV-1a 64-bit for stability across processes/platforms.
+  // FNV-1a 64-bit for stability across processes/platforms. Pass a previous result as
+  // `h` to hash several pieces as one.
   constexpr uint64_t kPrime = 1099511628211ULL;
-  constexpr uint64_t kOffset = 14695981039346656037ULL;
-  uint64_t h = kOffset;
   for (unsigned char c : s)
   {
     h ^= static_cast<uint64_t>(c);
@@ -65,95 +101,100 @@ std::string HashHex(std::string_view s)
   return std::string(buf);
 }
 
-bool ReadAll(kodi::vfs::CFile& file, std::string& out)
-{
-  out.clear();
-  char buf[16 * 1024];
-  while (true)
-  {
-    const ssize_t n = file.Read(buf, sizeof(buf));
-    if (n <= 0)
-      break;
-    out.append(buf, static_cast<size_t>(n));
-  }
-  return true;
-}
-
-bool ReadVfsTextFile(const std::string& url, std::string& out)
-{
-  out.clear();
-  kodi::vfs::CFile file;
-  file.CURLCreate(url);
-  if (!file.CURLOpen(0))
-    return false;
-  ReadAll(file, out);
-  return true;
-}
-
-std::string TranslateSpecial(const std::string& url)
+// Everything the XMLTV channel mapping reads from the stream list. A guide is only
+// reusable for an unchanged XMLTV body if this matches too.
+uint64_t EpgStreamsHash(const xtream::StreamTable& streams)
 {
-  try
-  {
-    return kodi::vfs::TranslateSpecialProtocol(url);
-  }
-  catch (...)
+  uint64_t h = kFnvOffset;
+  for (const auto& s : streams)
   {
-    return {};
+    h = DeterministicHash64(std::to_string(s.id), h);
+    h = DeterministicHash64(std::string_view("\x1f", 1), h);
+    h = DeterministicHash64(s.name, h);
+    h = DeterministicHash64(std::string_view("\x1f", 1), h);
+    h = DeterministicHash64(s.epgChannelId, h);
+    h = DeterministicHash64(std::string_view("\x1e", 1), h);
   }
+  return h;
 }
 
-constexpr uint32_t kCacheMagic = 0x31435458; // 'XTC1' little-endian
-
-void AppendU32(std::string& out, uint32_t v)
+// One XMLTV source's part of the held guide: what its next request is conditional on
+// and what it was mapped with.
+struct EpgSourceState
 {
-  out.push_back(static_cast<char>(v & 0xFF));
-  out.push_back(static_cast<char>((v >> 8) & 0xFF));
-  out.push_back(static_cast<char>((v >> 16) & 0xFF));
-  out.push_back(static_cast<char>((v >> 24) & 0xFF));
-}
+  xtream::XmltvValidators validators; // validators of the XMLTV body it came from
+  uint64_t streamsHash = 0;           // EpgStreamsHash of the streams it was mapped onto
+  int64_t horizonAnchor = 0;          // time its EPG horizon was measured from
+  int daysPast = -1;                  // horizon it was parsed with, which the memory
+  int daysFuture = -1;                // budget may narrow; -1 = unknown
+};
 
-void AppendI32(std::string& out, int32_t v)
+// Source state stored in epg.cache: one value per line, one block per XMLTV source. The
+// horizon anchor is the time the guide's EPG horizon was measured from (xmltv1 states
+// predate it and read as 0); the horizon days came with xmltv3.
+std::string SerializeEpgSourceState(const EpgSourceState& s)
 {
-  AppendU32(out, static_cast<uint32_t>(v));
+  char hashes[128];
+  std::snprintf(hashes, sizeof(hashes), "%016llx\n%016llx\n%lld\n%d %d\n",
+                static_cast<unsigned long long>(s.validators.bodyHash),
+                static_cast<unsigned long long>(s.streamsHash), static_cast<long long>(s.horizonAnchor),
+                s.daysPast, s.daysFuture);
+  return "xmltv3\n" + s.validators.etag + "\n" + s.validators.lastModified + "\n" + hashes;
 }
 
-void AppendU64(std::string& out, uint64_t v)
+std::string SerializeEpgSourceStates(const std::vector<EpgSourceState>& sources)
 {
-  for (int i = 0; i < 8; ++i)
-    out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+  std::string out;
+  for (const auto& s : sources)
+    out += SerializeEpgSourceState(s);
+  return out;
 }
 
-bool ReadU32(const std::string& in, size_t& off, uint32_t& out)
+bool ParseEpgSourceStates(const std::string& in, std::vector<EpgSourceState>& sources)
 {
-  if (off + 4 > in.size())
-    return false;
-  out = static_cast<uint32_t>(static_cast<unsigned char>(in[off])) |
-        (static_cast<uint32_t>(static_cast<unsigned char>(in[off + 1])) << 8) |
-        (static_cast<uint32_t>(static_cast<unsigned char>(in[off + 2])) << 16) |
-        (static_cast<uint32_t>(static_cast<unsigned char>(in[off + 3])) << 24);
-  off += 4;
-  return true;
-}
+  std::vector<std::string> lines;
+  size_t start = 0;
+  while (start < in.size())
+  {
+    const size_t nl = in.find('\n', start);
+    if (nl == std::string::npos)
+      break;
+    lines.push_back(in.substr(start, nl - start));
+    start = nl + 1;
+  }
+  if (lines.size() == 5 && lines[0] == "xmltv1")
+    lines.emplace_back("0");
 
-bool ReadI32(const std::string& in, size_t& off, int32_t& out)
-{
-  uint32_t u = 0;
-  if (!ReadU32(in, off, u))
-    return false;
-  out = static_cast<int32_t>(u);
-  return true;
+  sources.clear();
+  for (size_t i = 0; i < lines.size();)
+  {
+    const size_t count = lines[i] == "xmltv3" ? 7 : (lines[i] == "xmltv1" || lines[i] == "xmltv2") ? 6 : 0;
+    if (count == 0 || i + count > lines.size())
+      return false;
+    EpgSourceState s;
+    s.validators.etag = lines[i + 1];
+    s.validators.lastModified = lines[i + 2];
+    s.validators.bodyHash = std::strtoull(lines[i + 3].c_str(), nullptr, 16);
+    s.streamsHash = std::strtoull(lines[i + 4].c_str(), nullptr, 16);
+    s.horizonAnchor = std::strtoll(lines[i + 5].c_str(), nullptr, 10);
+    if (count == 7 && std::sscanf(lines[i + 6].c_str(), "%d %d", &s.daysPast, &s.daysFuture) != 2)
+      s.daysPast = s.daysFuture = -1;
+    sources.push_back(std::move(s));
+    i += count;
+  }
+  return !sources.empty();
 }
 
-bool ReadU64(const std::string& in, size_t& off, uint64_t& out)
+std::string TranslateSpecial(const std::string& url)
 {
-  if (off + 8 > in.size())
-    return false;
-  uint64_t v = 0;
-  for (int i = 0; i < 8; ++i)
-    v |= (static_cast<uint64_t>(static_cast<unsigned char>(in[off + i])) << (8 * i));
-  off += 8;
-  out = v;
-  return true;
+  try
+  {
+    return kodi::vfs::TranslateSpecialProtocol(url);
+  }
+  catch (...)
+  {
+    return {};
+  }
 }
 
 bool ReadFileToString(const std::string& path, std::string& out)
@@ -206,29 +247,54 @@ bool WriteStringToFileAtomic(const std::string& path, const std::string& data)
   }
 }
 
-bool ExtractSettingValue(const std::string& xml, const char* id, std::string& out)
+// Everything EnsureLoaded needs from the settings, resolved once per change. Published
+// as an immutable shared_ptr; readers take it with a single atomic load.
+struct SettingsSnapshot
 {
-  out.clear();
-  const std::string needle = std::string("<setting id=\"") + id + "\"";
-  size_t pos = xml.find(needle);
-  if (pos == std::string::npos)
-    return false;
-
-  pos = xml.find('>', pos);
-  if (pos == std::string::npos)
-    return false;
-  ++pos;
-
-  // Handle self-closing settings e.g. <setting id="x" default="true" />
-  if (pos < xml.size() && xml[pos - 1] == '/' && xml[pos] == '>')
-    return true;
+  uint64_t version = 0;
+  xtream::Settings xt;
+  bool haveCredentials = false;
+  std::string streamFormat;       // lower case, "ts" if unset
+  std::string channelNumbering;   // lower case, "sequential" if unset
+  std::string categoryFilterMode; // lower case, "all" if unset
+  std::string signature;          // identifies the channel/EPG data these settings produce
+};
 
-  const size_t end = xml.find("</setting>", pos);
-  if (end == std::string::npos)
-    return false;
+std::shared_ptr<const SettingsSnapshot> MakeSettingsSnapshot(const xtream::Settings& xt,
+                                                             uint64_t version)
+{
+  auto snap = std::make_shared<SettingsSnapshot>();
+  snap->version = version;
+  snap->xt = xt;
+  snap->haveCredentials = !Trim(xt.server).empty() && !Trim(xt.username).empty() &&
+                          !Trim(xt.password).empty() && (xt.port > 0 && xt.port <= 65535);
+  snap->streamFormat = xt.streamFormat.empty() ? "ts" : ToLower(xt.streamFormat);
+  snap->channelNumbering = xt.channelNumbering.empty() ? "sequential" : ToLower(xt.channelNumbering);
+  snap->categoryFilterMode = xt.categoryFilterMode.empty() ? "all" : ToLower(xt.categoryFilterMode);
+  snap->signature = xt.server + ":" + std::to_string(xt.port) + "/" + xt.username + "/" +
+                    HashHex(xt.password) + "|fmt=" + snap->streamFormat + "|num=" +
+                    snap->channelNumbering + "|flt=" + HashHex(xt.channelFilterPatterns) +
+                    "|catmode=" + snap->categoryFilterMode + "|catflt=" +
+                    HashHex(xt.categoryFilterPatterns) + "|sep=" +
+                    (xt.filterChannelSeparators ? "1" : "0");
+  // Only present with a custom or supplementary guide, so existing caches stay valid
+  // without them.
+  if (!Trim(xt.xmltvUrl).empty())
+    snap->signature += "|xmltv=" + HashHex(Trim(xt.xmltvUrl));
+  if (!Trim(xt.xmltvExtraUrls).empty())
+    snap->signature += "|xmltvx=" + HashHex(Trim(xt.xmltvExtraUrls));
+  return snap;
+}
 
-  out = Trim(xml.substr(pos, end - pos));
-  return true;
+// `settings` as a refresh builds the guide under the memory plan `modes`. Only the guide
+// paths see this copy; the stored and published settings stay as the user configured.
+xtream::Settings WithMemoryModes(xtream::Settings settings, const xtream::MemoryModes& modes)
+{
+  settings.epgStreamingParse = modes.streamingParse;
+  settings.epgLazyText = modes.lazyText;
+  settings.epgDaysPast = modes.daysPast;
+  settings.epgDaysFuture = modes.daysFuture;
+  return settings;
 }
 
 std::vector<std::string> SplitPatterns(const std::string& raw)
@@ -253,7 +319,19 @@ std::vector<std::string> SplitPatterns(const std::string& raw)
   return out;
 }
 
-bool LooksLikeChannelSeparator(const std::string& name)
+// Up to this many channels Kodi is handed the provider's logo URLs directly. Larger
+// lists only get logos from the local icon cache, filled in the background, since
+// thousands of remote textures stall Kodi's UI.
+constexpr size_t kDirectIconLimit = 800;
+
+// Logo downloads run beside playback, guide loads and refreshes, so they stay narrow.
+constexpr unsigned kIconFetchParallel = 2;
+
+// How long a neighbour's resolved stream URL is offered for a zap. Edge URLs usually
+// carry a token, so this stays short.
+constexpr std::chrono::seconds kZapRedirectTtl{30};
+
+bool LooksLikeChannelSeparator(std::string_view name)
 {
   int run = 0;
   for (unsigned char ch : name)
@@ -269,65 +347,6 @@ bool LooksLikeChannelSeparator(const std::string& name)
   }
   return false;
 }
-
-// Case-insensitive wildcard match: '*' matches any sequence.
-bool WildcardMatchLower(const std::string& patternLower, const std::string& textLower)
-{
-  size_t p = 0;
-  size_t t = 0;
-  size_t star = std::string::npos;
-  size_t match = 0;
-  while (t < textLower.size())
-  {
-    if (p < patternLower.size() && (patternLower[p] == textLower[t]))
-    {
-      ++p;
-      ++t;
-      continue;
-    }
-    if (p < patternLower.size() && patternLower[p] == '*')
-    {
-      star = p++;
-      match = t;
-      continue;
-    }
-    if (star != std::string::npos)
-    {
-      p = star + 1;
-      t = ++match;
-      continue;
-    }
-    return false;
-  }
-  while (p < patternLower.size() && patternLower[p] == '*')
-    ++p;
-  return p == patternLower.size();
-}
-
-bool PatternMatchesLower(const std::string& patternLower, const std::string& textLower)
-{
-  if (patternLower.empty())
-    return false;
-  if (patternLower.find('*') != std::string::npos)
-    return WildcardMatchLower(patternLower, textLower);
-  // If no wildcard is present, treat the pattern as a substring match for usability.
-  return textLower.find(patternLower) != std::string::npos;
-}
-
-bool ShouldFilterOut(const std::vector<std::string>& patternsLower, const std::string& name)
-{
-  if (patternsLower.empty())
-    return false;
-  const std::string nameLower = ToLower(name);
-  for (const auto& pat : patternsLower)
-  {
-    if (pat.empty())
-      continue;
-    if (PatternMatchesLower(pat, nameLower))
-      return true;
-  }
-  return false;
-}
 }
 
 class ATTR_DLL_LOCAL CXtreamCodesPVRClient final : public kodi::addon::CInstancePVRClient
@@ -344,26 +363,52 @@ public:
   {
     m_stopRequested = true;
     m_cv.notify_all();
+    {
+      // Orders the flag before the icon thread's next wait.
+      std::lock_guard<std::mutex> lock(m_mutex);
+    }
+    m_iconCv.notify_all();
     if (m_bootstrap.joinable())
       m_bootstrap.join();
     if (m_worker.joinable())
       m_worker.join();
+    if (m_iconThread.joinable())
+      m_iconThread.join();
+    // Joins the DVR refresh thread while its listener can still reach this object.
+    std::atomic_store(&m_dispatcharrClient, std::shared_ptr<dispatcharr::Client>());
   }
 
+  // Publishes a new settings snapshot. Called on startup and from every SetSetting
+  // notification; EnsureLoaded only ever reads the published snapshot.
   void SetSettingsOverride(const xtream::Settings& settings)
   {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_settingsOverride = settings;
-    m_hasSettingsOverride = true;
-    // Also update m_xtreamSettings so that immediate operations (like catchup URL generation)
-    // use the latest settings without waiting for a full reload
-    m_xtreamSettings = settings;
-  }
-
-  void ClearSettingsOverride()
-  {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    m_hasSettingsOverride = false;
+    std::atomic_store(&m_settingsSnapshot, MakeSettingsSnapshot(settings, ++m_settingsVersion));
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      const bool intervalsChanged = settings.channelRefreshMinutes != m_xtreamSettings.channelRefreshMinutes ||
+                                    settings.epgRefreshMinutes != m_xtreamSettings.epgRefreshMinutes;
+      // The horizon isn't part of the signature: only the guide depends on it, and each
+      // source's cache state records the horizon it was parsed with.
+      const bool horizonChanged = settings.epgDaysPast != m_xtreamSettings.epgDaysPast ||
+                                  settings.epgDaysFuture != m_xtreamSettings.epgDaysFuture;
+      // Also publish the settings so that immediate operations (like catchup URL generation)
+      // use the latest settings without waiting for a full reload
+      m_xtreamSettings = settings;
+      PublishLocked([&](Snapshot& next) { next.settings = settings; });
+      // A running load schedules from m_xtreamSettings when it finishes, so it picks the
+      // new intervals up by itself; a new horizon is applied by ApplyPendingHorizonLocked.
+      if ((!intervalsChanged && !horizonChanged) || !m_dataLoaded || m_loading)
+        return;
+      // New intervals count from now; pending retries keep their backoff.
+      if (intervalsChanged && m_channelFailures == 0)
+        ScheduleChannelRefreshLocked(true);
+      if (intervalsChanged && m_epgFailures == 0)
+        ScheduleEpgRefreshLocked(true);
+      // A new horizon rebuilds the guide now, from a fresh download; the channels stay.
+      if (horizonChanged)
+        m_nextEpgRefresh = std::chrono::steady_clock::now();
+    }
+    m_cv.notify_all();
   }
 
   PVR_ERROR GetCapabilities(kodi::addon::PVRCapabilities& capabilities) override
@@ -418,41 +463,48 @@ public:
 
   PVR_ERROR GetConnectionString(std::string& connection) override
   {
-    xtream::Settings s = xtream::LoadSettings();
-    connection = s.server;
+    const auto snap = CurrentSettings();
+    connection = snap->xt.server;
     return PVR_ERROR_NO_ERROR;
   }
 
   PVR_ERROR GetChannelsAmount(int& amount) override
   {
     EnsureLoaded();
-    std::shared_ptr<const ChannelList> channels;
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      channels = m_channels;
-    }
-    amount = channels ? static_cast<int>(channels->size()) : 0;
+    const auto snap = CurrentSnapshot();
+    amount = snap->channels ? static_cast<int>(snap->channels->size()) : 0;
     return PVR_ERROR_NO_ERROR;
   }
 
   PVR_ERROR GetChannels(bool radio, kodi::addon::PVRChannelsResultSet& results) override
   {
+    const xtream::perf::ScopedCallback timing(xtream::perf::Callback::GetChannels);
     if (radio)
       return PVR_ERROR_NO_ERROR;
 
     EnsureLoaded();
     const auto t0 = std::chrono::steady_clock::now();
 
-    std::shared_ptr<const ChannelList> channels;
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      channels = m_channels;
-    }
+    const auto snap = CurrentSnapshot();
+    const std::shared_ptr<const ChannelList>& channels = snap->channels;
     if (!channels)
       return PVR_ERROR_NO_ERROR;
 
-    for (const auto& ch : *channels)
-      results.Add(ch);
+    // Logos fetched after the list was published are laid over it here rather than
+    // republished as a copy of the whole list.
+    const IconOverlay* icons = snap->channelIcons.get();
+    size_t nextIcon = 0;
+    for (size_t i = 0; i < channels->size(); ++i)
+    {
+      if (icons && nextIcon < icons->size() && (*icons)[nextIcon].first == i)
+      {
+        kodi::addon::PVRChannel ch = (*channels)[i];
+        ch.SetIconPath((*icons)[nextIcon++].second);
+        results.Add(ch);
+      }
+      else
+        results.Add((*channels)[i]);
+    }
 
     const auto t1 = std::chrono::steady_clock::now();
     const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
@@ -467,11 +519,13 @@ public:
     if (deleted)
       return PVR_ERROR_NO_ERROR;
 
-    if (!m_dispatcharrClient)
+    const auto dvr = DvrClient();
+    if (!dvr)
       return PVR_ERROR_SERVER_ERROR;
 
-    std::vector<dispatcharr::Recording> recordings;
-    if (!m_dispatcharrClient->FetchRecordings(recordings))
+    // Shared with GetTimers, which Kodi calls alongside.
+    const auto state = dvr->GetDvrState();
+    if (!state->recordingsOk)
     {
        // If fetch fails (e.g. auth error, or server not supporting it), 
        // just log and return OK with empty list to avoiding nagging user?
@@ -487,7 +541,7 @@ public:
     // We'll filter by StartTime <= Now.
     time_t now = time(nullptr);
 
-    for (const auto& r : recordings)
+    for (const auto& r : state->recordings)
     {
        if (r.startTime > now) 
          continue;
@@ -509,11 +563,15 @@ public:
 
   PVR_ERROR DeleteRecording(const kodi::addon::PVRRecording& recording) override
   {
-      if (!m_dispatcharrClient) return PVR_ERROR_SERVER_ERROR;
+      const auto dvr = DvrClient();
+      if (!dvr) return PVR_ERROR_SERVER_ERROR;
       try {
         int id = std::stoi(recording.GetRecordingId());
-        if (m_dispatcharrClient->DeleteRecording(id))
+        if (dvr->DeleteRecording(id))
+        {
+            NotifyDvrChanged();
             return PVR_ERROR_NO_ERROR;
+        }
       } catch (...) {}
       return PVR_ERROR_FAILED;
   }
@@ -547,12 +605,15 @@ public:
 
   PVR_ERROR GetTimers(kodi::addon::PVRTimersResultSet& results) override
   {
-      if (!m_dispatcharrClient) return PVR_ERROR_SERVER_ERROR;
+      const auto dvr = DvrClient();
+      if (!dvr) return PVR_ERROR_SERVER_ERROR;
+
+      // All three lists come from one cached, concurrently fetched state.
+      const auto state = dvr->GetDvrState();
 
       // 1. Series Rules (Type 2)
-      std::vector<dispatcharr::SeriesRule> series;
-      if (m_dispatcharrClient->FetchSeriesRules(series)) {
-          for (const auto& s : series) {
+      if (state->seriesRulesOk) {
+          for (const auto& s : state->seriesRules) {
               kodi::addon::PVRTimer t;
               // Use encoded ID to store info needed for delete
               // Format: series|<tvg_id>
@@ -566,9 +627,8 @@ public:
       }
 
       // 2. Recurring Rules (Type 3)
-      std::vector<dispatcharr::RecurringRule> recurring;
-      if (m_dispatcharrClient->FetchRecurringRules(recurring)) {
-          for (const auto& r : recurring) {
+      if (state->recurringRulesOk) {
+          for (const auto& r : state->recurringRules) {
               kodi::addon::PVRTimer t;
               t.SetTimerId("rule|" + std::to_string(r.id));
               t.SetTitle(r.name.empty() ? "Recurring" : r.name);
@@ -583,10 +643,9 @@ public:
       }
 
       // 3. Scheduled Recordings (Type 1)
-      std::vector<dispatcharr::Recording> recs;
-      if (m_dispatcharrClient->FetchRecordings(recs)) {
+      if (state->recordingsOk) {
           time_t now = time(nullptr);
-          for (const auto& r : recs) {
+          for (const auto& r : state->recordings) {
               if (r.startTime <= now) continue; 
               
               kodi::addon::PVRTimer t;
@@ -606,7 +665,8 @@ public:
 
   PVR_ERROR AddTimer(const kodi::addon::PVRTimer& timer) override
   {
-      if (!m_dispatcharrClient) return PVR_ERROR_SERVER_ERROR;
+      const auto dvr = DvrClient();
+      if (!dvr) return PVR_ERROR_SERVER_ERROR;
 
       int typeId = timer.GetTimerTypeId();
       
@@ -614,16 +674,11 @@ public:
       unsigned int chanUid = timer.GetChannelUid();
       std::string tvgId;
       
-      {
-         std::lock_guard<std::mutex> lock(m_mutex);
-         if (m_streams) {
-             for(const auto& s : *m_streams) {
-                 if (static_cast<unsigned int>(s.id) == chanUid) {
-                     tvgId = s.epgChannelId;
-                     break;
-                 }
-             }
-         }
+      const auto snap = CurrentSnapshot();
+      const std::shared_ptr<const xtream::StreamTable>& streams = snap->streams;
+      if (streams) {
+          if (const xtream::LiveStream* s = streams->FindByUid(chanUid))
+              tvgId = std::string(s->epgChannelId);
       }
 
       if (typeId == 2) // Series
@@ -634,8 +689,11 @@ public:
           }
           std::string title = timer.GetTitle(); 
           // If title is empty?
-          if (m_dispatcharrClient->AddSeriesRule(tvgId, title, "new"))
+          if (dvr->AddSeriesRule(tvgId, title, "new"))
+          {
+              NotifyDvrChanged();
               return PVR_ERROR_NO_ERROR;
+          }
       }
       else if (typeId == 3) // Recurring
       {
@@ -665,13 +723,19 @@ public:
           r.startDate = "2026-01-01"; // Dummy defaults as we don't present UI for date ranges in Kodi easily
           r.endDate = "2030-01-01";
           
-          if (m_dispatcharrClient->AddRecurringRule(r))
+          if (dvr->AddRecurringRule(r))
+          {
+              NotifyDvrChanged();
               return PVR_ERROR_NO_ERROR;
+          }
       }
       else // One-shot (Type 1 or default)
       {
-          if (m_dispatcharrClient->ScheduleRecording(chanUid, timer.GetStartTime(), timer.GetEndTime(), timer.GetTitle()))
+          if (dvr->ScheduleRecording(chanUid, timer.GetStartTime(), timer.GetEndTime(), timer.GetTitle()))
+          {
+              NotifyDvrChanged();
               return PVR_ERROR_NO_ERROR;
+          }
       }
 
       return PVR_ERROR_FAILED;
@@ -679,7 +743,8 @@ public:
 
   PVR_ERROR DeleteTimer(const kodi::addon::PVRTimer& timer, bool force) override
   {
-      if (!m_dispatcharrClient) return PVR_ERROR_SERVER_ERROR;
+      const auto dvr = DvrClient();
+      if (!dvr) return PVR_ERROR_SERVER_ERROR;
 
       std::string tid = timer.GetTimerId();
       // Format: prefix|id
@@ -689,31 +754,37 @@ public:
       std::string type = tid.substr(0, pos);
       std::string idVal = tid.substr(pos + 1);
 
+      bool deleted = false;
       if (type == "series") {
-          if (m_dispatcharrClient->DeleteSeriesRule(idVal)) return PVR_ERROR_NO_ERROR;
+          deleted = dvr->DeleteSeriesRule(idVal);
       } else if (type == "rule") {
-          if (m_dispatcharrClient->DeleteRecurringRule(std::atoi(idVal.c_str()))) return PVR_ERROR_NO_ERROR;
+          deleted = dvr->DeleteRecurringRule(std::atoi(idVal.c_str()));
       } else if (type == "rec") {
           // Cancel scheduled recording
-          if (m_dispatcharrClient->DeleteRecording(std::atoi(idVal.c_str()))) return PVR_ERROR_NO_ERROR;
+          deleted = dvr->DeleteRecording(std::atoi(idVal.c_str()));
       }
 
-      return PVR_ERROR_FAILED;
+      if (!deleted)
+          return PVR_ERROR_FAILED;
+      NotifyDvrChanged();
+      return PVR_ERROR_NO_ERROR;
   }
-    bool groupsReady = false;
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      groupNames = m_groupNamesOrdered;
-      groupsReady = m_groupsReady;
-    }
+
+  PVR_ERROR GetChannelGroupsAmount(int& amount) override
+  {
+    EnsureLoaded();
+
+    const auto snap = CurrentSnapshot();
+    const std::shared_ptr<const std::vector<std::string>>& groupNames = snap->groupNamesOrdered;
     // Only return groups if they're ready; prevents Kodi from trying to access group members
     // before they've been populated, which can cause UI blocking with large channel counts.
-    amount = (groupsReady && groupNames) ? static_cast<int>(groupNames->size()) : 0;
+    amount = (snap->groupsReady && groupNames) ? static_cast<int>(groupNames->size()) : 0;
     return PVR_ERROR_NO_ERROR;
   }
 
   PVR_ERROR GetChannelGroups(bool radio, kodi::addon::PVRChannelGroupsResultSet& results) override
   {
+    const xtream::perf::ScopedCallback timing(xtream::perf::Callback::GetChannelGroups);
     if (radio)
       return PVR_ERROR_NO_ERROR;
 
@@ -721,16 +792,11 @@ public:
 
     const auto t0 = std::chrono::steady_clock::now();
 
-    std::shared_ptr<const std::vector<std::string>> groupNames;
-    bool groupsReady = false;
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      groupNames = m_groupNamesOrdered;
-      groupsReady = m_groupsReady;
-    }
+    const auto snap = CurrentSnapshot();
+    const std::shared_ptr<const std::vector<std::string>>& groupNames = snap->groupNamesOrdered;
     // Only return groups if they're ready; prevents Kodi from trying to access group members
     // before they've been populated, which can cause UI blocking with large channel counts.
-    if (!groupsReady || !groupNames)
+    if (!snap->groupsReady || !groupNames)
       return PVR_ERROR_NO_ERROR;
 
     unsigned int pos = 1;
@@ -754,15 +820,13 @@ public:
   PVR_ERROR GetChannelGroupMembers(const kodi::addon::PVRChannelGroup& group,
                                    kodi::addon::PVRChannelGroupMembersResultSet& results) override
   {
+    const xtream::perf::ScopedCallback timing(xtream::perf::Callback::GetChannelGroupMembers);
     EnsureLoaded();
 
     const auto t0 = std::chrono::steady_clock::now();
 
-    std::shared_ptr<const GroupMembersMap> members;
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      members = m_groupMembers;
-    }
+    const auto snap = CurrentSnapshot();
+    const std::shared_ptr<const GroupMembersMap>& members = snap->groupMembers;
     if (!members)
       return PVR_ERROR_NO_ERROR;
 
@@ -794,19 +858,18 @@ public:
   PVR_ERROR GetChannelStreamProperties(const kodi::addon::PVRChannel& channel,
                                       std::vector<kodi::addon::PVRStreamProperty>& properties) override
   {
+    const xtream::perf::ScopedCallback timing(xtream::perf::Callback::GetChannelStreamProperties);
     EnsureLoaded();
 
-    std::shared_ptr<const UidToStreamMap> uidToStream;
-    std::shared_ptr<const std::vector<xtream::LiveStream>> streams;
-    xtream::Settings settings;
-    std::string streamFormat;
+    const auto snap = CurrentSnapshot();
+    const std::shared_ptr<const UidToStreamMap>& uidToStream = snap->uidToStreamId;
+    const std::shared_ptr<const xtream::StreamTable>& streams = snap->streams;
+    const xtream::Settings& settings = snap->settings;
+    const std::string& streamFormat = snap->streamFormat;
     std::string pendingCatchupUrl;
     {
+      // Only the catchup hand-off needs the lock.
       std::lock_guard<std::mutex> lock(m_mutex);
-      uidToStream = m_uidToStreamId;
-      streams = m_streams;
-      settings = m_xtreamSettings;
-      streamFormat = m_streamFormat;
       // Check if there's a pending catchup URL for this channel
       const unsigned int channelUid = channel.GetUniqueId();
       const auto now = std::chrono::steady_clock::now();
@@ -856,28 +919,29 @@ public:
       return PVR_ERROR_UNKNOWN;
 
     const int streamId = it->second;
-    const std::string url = xtream::BuildLiveStreamUrl(settings, streamId, streamFormat);
-    if (url.empty())
+    const std::string liveUrl = xtream::BuildLiveStreamUrl(settings, streamId, streamFormat);
+    if (liveUrl.empty())
       return PVR_ERROR_UNKNOWN;
 
-    kodi::Log(ADDON_LOG_DEBUG, "GetChannelStreamProperties: using LIVE URL = %s", url.c_str());
+    // With fast zapping a channel resolved in the background starts on its edge URL,
+    // and this tune queues its own neighbours.
+    std::string url = liveUrl;
+    if (settings.fastZapping)
+    {
+      std::string resolved = m_zapRedirects.Take(liveUrl);
+      if (!resolved.empty())
+        url = std::move(resolved);
+      WarmZapNeighbours(*snap, uid);
+    }
+
+    kodi::Log(ADDON_LOG_DEBUG, "GetChannelStreamProperties: using LIVE URL = %s%s", url.c_str(),
+              url != liveUrl ? " (pre-resolved)" : "");
     
     // Optionally use inputstream.ffmpegdirect for live streams
     if (settings.useFFmpegDirect)
     {
       // Check if this channel has catchup support for backward seeking
-      const xtream::LiveStream* channelStream = nullptr;
-      if (streams)
-      {
-        for (const auto& stream : *streams)
-        {
-          if (stream.id == streamId)
-          {
-            channelStream = &stream;
-            break;
-          }
-        }
-      }
+      const xtream::LiveStream* channelStream = streams ? streams->Find(streamId) : nullptr;
       
       properties.emplace_back(PVR_STREAM_PROPERTY_INPUTSTREAM, "inputstream.ffmpegdirect");
       
@@ -941,17 +1005,14 @@ public:
 
   PVR_ERROR GetEPGForChannel(int channelUid, time_t start, time_t end, kodi::addon::PVREPGTagsResultSet& results) override
   {
+    const xtream::perf::ScopedCallback timing(xtream::perf::Callback::GetEPGForChannel);
     EnsureLoaded();
 
-    std::shared_ptr<const std::vector<xtream::ChannelEpg>> epgData;
-    std::shared_ptr<const UidToStreamMap> uidToStream;
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      epgData = m_epgData;
-      uidToStream = m_uidToStreamId;
-    }
+    const auto snap = CurrentSnapshot();
+    const std::shared_ptr<const xtream::EpgStore>& epgStore = snap->epgStore;
+    const std::shared_ptr<const UidToStreamMap>& uidToStream = snap->uidToStreamId;
 
-    if (!epgData || !uidToStream)
+    if (!epgStore || !uidToStream)
       return PVR_ERROR_NO_ERROR;
 
     // Find the stream ID for this channel UID
@@ -959,44 +1020,20 @@ public:
     if (uidIt == uidToStream->end())
       return PVR_ERROR_NO_ERROR;
 
-    const int streamId = uidIt->second;
-    const std::string streamIdStr = std::to_string(streamId);
-
-    // Find EPG for this channel (match by stream ID as channel ID)
-    const xtream::ChannelEpg* channelEpg = nullptr;
-    for (const auto& epg : *epgData)
-    {
-      if (epg.id == streamIdStr)
-      {
-        channelEpg = &epg;
-        break;
-      }
-    }
-
-    if (!channelEpg || channelEpg->entries.empty())
-      return PVR_ERROR_NO_ERROR;
-
     // Add EPG entries within the requested time window
-    for (const auto& kv : channelEpg->entries)
-    {
-      const auto& entry = kv.second;
-      
-      // Skip entries outside the requested window
-      if (entry.endTime < start || entry.startTime > end)
-        continue;
-
+    epgStore->ForEachInWindow(uidIt->second, start, end, [&](const xtream::EpgProgramme& entry) {
       kodi::addon::PVREPGTag tag;
       tag.SetUniqueBroadcastId(static_cast<unsigned int>(entry.startTime));
       tag.SetUniqueChannelId(static_cast<unsigned int>(channelUid));
-      tag.SetTitle(entry.title);
-      tag.SetPlot(entry.description);
+      tag.SetTitle(std::string(entry.title));
+      tag.SetPlot(std::string(entry.description));
       tag.SetStartTime(entry.startTime);
       tag.SetEndTime(entry.endTime);
       
       if (!entry.episodeName.empty())
-        tag.SetEpisodeName(entry.episodeName);
+        tag.SetEpisodeName(std::string(entry.episodeName));
       if (!entry.iconPath.empty())
-        tag.SetIconPath(entry.iconPath);
+        tag.SetIconPath(std::string(entry.iconPath));
       if (entry.genreType > 0)
         tag.SetGenreType(entry.genreType);
       if (entry.year > 0)
@@ -1009,7 +1046,7 @@ public:
         tag.SetEpisodeNumber(entry.episodeNumber);
 
       results.Add(tag);
-    }
+    });
 
     return PVR_ERROR_NO_ERROR;
   }
@@ -1022,13 +1059,9 @@ public:
     kodi::Log(ADDON_LOG_DEBUG, "IsEPGTagPlayable: channel=%u, start=%ld, end=%ld", 
               tag.GetUniqueChannelId(), tag.GetStartTime(), tag.GetEndTime());
 
-    std::shared_ptr<const std::vector<xtream::LiveStream>> streams;
-    xtream::Settings settings;
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      streams = m_streams;
-      settings = m_xtreamSettings;
-    }
+    const auto snap = CurrentSnapshot();
+    const std::shared_ptr<const xtream::StreamTable>& streams = snap->streams;
+    const xtream::Settings& settings = snap->settings;
 
     if (!streams)
       return PVR_ERROR_NO_ERROR;
@@ -1051,25 +1084,22 @@ public:
       return PVR_ERROR_NO_ERROR;
 
     // Find the stream for this channel
-    for (const auto& stream : *streams)
+    const xtream::LiveStream* stream = streams->FindByUid(channelUid);
+    if (!stream)
+      return PVR_ERROR_NO_ERROR;
+
+    kodi::Log(ADDON_LOG_DEBUG, "IsEPGTagPlayable: found stream %d, tvArchive=%d, duration=%d",
+              stream->id, stream->tvArchive, stream->tvArchiveDuration);
+    
+    // Check if stream has catchup/archive support
+    if (stream->tvArchive && stream->tvArchiveDuration > 0)
     {
-      if (static_cast<unsigned int>(stream.id) == channelUid)
+      // Check if the program is within the archive window
+      const time_t archiveCutoff = now - (stream->tvArchiveDuration * 3600); // duration is in hours
+      if (endTime >= archiveCutoff)
       {
-        kodi::Log(ADDON_LOG_DEBUG, "IsEPGTagPlayable: found stream %d, tvArchive=%d, duration=%d",
-                  stream.id, stream.tvArchive, stream.tvArchiveDuration);
-        
-        // Check if stream has catchup/archive support
-        if (stream.tvArchive && stream.tvArchiveDuration > 0)
-        {
-          // Check if the program is within the archive window
-          const time_t archiveCutoff = now - (stream.tvArchiveDuration * 3600); // duration is in hours
-          if (endTime >= archiveCutoff)
-          {
-            isPlayable = true;
-            kodi::Log(ADDON_LOG_DEBUG, "IsEPGTagPlayable: PLAYABLE!");
-          }
-        }
-        break;
+        isPlayable = true;
+        kodi::Log(ADDON_LOG_DEBUG, "IsEPGTagPlayable: PLAYABLE!");
       }
     }
 
@@ -1119,20 +1149,16 @@ public:
   PVR_ERROR GetEPGTagStreamProperties(const kodi::addon::PVREPGTag& tag,
                                      std::vector<kodi::addon::PVRStreamProperty>& properties) override
   {
+    const xtream::perf::ScopedCallback timing(xtream::perf::Callback::GetEPGTagStreamProperties);
     EnsureLoaded();
     
     kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties CALLED: channel=%u, start=%ld, end=%ld",
               tag.GetUniqueChannelId(), tag.GetStartTime(), tag.GetEndTime());
 
-    std::shared_ptr<const std::vector<xtream::LiveStream>> streams;
-    xtream::Settings settings;
-    std::string streamFormat;
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      streams = m_streams;
-      settings = m_xtreamSettings;
-      streamFormat = m_streamFormat;
-    }
+    const auto snap = CurrentSnapshot();
+    const std::shared_ptr<const xtream::StreamTable>& streams = snap->streams;
+    const xtream::Settings& settings = snap->settings;
+    const std::string& streamFormat = snap->streamFormat;
 
     if (!streams)
       return PVR_ERROR_UNKNOWN;
@@ -1145,108 +1171,105 @@ public:
           settings.catchupStartOffsetHours, startTime, endTime);
 
     // Find the stream for this channel
-    for (const auto& stream : *streams)
-    {
-      if (static_cast<unsigned int>(stream.id) == channelUid)
-      {
-        if (!stream.tvArchive)
-          return PVR_ERROR_UNKNOWN;
+    const xtream::LiveStream* found = streams->FindByUid(channelUid);
+    if (!found)
+      return PVR_ERROR_UNKNOWN;
+    const xtream::LiveStream& stream = *found;
 
-        // Prevent attempting catchup for future programmes
-        const time_t nowTs = std::time(nullptr);
-        if (startTime > nowTs)
-        {
-          kodi::Log(ADDON_LOG_WARNING,
-                    "GetEPGTagStreamProperties: programme start is in the future; refusing catchup");
-          return PVR_ERROR_UNKNOWN;
-        }
+    if (!stream.tvArchive)
+      return PVR_ERROR_UNKNOWN;
 
-        // Build catchup URL (use 'now' as end for ongoing programmes)
-        const time_t effectiveEnd = (endTime > nowTs) ? nowTs : endTime;
-        const std::string url = xtream::BuildCatchupUrl(settings, stream.id, startTime, effectiveEnd, streamFormat);
-        kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: catchup URL = %s", url.c_str());
-        
-        if (url.empty())
-        {
-          kodi::Log(ADDON_LOG_ERROR, "GetEPGTagStreamProperties: catchup URL is EMPTY, returning ERROR");
-          return PVR_ERROR_UNKNOWN;
-        }
+    // Prevent attempting catchup for future programmes
+    const time_t nowTs = std::time(nullptr);
+    if (startTime > nowTs)
+    {
+      kodi::Log(ADDON_LOG_WARNING,
+                "GetEPGTagStreamProperties: programme start is in the future; refusing catchup");
+      return PVR_ERROR_UNKNOWN;
+    }
 
-        // Store the catchup URL for GetChannelStreamProperties to use
-        // Kodi will call GetChannelStreamProperties after this, and we need to provide the catchup URL there
-        {
-          const auto now = std::chrono::steady_clock::now();
-          const int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-          std::lock_guard<std::mutex> lock(m_mutex);
-          m_pendingCatchupByChannel[channelUid] = PendingCatchup{url, nowMs + 30000, startTime, endTime};
-        }
-        kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: stored catchup URL for channel %u", channelUid);
-        
-        const std::string streamMimeType = (ToLower(streamFormat) == "hls")
-                    ? "application/vnd.apple.mpegurl"
-                    : "video/mp2t";
-        
-        // Optionally use inputstream.ffmpegdirect for better seeking support
-        if (settings.useFFmpegDirect)
-        {
-          // Apply the same catchup offset that BuildCatchupUrl applies
-          // (clamped to 0 if negative, converted from hours to seconds)
-          int offsetHours = settings.catchupStartOffsetHours;
-          if (offsetHours < 0)
-            offsetHours = 0;
-          const time_t offsetSeconds = offsetHours * 3600;
-          const time_t adjustedStartTime = startTime + offsetSeconds;
-          
-          // Calculate programme duration in minutes from the adjusted start
-          const int programDurationMinutes = static_cast<int>((effectiveEnd - adjustedStartTime) / 60);
-          
-          // Build a URL template with ffmpegdirect placeholders for seeking
-          const std::string templateUrl = xtream::BuildCatchupUrlTemplate(
-              settings, stream.id, programDurationMinutes, streamFormat);
-          
-          if (templateUrl.empty())
-          {
-            kodi::Log(ADDON_LOG_ERROR, "GetEPGTagStreamProperties: catchup URL template is EMPTY");
-            return PVR_ERROR_UNKNOWN;
-          }
-          
-          kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: catchup URL template = %s", templateUrl.c_str());
-          
-          properties.emplace_back(PVR_STREAM_PROPERTY_INPUTSTREAM, "inputstream.ffmpegdirect");
-          // Use catchup mode with URL template - ffmpegdirect substitutes placeholders when seeking
-          properties.emplace_back("inputstream.ffmpegdirect.stream_mode", "catchup");
-          // The default URL is used for initial playback (concrete URL with actual start time)
-          properties.emplace_back("inputstream.ffmpegdirect.default_url", url);
-          // The catchup URL format string contains placeholders for seeking
-          properties.emplace_back("inputstream.ffmpegdirect.catchup_url_format_string", templateUrl);
-          // Buffer boundaries in epoch seconds (adjusted for catchup offset to match the concrete URL)
-          properties.emplace_back("inputstream.ffmpegdirect.catchup_buffer_start_time", std::to_string(adjustedStartTime));
-          properties.emplace_back("inputstream.ffmpegdirect.catchup_buffer_end_time", std::to_string(effectiveEnd));
-          // Terminate at programme end to avoid auto-jumping to next EPG entry
-          properties.emplace_back("inputstream.ffmpegdirect.catchup_terminates", "true");
-          // Treat as non-realtime so duration is fixed
-          properties.emplace_back("inputstream.ffmpegdirect.is_realtime_stream", "false");
-          // Timezone offset (0 = UTC, ffmpegdirect applies this to placeholder substitution)
-          properties.emplace_back("inputstream.ffmpegdirect.timezone_shift", "0");
-          // Use the concrete URL for initial stream open
-          properties.emplace_back(PVR_STREAM_PROPERTY_STREAMURL, url);
-          
-          kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: using inputstream.ffmpegdirect catchup mode with URL template");
-        }
-        else
-        {
-          properties.emplace_back(PVR_STREAM_PROPERTY_STREAMURL, url);
-        }
-        kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: added STREAMURL property");
-        properties.emplace_back(PVR_STREAM_PROPERTY_ISREALTIMESTREAM, "false");
-        properties.emplace_back(PVR_STREAM_PROPERTY_EPGPLAYBACKASLIVE, "false");
-        properties.emplace_back(PVR_STREAM_PROPERTY_MIMETYPE, streamMimeType);
-        kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: returning SUCCESS with %d properties", (int)properties.size());
-        return PVR_ERROR_NO_ERROR;
-      }
+    // Build catchup URL (use 'now' as end for ongoing programmes)
+    const time_t effectiveEnd = (endTime > nowTs) ? nowTs : endTime;
+    const std::string url = xtream::BuildCatchupUrl(settings, stream.id, startTime, effectiveEnd, streamFormat);
+    kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: catchup URL = %s", url.c_str());
+    
+    if (url.empty())
+    {
+      kodi::Log(ADDON_LOG_ERROR, "GetEPGTagStreamProperties: catchup URL is EMPTY, returning ERROR");
+      return PVR_ERROR_UNKNOWN;
     }
 
-    return PVR_ERROR_UNKNOWN;
+    // Store the catchup URL for GetChannelStreamProperties to use
+    // Kodi will call GetChannelStreamProperties after this, and we need to provide the catchup URL there
+    {
+      const auto now = std::chrono::steady_clock::now();
+      const int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_pendingCatchupByChannel[channelUid] = PendingCatchup{url, nowMs + 30000, startTime, endTime};
+    }
+    kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: stored catchup URL for channel %u", channelUid);
+    
+    const std::string streamMimeType = (ToLower(streamFormat) == "hls")
+                ? "application/vnd.apple.mpegurl"
+                : "video/mp2t";
+    
+    // Optionally use inputstream.ffmpegdirect for better seeking support
+    if (settings.useFFmpegDirect)
+    {
+      // Apply the same catchup offset that BuildCatchupUrl applies
+      // (clamped to 0 if negative, converted from hours to seconds)
+      int offsetHours = settings.catchupStartOffsetHours;
+      if (offsetHours < 0)
+        offsetHours = 0;
+      const time_t offsetSeconds = offsetHours * 3600;
+      const time_t adjustedStartTime = startTime + offsetSeconds;
+      
+      // Calculate programme duration in minutes from the adjusted start
+      const int programDurationMinutes = static_cast<int>((effectiveEnd - adjustedStartTime) / 60);
+      
+      // Build a URL template with ffmpegdirect placeholders for seeking
+      const std::string templateUrl = xtream::BuildCatchupUrlTemplate(
+          settings, stream.id, programDurationMinutes, streamFormat);
+      
+      if (templateUrl.empty())
+      {
+        kodi::Log(ADDON_LOG_ERROR, "GetEPGTagStreamProperties: catchup URL template is EMPTY");
+        return PVR_ERROR_UNKNOWN;
+      }
+      
+      kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: catchup URL template = %s", templateUrl.c_str());
+      
+      properties.emplace_back(PVR_STREAM_PROPERTY_INPUTSTREAM, "inputstream.ffmpegdirect");
+      // Use catchup mode with URL template - ffmpegdirect substitutes placeholders when seeking
+      properties.emplace_back("inputstream.ffmpegdirect.stream_mode", "catchup");
+      // The default URL is used for initial playback (concrete URL with actual start time)
+      properties.emplace_back("inputstream.ffmpegdirect.default_url", url);
+      // The catchup URL format string contains placeholders for seeking
+      properties.emplace_back("inputstream.ffmpegdirect.catchup_url_format_string", templateUrl);
+      // Buffer boundaries in epoch seconds (adjusted for catchup offset to match the concrete URL)
+      properties.emplace_back("inputstream.ffmpegdirect.catchup_buffer_start_time", std::to_string(adjustedStartTime));
+      properties.emplace_back("inputstream.ffmpegdirect.catchup_buffer_end_time", std::to_string(effectiveEnd));
+      // Terminate at programme end to avoid auto-jumping to next EPG entry
+      properties.emplace_back("inputstream.ffmpegdirect.catchup_terminates", "true");
+      // Treat as non-realtime so duration is fixed
+      properties.emplace_back("inputstream.ffmpegdirect.is_realtime_stream", "false");
+      // Timezone offset (0 = UTC, ffmpegdirect applies this to placeholder substitution)
+      properties.emplace_back("inputstream.ffmpegdirect.timezone_shift", "0");
+      // Use the concrete URL for initial stream open
+      properties.emplace_back(PVR_STREAM_PROPERTY_STREAMURL, url);
+      
+      kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: using inputstream.ffmpegdirect catchup mode with URL template");
+    }
+    else
+    {
+      properties.emplace_back(PVR_STREAM_PROPERTY_STREAMURL, url);
+    }
+    kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: added STREAMURL property");
+    properties.emplace_back(PVR_STREAM_PROPERTY_ISREALTIMESTREAM, "false");
+    properties.emplace_back(PVR_STREAM_PROPERTY_EPGPLAYBACKASLIVE, "false");
+    properties.emplace_back(PVR_STREAM_PROPERTY_MIMETYPE, streamMimeType);
+    kodi::Log(ADDON_LOG_INFO, "GetEPGTagStreamProperties: returning SUCCESS with %d properties", (int)properties.size());
+    return PVR_ERROR_NO_ERROR;
   }
 
 private:
@@ -1257,15 +1280,7 @@ private:
     unsigned int subChannelNumber = 0;
   };
 
-  struct CacheChannel
-  {
-    unsigned int uid = 0;
-    int categoryId = 0;
-    unsigned int channelNumber = 0;
-    std::string name;
-  };
-
-  std::string CachePath() const
+  std::string CachePath() const
   {
     return TranslateSpecial("special://profile/addon_data/pvr.dispatcharr/channels.cache");
   }
@@ -1280,74 +1295,50 @@ private:
     if (!ReadFileToString(path, blob))
       return false;
 
-    size_t off = 0;
-    uint32_t magic = 0;
-    if (!ReadU32(blob, off, magic) || magic != kCacheMagic)
-      return false;
-
-    uint32_t sigLen = 0;
-    if (!ReadU32(blob, off, sigLen) || off + sigLen > blob.size())
-      return false;
-    const std::string sigOnDisk = blob.substr(off, sigLen);
-    off += sigLen;
-    if (sigOnDisk != signature)
-      return false;
-
-    uint64_t ts = 0;
-    if (!ReadU64(blob, off, ts))
-      return false;
-
-    uint32_t catCount = 0;
-    if (!ReadU32(blob, off, catCount))
+    xtream::ChannelCacheData cache;
+    if (!xtream::DecodeChannelCache(blob, signature, cache))
       return false;
 
     std::unordered_map<int, std::string> categoryIdToName;
-    categoryIdToName.reserve(static_cast<size_t>(catCount));
-    for (uint32_t i = 0; i < catCount; ++i)
+    categoryIdToName.reserve(cache.categories.size());
+    for (auto& c : cache.categories)
     {
-      int32_t id = 0;
-      uint32_t nameLen = 0;
-      if (!ReadI32(blob, off, id) || !ReadU32(blob, off, nameLen) || off + nameLen > blob.size())
-        return false;
-      std::string name = blob.substr(off, nameLen);
-      off += nameLen;
-      if (id > 0 && !name.empty())
-        categoryIdToName.emplace(static_cast<int>(id), std::move(name));
+      if (c.id > 0 && !c.name.empty())
+        categoryIdToName.emplace(c.id, std::move(c.name));
     }
 
-    uint32_t chCount = 0;
-    if (!ReadU32(blob, off, chCount))
-      return false;
-
     std::vector<kodi::addon::PVRChannel> channels;
-    channels.reserve(static_cast<size_t>(chCount));
+    channels.reserve(cache.channels.size());
     std::unordered_map<unsigned int, int> uidToStreamId;
-    uidToStreamId.reserve(static_cast<size_t>(chCount));
+    uidToStreamId.reserve(cache.channels.size());
     std::vector<int> channelCategoryIds;
-    channelCategoryIds.reserve(static_cast<size_t>(chCount));
+    channelCategoryIds.reserve(cache.channels.size());
+    const bool directIcons = cache.channels.size() <= kDirectIconLimit;
 
-    for (uint32_t i = 0; i < chCount; ++i)
+    for (const auto& c : cache.channels)
     {
-      uint32_t uid = 0;
-      int32_t catId = 0;
-      uint32_t chNum = 0;
-      uint32_t nameLen = 0;
-      if (!ReadU32(blob, off, uid) || !ReadI32(blob, off, catId) || !ReadU32(blob, off, chNum) ||
-          !ReadU32(blob, off, nameLen) || off + nameLen > blob.size())
-        return false;
-      std::string name = blob.substr(off, nameLen);
-      off += nameLen;
-      if (uid == 0 || name.empty())
+      if (c.uid == 0 || c.name.empty())
         continue;
 
       kodi::addon::PVRChannel ch;
-      ch.SetUniqueId(uid);
+      ch.SetUniqueId(c.uid);
       ch.SetIsRadio(false);
-      ch.SetChannelName(name);
-      ch.SetChannelNumber(static_cast<int>(chNum));
+      ch.SetChannelName(c.name);
+      ch.SetChannelNumber(static_cast<int>(c.channelNumber));
+      if (const xtream::LiveStream* s = cache.hasStreams ? cache.streams.FindByUid(c.uid) : nullptr)
+      {
+        if (!s->icon.empty())
+        {
+          std::string local = m_iconCache.Lookup(s->icon);
+          if (!local.empty())
+            ch.SetIconPath(local);
+          else if (directIcons)
+            ch.SetIconPath(std::string(s->icon));
+        }
+      }
       channels.push_back(std::move(ch));
-      uidToStreamId.emplace(uid, static_cast<int>(uid));
-      channelCategoryIds.push_back(static_cast<int>(catId));
+      uidToStreamId.emplace(c.uid, static_cast<int>(c.uid));
+      channelCategoryIds.push_back(c.categoryId);
     }
 
     std::unordered_map<std::string, std::vector<GroupMember>> groupMembers;
@@ -1366,84 +1357,780 @@ private:
       groupMembers[catIt->second].push_back(gm);
     }
 
-    std::vector<std::pair<int, std::string>> cats;
-    cats.reserve(categoryIdToName.size());
-    for (const auto& kv : categoryIdToName)
-      cats.emplace_back(kv.first, kv.second);
-    std::sort(cats.begin(), cats.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
-
+    // XTC2 keeps the published group order; XTC1 only has the categories, sorted by id.
     std::vector<std::string> groupNamesOrdered;
-    groupNamesOrdered.reserve(cats.size());
-    for (const auto& kv : cats)
+    if (cache.hasStreams)
     {
-      const auto memIt = groupMembers.find(kv.second);
-      if (memIt == groupMembers.end() || memIt->second.empty())
-        continue;
-      groupNamesOrdered.push_back(kv.second);
+      groupNamesOrdered.reserve(cache.groupNames.size());
+      for (auto& name : cache.groupNames)
+      {
+        const auto memIt = groupMembers.find(name);
+        if (memIt != groupMembers.end() && !memIt->second.empty())
+          groupNamesOrdered.push_back(std::move(name));
+      }
+    }
+    else
+    {
+      std::vector<std::pair<int, std::string>> cats;
+      cats.reserve(categoryIdToName.size());
+      for (const auto& kv : categoryIdToName)
+        cats.emplace_back(kv.first, kv.second);
+      std::sort(cats.begin(), cats.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+      groupNamesOrdered.reserve(cats.size());
+      for (const auto& kv : cats)
+      {
+        const auto memIt = groupMembers.find(kv.second);
+        if (memIt == groupMembers.end() || memIt->second.empty())
+          continue;
+        groupNamesOrdered.push_back(kv.second);
+      }
     }
 
     {
       std::lock_guard<std::mutex> lock(m_mutex);
       // Only seed from cache if we don't already have data.
-      if (m_channels && !m_channels->empty())
+      const auto current = CurrentSnapshot();
+      if (current->channels && !current->channels->empty())
         return false;
-      m_channels = std::make_shared<ChannelList>(std::move(channels));
-      m_uidToStreamId = std::make_shared<UidToStreamMap>(std::move(uidToStreamId));
-      m_groupMembers = std::make_shared<GroupMembersMap>(std::move(groupMembers));
-      m_groupNamesOrdered = std::make_shared<std::vector<std::string>>(std::move(groupNamesOrdered));
+      PublishLocked([&](Snapshot& next) {
+        next.channels = std::make_shared<ChannelList>(std::move(channels));
+        next.uidToStreamId = std::make_shared<UidToStreamMap>(std::move(uidToStreamId));
+        next.groupMembers = std::make_shared<GroupMembersMap>(std::move(groupMembers));
+        next.channelPositions = IndexChannelPositions(*next.channels, *next.groupMembers);
+        next.channelIcons.reset();
+        next.groupNamesOrdered = std::make_shared<std::vector<std::string>>(std::move(groupNamesOrdered));
+        next.dataSignature = signature;
+        // With the full stream records the cached lists serve every callback, groups
+        // included, until the network load replaces them.
+        if (cache.hasStreams)
+        {
+          next.streams = std::make_shared<const xtream::StreamTable>(std::move(cache.streams));
+          next.groupsReady = true;
+        }
+      });
     }
 
     kodi::Log(ADDON_LOG_INFO,
-              "pvr.dispatcharr: seeded channels from cache (%u channels, ts=%llu)",
-              chCount, static_cast<unsigned long long>(ts));
+              "pvr.dispatcharr: seeded channels from cache (%zu channels, %s, ts=%llu)",
+              cache.channels.size(), cache.hasStreams ? "with streams" : "channels only",
+              static_cast<unsigned long long>(cache.timestamp));
+    return true;
+  }
+
+  std::string EpgCachePath() const
+  {
+    return TranslateSpecial("special://profile/addon_data/pvr.dispatcharr/epg.cache");
+  }
+
+  // Descriptions and icons of a guide parsed in lazy mode; epg.cache records which
+  // version of this file it belongs to.
+  std::string EpgLazyTextPath() const
+  {
+    return TranslateSpecial("special://profile/addon_data/pvr.dispatcharr/epg.text");
+  }
+
+  // With supplementary guides, each XMLTV source's own mapped guide (and its lazy text)
+  // is cached too, so a source that didn't change is merged from disk rather than
+  // fetched again. epg.cache then holds the merged guide.
+  std::string EpgSourceCachePath(size_t source) const
+  {
+    return TranslateSpecial("special://profile/addon_data/pvr.dispatcharr/epg.src" + std::to_string(source) +
+                            ".cache");
+  }
+
+  std::string EpgSourceTextPath(size_t source) const
+  {
+    return TranslateSpecial("special://profile/addon_data/pvr.dispatcharr/epg.src" + std::to_string(source) +
+                            ".text");
+  }
+
+  // XMLTV channel ids only mean something within one source, so each has its own table.
+  std::string EpgMatchCachePath(size_t source) const
+  {
+    const std::string suffix = source == 0 ? std::string() : ".src" + std::to_string(source);
+    return TranslateSpecial("special://profile/addon_data/pvr.dispatcharr/epg_match" + suffix + ".cache");
+  }
+
+  // The remembered fuzzy channel matches of one XMLTV source, loaded on first use.
+  // Worker thread only.
+  xtream::EpgMatchTable& EpgMatches(size_t source)
+  {
+    if (m_epgMatches.size() <= source)
+    {
+      m_epgMatches.resize(source + 1);
+      m_epgMatchesLoaded.resize(source + 1, false);
+    }
+    if (!m_epgMatchesLoaded[source])
+    {
+      m_epgMatchesLoaded[source] = true;
+      std::string blob;
+      if (ReadFileToString(EpgMatchCachePath(source), blob) && m_epgMatches[source].Decode(blob))
+        kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: loaded %zu remembered EPG channel matches",
+                  m_epgMatches[source].Size());
+    }
+    return m_epgMatches[source];
+  }
+
+  void SaveEpgMatches(size_t source)
+  {
+    if (source >= m_epgMatches.size() || !m_epgMatches[source].Dirty())
+      return;
+    if (WriteStringToFileAtomic(EpgMatchCachePath(source), m_epgMatches[source].Encode()))
+      m_epgMatches[source].ClearDirty();
+  }
+
+  // The horizon is measured from `now`, which the caller keeps as the guide's anchor.
+  // Lazy text goes to the source's own file when there are several sources.
+  xtream::XmltvParseOptions EpgParseOptions(const xtream::Settings& settings,
+                                            time_t now,
+                                            size_t source,
+                                            size_t sourceCount) const
+  {
+    constexpr time_t kDay = 24 * 60 * 60;
+    xtream::XmltvParseOptions options;
+    if (settings.epgDaysPast > 0)
+      options.notBefore = now - settings.epgDaysPast * kDay;
+    if (settings.epgDaysFuture > 0)
+      options.notAfter = now + settings.epgDaysFuture * kDay;
+    if (settings.epgLazyText)
+      options.lazyTextPath = sourceCount > 1 ? EpgSourceTextPath(source) : EpgLazyTextPath();
+    options.threads = settings.epgParseThreads > 0 ? static_cast<unsigned>(settings.epgParseThreads)
+                                                   : DefaultEpgParseThreads();
+    return options;
+  }
+
+  bool TryLoadEpgCacheForSignature(const std::string& signature)
+  {
+    const std::string path = EpgCachePath();
+    if (path.empty())
+      return false;
+
+    xtream::EpgStore store;
+    std::string sourceState;
+    uint64_t ts = 0;
+    if (!xtream::EpgStore::ReadCacheFile(path, signature, store, sourceState, ts, EpgLazyTextPath()))
+      return false;
+
+    std::vector<EpgSourceState> sources;
+    if (!ParseEpgSourceStates(sourceState, sources))
+      sources.clear();
+
+    const size_t channelCount = store.ChannelCount();
+    const size_t programmeCount = store.ProgrammeCount();
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      // Only seed from cache if we don't already have data.
+      if (CurrentSnapshot()->epgStore)
+        return false;
+      PublishLocked([&](Snapshot& next) {
+        next.epgStore = std::make_shared<const xtream::EpgStore>(std::move(store));
+        next.epgSignature = signature;
+      });
+      m_epgSources = std::move(sources);
+    }
+
+    kodi::Log(ADDON_LOG_INFO,
+              "pvr.dispatcharr: seeded EPG from cache (%zu channels, %zu programmes, ts=%llu)",
+              channelCount, programmeCount, static_cast<unsigned long long>(ts));
     return true;
   }
 
   void SaveCache(const std::string& signature,
                  const std::vector<xtream::LiveCategory>& categories,
-                 const std::vector<CacheChannel>& cacheChannels)
+                 const std::vector<std::string>& groupNames,
+                 const xtream::StreamTable& streams,
+                 const std::vector<xtream::CacheChannel>& cacheChannels)
   {
     const std::string path = CachePath();
     if (path.empty())
       return;
 
-    std::string blob;
-    blob.reserve(64 + signature.size() + cacheChannels.size() * 64);
-    AppendU32(blob, kCacheMagic);
-    AppendU32(blob, static_cast<uint32_t>(signature.size()));
-    blob.append(signature);
+    const xtream::perf::ScopedStage timing(xtream::perf::Stage::ChannelCache);
     const uint64_t ts = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
                          std::chrono::system_clock::now().time_since_epoch()).count());
-    AppendU64(blob, ts);
+    const std::string blob =
+        xtream::EncodeChannelCache(signature, ts, categories, groupNames, streams, cacheChannels);
+    (void)WriteStringToFileAtomic(path, blob);
+  }
+  // One XMLTV download, parsed by whichever parser the settings select.
+  struct EpgFetch
+  {
+    xtream::FetchResult result;
+    xtream::XmltvValidators validators;
+    xtream::XmltvGuide guide; // streaming parse
+    std::string xmltvData;    // buffered (DOM) parse
+    xtream::XmltvParseOptions options; // horizon and lazy text, fixed when the fetch started
+    int64_t horizonAnchor = 0;
+  };
 
-    std::vector<std::pair<int, std::string>> cats;
-    cats.reserve(categories.size());
-    for (const auto& c : categories)
+  // Fetches one XMLTV source (an index into XmltvSourceUrls), conditional on `validators`.
+  using EpgFetchFn = std::function<EpgFetch(size_t source, xtream::XmltvValidators validators)>;
+
+  // Runs on the caller's thread; a streaming parse stops early once `abandoned` is set
+  // or the work is superseded.
+  EpgFetch FetchEpg(const xtream::Settings& settings,
+                    const std::vector<std::string>& urls,
+                    size_t source,
+                    uint64_t gen,
+                    xtream::XmltvValidators validators,
+                    const std::atomic<bool>& abandoned)
+  {
+    EpgFetch job;
+    job.validators = std::move(validators);
+    const time_t now = std::time(nullptr);
+    job.options = EpgParseOptions(settings, now, source, urls.size());
+    job.horizonAnchor = static_cast<int64_t>(now);
+    const xtream::perf::ScopedStage timing(xtream::perf::Stage::XmltvFetch);
+    // Both paths stop at their next read once the load is superseded or shut down.
+    const auto cancelled = [&]() {
+      return abandoned.load() || m_stopRequested.load() || gen != m_generation.load();
+    };
+    if (settings.epgStreamingParse)
+    {
+      job.result = xtream::FetchAndParseXMLTVGuide(settings, urls[source], job.guide, &job.validators,
+                                                   cancelled, &job.options);
+    }
+    else
     {
-      if (c.id <= 0 || c.name.empty())
+      job.result = xtream::FetchXMLTVEpg(settings, urls[source], job.xmltvData, &job.validators, cancelled);
+    }
+    return job;
+  }
+
+  // Runs the (source, validators) fetches at once, the first on the calling thread, and
+  // returns them in the order given.
+  static std::vector<EpgFetch> FetchEpgSources(const EpgFetchFn& fetchEpg,
+                                               std::vector<std::pair<size_t, xtream::XmltvValidators>> jobs)
+  {
+    std::vector<std::future<EpgFetch>> others;
+    for (size_t i = 1; i < jobs.size(); ++i)
+      others.push_back(std::async(std::launch::async, fetchEpg, jobs[i].first, std::move(jobs[i].second)));
+    std::vector<EpgFetch> fetches;
+    fetches.reserve(jobs.size());
+    if (!jobs.empty())
+      fetches.push_back(fetchEpg(jobs.front().first, std::move(jobs.front().second)));
+    for (auto& f : others)
+      fetches.push_back(f.get());
+    return fetches;
+  }
+
+  // The held guide's source states when they belong to `signature` and its sources,
+  // otherwise blank ones (unconditional requests). Caller holds m_mutex.
+  std::vector<EpgSourceState> HeldEpgSourcesLocked(const std::string& signature, size_t sourceCount) const
+  {
+    const auto snap = CurrentSnapshot();
+    if (snap->epgStore && snap->epgSignature == signature && m_epgSources.size() == sourceCount)
+      return m_epgSources;
+    return std::vector<EpgSourceState>(sourceCount);
+  }
+
+  // Reads one source's guide of a multi-source EPG back from its cache, provided it is
+  // the guide `held` describes.
+  bool LoadEpgSource(size_t source,
+                     const std::string& signature,
+                     const EpgSourceState& held,
+                     xtream::EpgStore& out) const
+  {
+    std::string sourceState;
+    uint64_t ts = 0;
+    if (xtream::EpgStore::ReadCacheFile(EpgSourceCachePath(source), signature, out, sourceState, ts,
+                                        EpgSourceTextPath(source)) &&
+        sourceState == SerializeEpgSourceState(held))
+      return true;
+    out = xtream::EpgStore();
+    return false;
+  }
+
+  // Maps finished fetches (one per XMLTV source, in XmltvSourceUrls order) onto
+  // `streams`, merges the sources by priority, publishes and caches the guide and asks
+  // Kodi to re-read channels whose programmes changed. `held` describes the guide the
+  // fetches were conditional on. A source that failed keeps its last guide in the
+  // merge. Returns true when every source is current afterwards (unchanged or
+  // replaced); false when one failed to fetch or parse, or the work was superseded.
+  bool PublishEpg(std::vector<EpgFetch> fetches,
+                  const EpgFetchFn& fetchEpg,
+                  uint64_t gen,
+                  const xtream::Settings& settings,
+                  const std::string& signature,
+                  const xtream::StreamTable& streams,
+                  const std::vector<EpgSourceState>& held,
+                  const std::shared_ptr<const xtream::EpgStore>& previousEpg)
+  {
+    const size_t sourceCount = fetches.size();
+    const bool multiSource = sourceCount > 1;
+    auto label = [multiSource](size_t source) {
+      return multiSource ? "XMLTV source " + std::to_string(source + 1) : std::string("XMLTV");
+    };
+
+    // A conditional hit only helps when the held guide was mapped from these streams
+    // and its horizon still covers the days Kodi shows (and, with several sources, when
+    // the source's own cached guide is there to merge); otherwise fetch it again
+    // unconditionally so there is something to map.
+    const uint64_t streamsHash = EpgStreamsHash(streams);
+    const bool hasHorizon = settings.epgDaysPast > 0 || settings.epgDaysFuture > 0;
+    std::vector<xtream::EpgStore> guides(sourceCount);
+    std::vector<std::pair<size_t, xtream::XmltvValidators>> refetch;
+    for (size_t i = 0; i < sourceCount; ++i)
+    {
+      const EpgFetch& epg = fetches[i];
+      if (!epg.result.ok || !epg.result.unchanged)
+        continue;
+      const char* reason = nullptr;
+      if (held[i].streamsHash != streamsHash)
+        reason = "the stream list changed";
+      else if (hasHorizon && epg.horizonAnchor - held[i].horizonAnchor > kEpgHorizonSlideSeconds)
+        reason = "the EPG horizon moved";
+      else if (held[i].daysPast >= 0 &&
+               (held[i].daysPast != settings.epgDaysPast || held[i].daysFuture != settings.epgDaysFuture))
+        reason = "the EPG horizon changed";
+      else if (multiSource && !LoadEpgSource(i, signature, held[i], guides[i]))
+        reason = "its cached guide is missing";
+      if (reason)
+      {
+        kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: %s unchanged but %s, refetching", label(i).c_str(), reason);
+        refetch.emplace_back(i, xtream::XmltvValidators());
+      }
+    }
+    if (!refetch.empty())
+    {
+      std::vector<EpgFetch> again = FetchEpgSources(fetchEpg, refetch);
+      for (size_t j = 0; j < refetch.size(); ++j)
+        fetches[refetch[j].first] = std::move(again[j]);
+      if (m_stopRequested || gen != m_generation.load())
+        return false;
+    }
+
+    std::vector<EpgSourceState> states = held;
+    std::vector<bool> mapped(sourceCount, false);
+    bool anyMapped = false;
+    bool anyUnchanged = false;
+    bool allCurrent = true;
+    for (size_t i = 0; i < sourceCount; ++i)
+    {
+      EpgFetch& epg = fetches[i];
+      if (!epg.result.ok)
+      {
+        kodi::Log(ADDON_LOG_WARNING, "pvr.dispatcharr: failed to fetch %s EPG data: %s", label(i).c_str(),
+                  epg.result.details.c_str());
+        allCurrent = false;
+        continue;
+      }
+      if (epg.result.unchanged)
+      {
+        kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: %s unchanged (%s), keeping %s guide", label(i).c_str(),
+                  epg.result.details.c_str(), multiSource ? "its" : "current");
+        states[i].validators = epg.validators;
+        anyUnchanged = true;
         continue;
-      cats.emplace_back(c.id, c.name);
+      }
+
+      {
+        const xtream::perf::ScopedStage timing(xtream::perf::Stage::XmltvParse);
+        if (settings.epgStreamingParse)
+        {
+          mapped[i] = xtream::MapXMLTV(epg.guide, streams, guides[i], &EpgMatches(i));
+        }
+        else
+        {
+          kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: fetched %s EPG data", label(i).c_str());
+          epg.options.matches = &EpgMatches(i);
+          mapped[i] = xtream::ParseXMLTV(epg.xmltvData, streams, guides[i], epg.options);
+          std::string().swap(epg.xmltvData);
+        }
+        SaveEpgMatches(i);
+      }
+      if (!mapped[i])
+      {
+        kodi::Log(ADDON_LOG_WARNING, "pvr.dispatcharr: failed to parse %s data", label(i).c_str());
+        allCurrent = false;
+        continue;
+      }
+      states[i] = {epg.validators, streamsHash, epg.horizonAnchor, settings.epgDaysPast, settings.epgDaysFuture};
+      anyMapped = true;
     }
-    AppendU32(blob, static_cast<uint32_t>(cats.size()));
-    for (const auto& kv : cats)
+
+    if (!anyMapped)
     {
-      AppendI32(blob, static_cast<int32_t>(kv.first));
-      AppendU32(blob, static_cast<uint32_t>(kv.second.size()));
-      blob.append(kv.second);
+      // Nothing new: the held guide stays, conditional on what was just confirmed.
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (gen != m_generation.load())
+        return false;
+      if (anyUnchanged)
+        m_epgSources = states;
+      return allCurrent;
     }
 
-    AppendU32(blob, static_cast<uint32_t>(cacheChannels.size()));
-    for (const auto& c : cacheChannels)
+    const uint64_t ts = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                         std::chrono::system_clock::now().time_since_epoch()).count());
+    xtream::EpgStore epgData;
+    if (!multiSource)
     {
-      AppendU32(blob, static_cast<uint32_t>(c.uid));
-      AppendI32(blob, static_cast<int32_t>(c.categoryId));
-      AppendU32(blob, static_cast<uint32_t>(c.channelNumber));
-      AppendU32(blob, static_cast<uint32_t>(c.name.size()));
-      blob.append(c.name);
+      epgData = std::move(guides.front());
     }
+    else
+    {
+      // Each source that changed is cached on its own for the next merge; one that
+      // failed is merged from its cache while that still fits the stream list.
+      std::vector<const xtream::EpgStore*> parts;
+      for (size_t i = 0; i < sourceCount; ++i)
+      {
+        if (mapped[i])
+        {
+          const xtream::perf::ScopedStage timing(xtream::perf::Stage::EpgCache);
+          if (!guides[i].WriteCacheFile(EpgSourceCachePath(i), signature, SerializeEpgSourceState(states[i]), ts))
+            kodi::Log(ADDON_LOG_WARNING, "pvr.dispatcharr: failed to write EPG cache for %s", label(i).c_str());
+        }
+        else if (guides[i].ProgrammeCount() == 0 &&
+                 (held[i].streamsHash != streamsHash || !LoadEpgSource(i, signature, held[i], guides[i])))
+        {
+          continue;
+        }
+        parts.push_back(&guides[i]);
+      }
 
-    (void)WriteStringToFileAtomic(path, blob);
+      const xtream::perf::ScopedStage timing(xtream::perf::Stage::XmltvParse);
+      xtream::EpgStoreBuilder builder;
+      if (settings.epgLazyText)
+        (void)builder.EnableLazyText(EpgLazyTextPath());
+      builder.AddMerged(parts);
+      epgData = builder.Build();
+      kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: merged %zu of %zu XMLTV sources", parts.size(), sourceCount);
+    }
+
+    auto epgStore = std::make_shared<const xtream::EpgStore>(std::move(epgData));
+    std::vector<xtream::EpgStore>().swap(guides);
+    kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: loaded EPG for %zu channels (%zu programmes, %zu KB text)",
+              epgStore->ChannelCount(), epgStore->ProgrammeCount(), epgStore->ArenaBytes() / 1024);
+    xtream::perf::Add(xtream::perf::Counter::Programmes, epgStore->ProgrammeCount());
+    xtream::perf::NotePeak(xtream::perf::Peak::EpgText, epgStore->ArenaBytes());
+
+    // Only channels whose programmes differ from the guide Kodi already has need an
+    // update. Without a previous guide every channel with programmes counts, since the
+    // channel list itself may be unchanged and not re-announced to Kodi.
+    const xtream::EpgStore noGuide;
+    const std::vector<int> changedStreams = epgStore->ChangedStreams(previousEpg ? *previousEpg : noGuide);
+
+    std::shared_ptr<const Snapshot> published;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (gen != m_generation.load())
+        return false;
+      published = PublishLocked([&](Snapshot& next) {
+        next.epgStore = epgStore;
+        next.epgSignature = signature;
+      });
+      m_epgSources = states;
+    }
+    const std::shared_ptr<const ChannelList>& channels = published->channels;
+    const std::shared_ptr<const UidToStreamMap>& uidToStream = published->uidToStreamId;
+
+    // Best-effort: next startup maps this file and serves the guide before any fetch.
+    {
+      const xtream::perf::ScopedStage timing(xtream::perf::Stage::EpgCache);
+      if (!epgStore->WriteCacheFile(EpgCachePath(), signature, SerializeEpgSourceStates(states), ts))
+        kodi::Log(ADDON_LOG_WARNING, "pvr.dispatcharr: failed to write EPG cache");
+    }
+
+    if (channels && uidToStream && !changedStreams.empty())
+    {
+      size_t triggered = 0;
+      for (const auto& ch : *channels)
+      {
+        const auto it = uidToStream->find(ch.GetUniqueId());
+        if (it == uidToStream->end() ||
+            !std::binary_search(changedStreams.begin(), changedStreams.end(), it->second))
+          continue;
+        TriggerEpgUpdate(ch.GetUniqueId());
+        ++triggered;
+      }
+      kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: EPG changed for %zu channels", triggered);
+    }
+    return allCurrent;
+  }
+
+  enum class RefreshKind
+  {
+    Requested,         // EnsureLoaded asked for a load (first load or new settings)
+    ScheduledChannels, // periodic full reload, or a retry after a failed one
+    ScheduledEpg       // periodic guide-only refresh, or a retry after a failed one
+  };
+
+  // Blocks until EnsureLoaded requests a load or a scheduled refresh falls due.
+  RefreshKind WaitForRefreshLocked(std::unique_lock<std::mutex>& lock)
+  {
+    while (!m_stopRequested)
+    {
+      if (m_workRequested)
+        return RefreshKind::Requested;
+      const auto now = std::chrono::steady_clock::now();
+      if (m_nextChannelRefresh <= now)
+        return RefreshKind::ScheduledChannels;
+      if (m_nextEpgRefresh <= now)
+        return RefreshKind::ScheduledEpg;
+
+      const auto due = std::min(m_nextChannelRefresh, m_nextEpgRefresh);
+      if (due == std::chrono::steady_clock::time_point::max())
+        m_cv.wait(lock);
+      else
+        m_cv.wait_until(lock, due);
+    }
+    return RefreshKind::Requested;
+  }
+
+  // Scales `base` by a random factor so boxes started together drift apart instead of
+  // hitting the provider in step.
+  std::chrono::steady_clock::duration JitteredLocked(std::chrono::seconds base)
+  {
+    std::uniform_real_distribution<double> factor(1.0 - kRefreshJitter, 1.0 + kRefreshJitter);
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(base.count()) * factor(m_refreshRng)));
+  }
+
+  std::chrono::steady_clock::duration BackoffLocked(int failures)
+  {
+    const int shift = std::min(std::max(failures - 1, 0), 16);
+    return JitteredLocked(std::chrono::seconds(std::min(kRetryBaseSeconds << shift, kRetryMaxSeconds)));
+  }
+
+  // Records how a full load ended and picks the next one: the configured interval after
+  // a success (none when it is 0), exponential backoff after a failure.
+  void ScheduleChannelRefreshLocked(bool succeeded)
+  {
+    const auto now = std::chrono::steady_clock::now();
+    if (succeeded)
+    {
+      m_channelFailures = 0;
+      const int minutes = m_xtreamSettings.channelRefreshMinutes;
+      m_nextChannelRefresh = minutes > 0 ? now + JitteredLocked(std::chrono::minutes(minutes))
+                                         : std::chrono::steady_clock::time_point::max();
+    }
+    else
+    {
+      ++m_channelFailures;
+      m_nextChannelRefresh = now + BackoffLocked(m_channelFailures);
+    }
+  }
+
+  void ScheduleEpgRefreshLocked(bool succeeded)
+  {
+    const auto now = std::chrono::steady_clock::now();
+    if (succeeded)
+    {
+      m_epgFailures = 0;
+      const int minutes = m_xtreamSettings.epgRefreshMinutes;
+      m_nextEpgRefresh = minutes > 0 ? now + JitteredLocked(std::chrono::minutes(minutes))
+                                     : std::chrono::steady_clock::time_point::max();
+    }
+    else
+    {
+      ++m_epgFailures;
+      m_nextEpgRefresh = now + BackoffLocked(m_epgFailures);
+    }
+  }
+
+  // SetSettingsOverride leaves running refreshes alone, so a horizon changed while a
+  // guide was being built for `built` is applied here: the guide is rebuilt now rather
+  // than at the next scheduled refresh.
+  void ApplyPendingHorizonLocked(uint64_t gen, const xtream::Settings& built)
+  {
+    if (gen != m_generation.load())
+      return;
+    if (built.epgDaysPast != m_xtreamSettings.epgDaysPast ||
+        built.epgDaysFuture != m_xtreamSettings.epgDaysFuture)
+      m_nextEpgRefresh = std::chrono::steady_clock::now();
+  }
+
+  // Fits a refresh into the memory budget: estimates its peak from the lists it replaces
+  // and narrows the modes `settings` build the guide with until that fits. A list not
+  // held yet is assumed large. `withStreams` is false for guide-only refreshes.
+  xtream::MemoryPlan PlanMemoryLocked(const xtream::Settings& settings, bool withStreams)
+  {
+    const auto snap = CurrentSnapshot();
+    xtream::MemoryFootprint held;
+    xtream::MemoryFootprint last = xtream::AssumedFootprint();
+    if (snap->streams)
+    {
+      held.streams = last.streams = snap->streams->size();
+      held.streamTextBytes = last.streamTextBytes = snap->streams->TextBytes();
+    }
+    if (snap->epgStore)
+    {
+      held.programmes = last.programmes = snap->epgStore->ProgrammeCount();
+      held.epgArenaBytes = last.epgArenaBytes = snap->epgStore->ArenaBytes();
+      held.epgLazyBytes = last.epgLazyBytes = snap->epgStore->LazyTextBytes();
+      last.epgDaysPast = m_epgSources.empty() ? -1 : m_epgSources.front().daysPast;
+      last.epgDaysFuture = m_epgSources.empty() ? -1 : m_epgSources.front().daysFuture;
+    }
+
+    xtream::MemoryModes wanted;
+    wanted.streamingParse = settings.epgStreamingParse;
+    wanted.lazyText = settings.epgLazyText;
+    wanted.daysPast = settings.epgDaysPast;
+    wanted.daysFuture = settings.epgDaysFuture;
+    const xtream::MemoryPlan plan = xtream::PlanMemory(xtream::MemoryBudgetBytes(settings.memoryBudgetMb),
+                                                       xtream::EstimateHeldBytes(held), last, wanted, withStreams);
+
+    // Said once per change; every refresh's perf line carries the figures anyway.
+    const bool changed = plan.economies != m_memoryEconomies || plan.fits != m_memoryFits;
+    m_memoryEconomies = plan.economies;
+    m_memoryFits = plan.fits;
+    if (changed && (plan.economies > 0 || !plan.fits))
+      kodi::Log(plan.fits ? ADDON_LOG_INFO : ADDON_LOG_WARNING,
+                "pvr.dispatcharr: memory budget %llu MB, estimated peak %llu MB%s: %s parse, %s text, "
+                "%d/%d guide days",
+                static_cast<unsigned long long>(plan.budgetBytes >> 20),
+                static_cast<unsigned long long>((plan.heldBytes + plan.growthBytes) >> 20),
+                plan.fits ? "" : " (over budget)", plan.modes.streamingParse ? "streaming" : "buffered",
+                plan.modes.lazyText ? "lazy" : "in-memory", plan.modes.daysPast, plan.modes.daysFuture);
+    return plan;
+  }
+
+  // Guide-only refresh against the published stream list. The request is conditional,
+  // so an unchanged guide costs one round trip.
+  void RefreshEpgOnly(uint64_t gen, const xtream::Settings& settings, const std::string& signature)
+  {
+    const std::vector<std::string> urls = xtream::XmltvSourceUrls(settings);
+    std::shared_ptr<const xtream::StreamTable> streams;
+    std::shared_ptr<const xtream::EpgStore> previousEpg;
+    std::vector<EpgSourceState> held;
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      const auto snap = CurrentSnapshot();
+      streams = snap->streams;
+      previousEpg = snap->epgStore;
+      held = HeldEpgSourcesLocked(signature, urls.size());
+    }
+    if (!streams)
+      return;
+
+    const std::atomic<bool> abandoned{false};
+    const EpgFetchFn fetchEpg = [this, gen, &settings, &urls, &abandoned](size_t source,
+                                                                          xtream::XmltvValidators validators) {
+      return FetchEpg(settings, urls, source, gen, std::move(validators), abandoned);
+    };
+    std::vector<std::pair<size_t, xtream::XmltvValidators>> jobs;
+    for (size_t i = 0; i < urls.size(); ++i)
+      jobs.emplace_back(i, held[i].validators);
+    std::vector<EpgFetch> fetches = FetchEpgSources(fetchEpg, std::move(jobs));
+    if (m_stopRequested || gen != m_generation.load())
+      return;
+
+    const bool ok = PublishEpg(std::move(fetches), fetchEpg, gen, settings, signature, *streams, held,
+                               previousEpg);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (gen == m_generation.load())
+      ScheduleEpgRefreshLocked(ok);
+  }
+
+  // One pass of UpdateChannelIcons, queued by the load that published `channels`.
+  struct IconJob
+  {
+    uint64_t gen = 0;
+    uint64_t seq = 0;
+    xtream::Settings settings;
+    std::shared_ptr<const std::vector<kodi::addon::PVRChannel>> channels;
+    std::shared_ptr<const xtream::StreamTable> streams; // owns the text the views below point into
+    std::vector<std::pair<size_t, std::string_view>> pending;
+    std::vector<std::string_view> iconUrls;
+  };
+
+  // Hands a freshly published list's logos to the icon thread, so downloads never hold
+  // up the refresh worker. A newer job replaces one still queued and cancels one in
+  // progress.
+  void QueueChannelIcons(IconJob job)
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_stopRequested)
+        return;
+      job.seq = ++m_iconJobSeq;
+      m_iconJob = std::move(job);
+      m_iconJobQueued = true;
+      if (!m_iconThread.joinable())
+        m_iconThread = std::thread([this]() { RunIconJobs(); });
+    }
+    m_iconCv.notify_one();
+  }
+
+  void RunIconJobs()
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    while (true)
+    {
+      m_iconCv.wait(lock, [this]() { return m_stopRequested || m_iconJobQueued; });
+      if (m_stopRequested)
+        return;
+      IconJob job = std::move(m_iconJob);
+      m_iconJob = IconJob();
+      m_iconJobQueued = false;
+      lock.unlock();
+      UpdateChannelIcons(job);
+      job = IconJob();
+      lock.lock();
+    }
+  }
+
+  // Runs on the icon thread. For a large list, downloads the logos it was published
+  // without and refreshes old or previously failed copies, then publishes their
+  // local files as an overlay on the same list. `pending` indexes into `channels`.
+  // Afterwards the cache is trimmed to the logos the list still uses.
+  void UpdateChannelIcons(const IconJob& job)
+  {
+    auto cancelled = [this, &job]() {
+      return m_stopRequested || job.gen != m_generation.load() || job.seq != m_iconJobSeq.load();
+    };
+    if (job.channels->size() > kDirectIconLimit && !job.iconUrls.empty())
+    {
+      const xtream::Settings& settings = job.settings;
+      const unsigned parallel =
+          std::min(kIconFetchParallel, static_cast<unsigned>(std::max(1, settings.maxParallelRequests)));
+      const auto t0 = std::chrono::steady_clock::now();
+      const size_t added = m_iconCache.Prefetch(
+          job.iconUrls, parallel,
+          [&settings](const std::string& url, std::string& body) {
+            return xtream::FetchIcon(settings, url, body).ok;
+          },
+          cancelled);
+      kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: cached %zu new channel icons for %zu channels (%lld ms)",
+                added, job.pending.size(),
+                static_cast<long long>(std::chrono::duration_cast<std::chrono::milliseconds>(
+                                           std::chrono::steady_clock::now() - t0)
+                                           .count()));
+      if (cancelled())
+        return;
+
+      if (added > 0 && !job.pending.empty())
+      {
+        // Only the new paths; the list itself stays shared with the snapshot.
+        auto icons = std::make_shared<IconOverlay>();
+        for (const auto& p : job.pending)
+        {
+          std::string local = m_iconCache.Lookup(p.second);
+          if (!local.empty())
+            icons->emplace_back(p.first, std::move(local));
+        }
+        if (!icons->empty())
+        {
+          {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            // Only when nothing replaced the list in the meantime.
+            if (cancelled() || CurrentSnapshot()->channels != job.channels)
+              return;
+            PublishLocked([&](Snapshot& next) { next.channelIcons = std::move(icons); });
+          }
+          TriggerChannelUpdate();
+        }
+      }
+    }
+    if (cancelled())
+      return;
+
+    const size_t pruned = m_iconCache.Prune(job.iconUrls);
+    if (pruned > 0)
+      kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: removed %zu unused channel icons", pruned);
   }
+
   void StartWorkerThread()
   {
     bool shouldStart = false;
@@ -1470,16 +2157,34 @@ private:
         std::string categoryFilterMode;
         std::string categoryFilterRaw;
         bool filterChannelSeparators = true;
+        std::string signature;
+        xtream::MemoryPlan memoryPlan;
+        RefreshKind kind = RefreshKind::Requested;
 
         {
           std::unique_lock<std::mutex> lock(m_mutex);
-          m_cv.wait(lock, [this]() { return m_stopRequested || m_workRequested; });
+          kind = WaitForRefreshLocked(lock);
           if (m_stopRequested)
             return;
 
-          // Consume the current work request. If a new request comes in while we're
-          // loading, EnsureLoaded() will set m_workRequested=true again.
-          m_workRequested = false;
+          if (kind == RefreshKind::Requested)
+          {
+            // Consume the current work request. If a new request comes in while we're
+            // loading, EnsureLoaded() will set m_workRequested=true again.
+            m_workRequested = false;
+          }
+          else if (kind == RefreshKind::ScheduledChannels)
+          {
+            // The current lists stay published until the reload replaces them; the
+            // reload refreshes the guide too.
+            m_nextChannelRefresh = std::chrono::steady_clock::time_point::max();
+            m_nextEpgRefresh = std::chrono::steady_clock::time_point::max();
+            m_loading = true;
+          }
+          else
+          {
+            m_nextEpgRefresh = std::chrono::steady_clock::time_point::max();
+          }
 
           gen = m_generation.load();
           settings = m_xtreamSettings;
@@ -1489,13 +2194,70 @@ private:
           categoryFilterMode = m_categoryFilterMode;
           categoryFilterRaw = m_categoryFilterPatternsRaw;
           filterChannelSeparators = m_filterChannelSeparators;
+          signature = m_settingsSignature;
+          memoryPlan = PlanMemoryLocked(settings, kind != RefreshKind::ScheduledEpg);
+        }
+        const xtream::Settings epgSettings = WithMemoryModes(settings, memoryPlan.modes);
+
+        xtream::perf::BeginRefresh();
+        xtream::perf::NoteMemoryPlan(memoryPlan.budgetBytes, memoryPlan.growthBytes);
+        if (kind == RefreshKind::ScheduledEpg)
+        {
+          const auto tEpg = std::chrono::steady_clock::now();
+          RefreshEpgOnly(gen, epgSettings, signature);
+          {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            ApplyPendingHorizonLocked(gen, settings);
+          }
+          kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: perf %s",
+                    xtream::perf::FormatRefresh("epg", std::chrono::steady_clock::now() - tEpg).c_str());
+          continue;
         }
 
-        kodi::QueueNotification(QUEUE_INFO, ADDON_NAME, "Loading channels...");
+        // Scheduled reloads run silently; only user-visible loads notify.
+        const bool background = kind != RefreshKind::Requested;
+        if (!background)
+          kodi::QueueNotification(QUEUE_INFO, ADDON_NAME, "Loading channels...");
         const auto t0 = std::chrono::steady_clock::now();
 
+        // The XMLTV download and programme parse don't depend on the stream list; only
+        // the id mapping does. Start them now so they overlap the category/stream fetch
+        // and channel building, and map once both sides are ready. The request is
+        // conditional on the guide we already hold when it came from the same settings;
+        // whether it was mapped from the same streams is only known once they arrive.
+        // Supplementary guides download alongside the main one.
+        const std::vector<std::string> epgUrls = xtream::XmltvSourceUrls(epgSettings);
+        std::vector<EpgSourceState> heldEpg;
+        std::shared_ptr<const xtream::EpgStore> previousEpg;
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          previousEpg = CurrentSnapshot()->epgStore;
+          heldEpg = HeldEpgSourcesLocked(signature, epgUrls.size());
+        }
+
+        std::atomic<bool> epgAbandoned{false};
+        const EpgFetchFn fetchEpg = [this, gen, epgSettings, epgUrls, &epgAbandoned](
+                                        size_t source, xtream::XmltvValidators validators) {
+          return FetchEpg(epgSettings, epgUrls, source, gen, std::move(validators), epgAbandoned);
+        };
+        std::vector<std::pair<size_t, xtream::XmltvValidators>> epgJobs;
+        for (size_t i = 0; i < epgUrls.size(); ++i)
+          epgJobs.emplace_back(i, heldEpg[i].validators);
+        std::future<std::vector<EpgFetch>> epgFuture =
+            std::async(std::launch::async, [fetchEpg, jobs = std::move(epgJobs)]() mutable {
+              return FetchEpgSources(fetchEpg, std::move(jobs));
+            });
+
+        // Every early exit below abandons the guide fetch; the future's destructor then
+        // joins a transfer that stops at its next read.
+        struct AbandonOnExit
+        {
+          std::atomic<bool>& flag;
+          ~AbandonOnExit() { flag = true; }
+        } abandonEpg{epgAbandoned};
+
         std::vector<xtream::LiveCategory> categories;
-        std::vector<xtream::LiveStream> streams;
+        xtream::StreamTable streams;
         const xtream::FetchResult catsRes = xtream::FetchLiveCategories(settings, categories);
 
         // If settings changed while we were loading, discard results and immediately loop.
@@ -1505,40 +2267,44 @@ private:
         if (!catsRes.ok)
         {
           {
+            // m_dataLoaded is left alone: a failed background reload keeps serving the
+            // lists it was meant to replace.
             std::lock_guard<std::mutex> lock(m_mutex);
             m_loading = false;
-            m_dataLoaded = false;
             m_workRequested = false;
+            ScheduleChannelRefreshLocked(false);
           }
           kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: failed to load Xtream categories (%s)", catsRes.details.c_str());
-          kodi::QueueNotification(QUEUE_ERROR, ADDON_NAME,
-                                 (std::string("Channel load failed: ") + catsRes.details).c_str());
+          if (!background)
+            kodi::QueueNotification(QUEUE_ERROR, ADDON_NAME,
+                                   (std::string("Channel load failed: ") + catsRes.details).c_str());
           continue;
         }
 
-        const std::vector<std::string> patterns = SplitPatterns(filterRaw);
-        const std::vector<std::string> categoryPatterns = SplitPatterns(categoryFilterRaw);
+        const xtream::NameFilter patterns(SplitPatterns(filterRaw));
+        const xtream::NameFilter categoryPatterns(SplitPatterns(categoryFilterRaw));
         const std::string categoryModeLower = ToLower(categoryFilterMode);
-        const bool wantsUncategorized = (!categoryPatterns.empty() &&
+        const bool wantsUncategorized = (!categoryPatterns.Empty() &&
                                          (categoryModeLower == "include" || categoryModeLower == "exclude") &&
-                                         ShouldFilterOut(categoryPatterns, "Uncategorized"));
+                                         categoryPatterns.Matches("Uncategorized"));
 
         auto failLoad = [&](const std::string& details) {
           {
             std::lock_guard<std::mutex> lock(m_mutex);
             m_loading = false;
-            m_dataLoaded = false;
             m_workRequested = false;
+            ScheduleChannelRefreshLocked(false);
           }
           kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: failed to load Xtream streams (%s)", details.c_str());
-          kodi::QueueNotification(QUEUE_ERROR, ADDON_NAME,
-                                 (std::string("Channel load failed: ") + details).c_str());
+          if (!background)
+            kodi::QueueNotification(QUEUE_ERROR, ADDON_NAME,
+                                   (std::string("Channel load failed: ") + details).c_str());
         };
 
         // Stream fetch strategy:
         // - When category filtering is inactive (or includes "Uncategorized"), prefer single-call all streams.
         // - When category filtering is active and the kept set is small, fetch streams per category.
-        if (categoryPatterns.empty() || categoryModeLower == "all" || wantsUncategorized)
+        if (categoryPatterns.Empty() || categoryModeLower == "all" || wantsUncategorized)
         {
           const xtream::FetchResult sRes = xtream::FetchLiveStreams(settings, 0, streams);
           if (!sRes.ok)
@@ -1555,7 +2321,7 @@ private:
           {
             if (c.id <= 0 || c.name.empty())
               continue;
-            const bool match = ShouldFilterOut(categoryPatterns, c.name);
+            const bool match = categoryPatterns.Matches(c.name);
             if (categoryModeLower == "include")
             {
               if (match)
@@ -1582,31 +2348,21 @@ private:
           }
           else
           {
-            streams.clear();
-            std::vector<xtream::LiveStream> tmp;
-            for (const int catId : keepCatIds)
+            const xtream::FetchResult sRes = xtream::FetchLiveStreamsForCategories(settings, keepCatIds, streams);
+            if (!sRes.ok)
             {
-              tmp.clear();
-              const xtream::FetchResult sRes = xtream::FetchLiveStreams(settings, catId, tmp);
-              if (!sRes.ok)
+              // Fallback to single call.
+              streams = xtream::StreamTable();
+              const xtream::FetchResult sRes2 = xtream::FetchLiveStreams(settings, 0, streams);
+              if (!sRes2.ok)
               {
-                // Fallback to single call.
-                streams.clear();
-                const xtream::FetchResult sRes2 = xtream::FetchLiveStreams(settings, 0, streams);
-                if (!sRes2.ok)
-                {
-                  failLoad(sRes2.details);
-                  goto fetched;
-                }
-                break;
+                failLoad(sRes2.details);
+                continue;
               }
-              streams.insert(streams.end(), tmp.begin(), tmp.end());
             }
           }
         }
 
-      fetched:
-
         // If settings changed while we were loading, discard results and immediately loop.
         if (m_stopRequested || gen != m_generation.load())
           continue;
@@ -1624,121 +2380,60 @@ private:
 
         // patterns/categoryPatterns/categoryModeLower already computed above
 
-        auto SanitizeChannelName = [](const std::string& in) -> std::string {
-          // Trim leading/trailing whitespace
-          auto ltrim = [](const std::string& s) {
-            size_t i = 0;
-            while (i < s.size() && std::isspace(static_cast<unsigned char>(s[i])))
-              ++i;
-            return s.substr(i);
-          };
-          auto rtrim = [](const std::string& s) {
-            if (s.empty())
-              return s;
-            size_t j = s.size();
-            while (j > 0 && std::isspace(static_cast<unsigned char>(s[j - 1])))
-              --j;
-            return s.substr(0, j);
-          };
-
-          std::string s = rtrim(ltrim(in));
-
-          // Decode a few common HTML entities providers often embed
-          auto replace_all = [](std::string& t, const char* from, const char* to) {
-            const std::string a(from);
-            const std::string b(to);
-            size_t pos = 0;
-            while ((pos = t.find(a, pos)) != std::string::npos)
-            {
-              t.replace(pos, a.size(), b);
-              pos += b.size();
-            }
-          };
-          replace_all(s, "&amp;", "&");
-          replace_all(s, "&quot;", "\"");
-          replace_all(s, "&#039;", "'");
-          replace_all(s, "&lt;", "<");
-          replace_all(s, "&gt;", ">");
-
-          // Strip literal unicode escape-code text: uXXXX or \uXXXX
-          auto hexVal = [](char ch) -> int {
-            if (ch >= '0' && ch <= '9')
-              return ch - '0';
-            if (ch >= 'a' && ch <= 'f')
-              return 10 + (ch - 'a');
-            if (ch >= 'A' && ch <= 'F')
-              return 10 + (ch - 'A');
-            return -1;
-          };
-
-          std::string out;
-          out.reserve(s.size());
-          for (size_t i = 0; i < s.size();)
-          {
-            if (s[i] == '\\' && i + 5 < s.size() && s[i + 1] == 'u')
-            {
-              const int h1 = hexVal(s[i + 2]);
-              const int h2 = hexVal(s[i + 3]);
-              const int h3 = hexVal(s[i + 4]);
-              const int h4 = hexVal(s[i + 5]);
-              if (h1 >= 0 && h2 >= 0 && h3 >= 0 && h4 >= 0)
-              {
-                i += 6;
-                continue;
-              }
-            }
-            if (s[i] == 'u' && i + 4 < s.size())
-            {
-              const int h1 = hexVal(s[i + 1]);
-              const int h2 = hexVal(s[i + 2]);
-              const int h3 = hexVal(s[i + 3]);
-              const int h4 = hexVal(s[i + 4]);
-              if (h1 >= 0 && h2 >= 0 && h3 >= 0 && h4 >= 0)
-              {
-                i += 5;
-                continue;
-              }
-            }
-            out.push_back(s[i]);
-            ++i;
-          }
-
-          // Collapse whitespace runs
-          std::string collapsed;
-          collapsed.reserve(out.size());
-          bool prevSpace = false;
-          for (unsigned char ch : out)
-          {
-            if (std::isspace(ch))
-            {
-              if (!prevSpace)
-                collapsed.push_back(' ');
-              prevSpace = true;
-              continue;
-            }
-            prevSpace = false;
-            collapsed.push_back(static_cast<char>(ch));
-          }
-
-          return rtrim(ltrim(collapsed));
-        };
-
         std::vector<kodi::addon::PVRChannel> channels;
         channels.reserve(streams.size());
         std::unordered_map<unsigned int, int> uidToStreamId;
         uidToStreamId.reserve(streams.size());
         std::unordered_map<std::string, std::vector<GroupMember>> groupMembers;
         std::vector<std::string> groupNamesOrdered;
-        std::vector<CacheChannel> cacheChannels;
+        std::vector<xtream::CacheChannel> cacheChannels;
         cacheChannels.reserve(streams.size());
 
-        constexpr size_t kIconEnableThreshold = 800; // keep Kodi responsive on very large lists
-        const bool allowIcons = streams.size() <= kIconEnableThreshold;
+        // Logos are resolved only for channels that survive filtering: a local copy when
+        // there is one, otherwise the index is queued until the list size is known.
+        std::vector<std::pair<size_t, std::string_view>> pendingIcons;
+        std::vector<std::string_view> iconUrls;
 
         int sequentialChannelNumber = 1;
         const std::string channelNumberingLower = ToLower(channelNumbering);
 
+        const bool filterCategories =
+            !categoryPatterns.Empty() && (categoryModeLower == "include" || categoryModeLower == "exclude");
+        std::unordered_map<int, bool> categoryKept; // category id -> streams pass the category filter
+        std::string chName; // reused across streams; SetChannelName copies it
+
         size_t totalValid = 0;
+        auto passesFilters = [&](const auto& s) -> bool {
+          if (filterChannelSeparators && LooksLikeChannelSeparator(s.name))
+            return false;
+
+          ++totalValid;
+
+          // Category filtering is applied before channel-name filtering, decided once per
+          // category id rather than per stream.
+          if (filterCategories)
+          {
+            auto decision = categoryKept.find(s.categoryId);
+            if (decision == categoryKept.end())
+            {
+              auto catItForFilter = categoryIdToName.find(s.categoryId);
+              const std::string_view categoryName =
+                  (catItForFilter != categoryIdToName.end() && !catItForFilter->second.empty())
+                      ? std::string_view(catItForFilter->second)
+                      : std::string_view("Uncategorized");
+              const bool categoryMatches = categoryPatterns.Matches(categoryName);
+              const bool kept = (categoryModeLower == "include") ? categoryMatches : !categoryMatches;
+              decision = categoryKept.emplace(s.categoryId, kept).first;
+            }
+            if (!decision->second)
+              return false;
+          }
+
+          return !patterns.Matches(s.name);
+        };
+
+        xtream::perf::StageAccumulator filterTime(xtream::perf::Stage::Filter);
+        xtream::perf::StageAccumulator sanitizeTime(xtream::perf::Stage::Sanitize);
         for (const auto& s : streams)
         {
           if (s.id <= 0)
@@ -1746,35 +2441,19 @@ private:
           if (s.name.empty())
             continue;
 
-          if (filterChannelSeparators && LooksLikeChannelSeparator(s.name))
+          const auto tFilter = std::chrono::steady_clock::now();
+          const bool kept = passesFilters(s);
+          const auto tSanitize = std::chrono::steady_clock::now();
+          filterTime.Add(tSanitize - tFilter);
+          if (!kept)
             continue;
 
-          ++totalValid;
-
-          // Category filtering is applied before channel-name filtering.
-          if (!categoryPatterns.empty() && (categoryModeLower == "include" || categoryModeLower == "exclude"))
-          {
-            std::string categoryName;
-            auto catItForFilter = categoryIdToName.find(s.categoryId);
-            if (catItForFilter != categoryIdToName.end())
-              categoryName = catItForFilter->second;
-            if (categoryName.empty())
-              categoryName = "Uncategorized";
-
-            const bool categoryMatches = ShouldFilterOut(categoryPatterns, categoryName);
-            if (categoryModeLower == "include" && !categoryMatches)
-              continue;
-            if (categoryModeLower == "exclude" && categoryMatches)
-              continue;
-          }
-
-          if (ShouldFilterOut(patterns, s.name))
-            continue;
+          xtream::SanitizeChannelName(s.name, chName);
+          sanitizeTime.Add(std::chrono::steady_clock::now() - tSanitize);
 
           kodi::addon::PVRChannel ch;
           ch.SetUniqueId(static_cast<unsigned int>(s.id));
           ch.SetIsRadio(false);
-          const std::string chName = SanitizeChannelName(s.name);
           ch.SetChannelName(chName);
 
           int channelNumber = sequentialChannelNumber;
@@ -1782,13 +2461,20 @@ private:
             channelNumber = s.number;
           ch.SetChannelNumber(channelNumber);
 
-          if (allowIcons && !s.icon.empty())
-            ch.SetIconPath(s.icon);
+          if (!s.icon.empty())
+          {
+            iconUrls.push_back(s.icon);
+            std::string local = m_iconCache.Lookup(s.icon);
+            if (!local.empty())
+              ch.SetIconPath(local);
+            else
+              pendingIcons.emplace_back(channels.size(), s.icon);
+          }
 
           channels.push_back(std::move(ch));
           uidToStreamId.emplace(static_cast<unsigned int>(s.id), s.id);
 
-          CacheChannel cc;
+          xtream::CacheChannel cc;
           cc.uid = static_cast<unsigned int>(s.id);
           cc.categoryId = s.categoryId;
           cc.channelNumber = static_cast<unsigned int>(channelNumber);
@@ -1808,6 +2494,15 @@ private:
           ++sequentialChannelNumber;
         }
 
+        // Small lists take the remote logos as before; larger ones are published without
+        // the missing ones and fetched into the icon cache once the load is done.
+        if (channels.size() <= kDirectIconLimit)
+        {
+          for (const auto& pending : pendingIcons)
+            channels[pending.first].SetIconPath(std::string(pending.second));
+          pendingIcons.clear();
+        }
+
         // Add category-based groups
         for (const auto& c : categories)
         {
@@ -1823,64 +2518,122 @@ private:
         const auto t1 = std::chrono::steady_clock::now();
         const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
 
+        // The table owns its text, so publishing it is a pointer swap rather than a copy.
+        auto streamTable = std::make_shared<const xtream::StreamTable>(std::move(streams));
+        auto channelsNow = std::make_shared<const ChannelList>(std::move(channels));
+        auto groupMembersNow = std::make_shared<const GroupMembersMap>(std::move(groupMembers));
+        auto groupNamesNow = std::make_shared<const std::vector<std::string>>(std::move(groupNamesOrdered));
+        auto positionsNow = IndexChannelPositions(*channelsNow, *groupMembersNow);
+        xtream::perf::Add(xtream::perf::Counter::Channels, channelsNow->size());
+        xtream::perf::NotePeak(xtream::perf::Peak::StreamText, streamTable->TextBytes());
+
+        // The snapshot being replaced, kept to work out what Kodi has to re-pull.
+        std::shared_ptr<const ChannelList> channelsBefore;
+        std::shared_ptr<const IconOverlay> iconsBefore;
+        std::shared_ptr<const GroupMembersMap> groupMembersBefore;
+        std::shared_ptr<const std::vector<std::string>> groupNamesBefore;
         {
           std::lock_guard<std::mutex> lock(m_mutex);
           if (m_stopRequested || gen != m_generation.load())
             continue;
 
-          m_channels = std::make_shared<ChannelList>(std::move(channels));
-          m_uidToStreamId = std::make_shared<UidToStreamMap>(std::move(uidToStreamId));
-          m_groupMembers = std::make_shared<GroupMembersMap>(std::move(groupMembers));
-          m_groupNamesOrdered = std::make_shared<std::vector<std::string>>(std::move(groupNamesOrdered));
-          m_streams = std::make_shared<std::vector<xtream::LiveStream>>(streams);
-
-          m_xtreamSettings = settings;
+          const auto before = CurrentSnapshot();
+          channelsBefore = before->channels;
+          iconsBefore = before->channelIcons;
+          groupMembersBefore = before->groupMembers;
+          groupNamesBefore = before->groupNamesOrdered;
+
+          PublishLocked([&](Snapshot& next) {
+            next.channels = channelsNow;
+            next.uidToStreamId = std::make_shared<UidToStreamMap>(std::move(uidToStreamId));
+            next.groupMembers = groupMembersNow;
+            next.channelPositions = positionsNow;
+            next.channelIcons.reset();
+            next.groupNamesOrdered = groupNamesNow;
+            next.groupsReady = true;
+            next.dataSignature = signature;
+            next.streams = streamTable;
+            next.streamFormat = streamFormat;
+          });
+
+          // next.settings and m_xtreamSettings are left as SetSettingsOverride last set
+          // them: `settings` is the copy taken when the load started, and a change made
+          // since (an interval, the horizon) must not be reverted by it. The generation
+          // check above guarantees the signature still matches.
           m_streamFormat = streamFormat;
           m_loading = false;
           m_dataLoaded = true;
-          m_groupsReady = true;
+          ScheduleChannelRefreshLocked(true);
         }
 
-        // Load EPG data from XMLTV endpoint
-        std::string xmltvData;
-        const xtream::FetchResult epgResult = xtream::FetchXMLTVEpg(settings, xmltvData);
-        if (epgResult.ok)
-        {
-          kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: fetched XMLTV EPG data");
-          std::vector<xtream::ChannelEpg> epgData;
-          if (xtream::ParseXMLTV(xmltvData, streams, epgData))
-          {
-            std::lock_guard<std::mutex> lock(m_mutex);
-            m_epgData = std::make_shared<std::vector<xtream::ChannelEpg>>(std::move(epgData));
-            
-            kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: loaded EPG for %zu channels",
-                      m_epgData ? m_epgData->size() : 0u);
-          }
-          else
-          {
-            kodi::Log(ADDON_LOG_WARNING, "pvr.dispatcharr: failed to parse XMLTV data");
-          }
-        }
-        else
+        // Join the XMLTV fetch started above and map it onto the stream list.
+        const auto tEpgWait = std::chrono::steady_clock::now();
+        std::vector<EpgFetch> epgFetches = epgFuture.get();
+        if (m_stopRequested || gen != m_generation.load())
+          continue;
+
+        const auto tEpgReady = std::chrono::steady_clock::now();
+        kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: XMLTV ready %lld ms after load start (waited %lld ms)",
+                  static_cast<long long>(
+                      std::chrono::duration_cast<std::chrono::milliseconds>(tEpgReady - t0).count()),
+                  static_cast<long long>(
+                      std::chrono::duration_cast<std::chrono::milliseconds>(tEpgReady - tEpgWait).count()));
+
+        const bool epgOk = PublishEpg(std::move(epgFetches), fetchEpg, gen, epgSettings, signature,
+                                      *streamTable, heldEpg, previousEpg);
         {
-          kodi::Log(ADDON_LOG_WARNING, "pvr.dispatcharr: failed to fetch XMLTV EPG data: %s", 
-                    epgResult.details.c_str());
+          std::lock_guard<std::mutex> lock(m_mutex);
+          if (gen == m_generation.load())
+            ScheduleEpgRefreshLocked(epgOk);
+          ApplyPendingHorizonLocked(gen, settings);
         }
 
         kodi::Log(ADDON_LOG_INFO,
                   "pvr.dispatcharr: loaded %zu channels in %zu categories (%lld ms)",
-                  m_channels ? m_channels->size() : 0u, categories.size(), static_cast<long long>(ms));
+                  channelsNow->size(), categories.size(), static_cast<long long>(ms));
 
-        const size_t loaded = m_channels ? m_channels->size() : 0u;
-        std::string msg = std::string("Loaded ") + std::to_string(loaded) + " channels";
-        kodi::QueueNotification(QUEUE_INFO, ADDON_NAME, msg.c_str());
+        if (!background)
+        {
+          const size_t loaded = channelsNow->size();
+          std::string msg = std::string("Loaded ") + std::to_string(loaded) + " channels";
+          kodi::QueueNotification(QUEUE_INFO, ADDON_NAME, msg.c_str());
+        }
 
         // Best-effort cache write so startup can seed channels immediately.
-        SaveCache(m_settingsSignature, categories, cacheChannels);
-
-        // Always refresh groups after reload so Kodi drops stale groups/members.
-        TriggerChannelUpdate();
-        TriggerChannelGroupsUpdate();
+        SaveCache(signature, categories, *groupNamesNow, *streamTable, cacheChannels);
+        kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: perf %s",
+                  xtream::perf::FormatRefresh("channels", std::chrono::steady_clock::now() - t0).c_str());
+
+        // Each trigger makes Kodi re-read every channel or every group member set, so
+        // only fire the ones whose content actually changed. Channels go first so group
+        // members are never imported against a stale channel map.
+        const ChannelDelta delta = DiffChannels(channelsBefore.get(), iconsBefore.get(), groupNamesBefore.get(),
+                                                groupMembersBefore.get(), *channelsNow,
+                                                *groupNamesNow, *groupMembersNow);
+        if (delta.ChannelsChanged() || delta.groupsChanged)
+        {
+          kodi::Log(ADDON_LOG_INFO,
+                    "pvr.dispatcharr: channel refresh: %zu added, %zu removed, %zu changed%s, groups %s",
+                    delta.added, delta.removed, delta.changed, delta.reordered ? ", reordered" : "",
+                    delta.groupsChanged ? "changed" : "unchanged");
+        }
+        else
+        {
+          kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: channels and groups unchanged, not notifying Kodi");
+        }
+        if (delta.ChannelsChanged())
+          TriggerChannelUpdate();
+        if (delta.groupsChanged)
+          TriggerChannelGroupsUpdate();
+
+        IconJob iconJob;
+        iconJob.gen = gen;
+        iconJob.settings = settings;
+        iconJob.channels = channelsNow;
+        iconJob.streams = streamTable;
+        iconJob.pending = std::move(pendingIcons);
+        iconJob.iconUrls = std::move(iconUrls);
+        QueueChannelIcons(std::move(iconJob));
       }
     });
   }
@@ -1912,34 +2665,30 @@ private:
     });
   }
 
+  // The published settings. Before the first SetSettingsOverride (CreateInstance normally
+  // seeds it) the settings are read once from Kodi and settings.xml.
+  std::shared_ptr<const SettingsSnapshot> CurrentSettings()
+  {
+    auto snap = std::atomic_load(&m_settingsSnapshot);
+    if (snap)
+      return snap;
+    std::shared_ptr<const SettingsSnapshot> seeded =
+        MakeSettingsSnapshot(xtream::LoadSettings(), ++m_settingsVersion);
+    std::shared_ptr<const SettingsSnapshot> expected;
+    if (std::atomic_compare_exchange_strong(&m_settingsSnapshot, &expected, seeded))
+      return seeded;
+    return expected;
+  }
+
   void EnsureLoaded()
   {
     // Never block Kodi UI/PVR thread on a large HTTP+parse operation.
     // Instead, schedule a background load if needed and serve cached data (or 0) meanwhile.
 
-    xtream::Settings xt;
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      if (m_hasSettingsOverride)
-        xt = m_settingsOverride;
-      else
-        xt = xtream::LoadSettings();
-    }
-
-    const bool haveCreds = !Trim(xt.server).empty() && !Trim(xt.username).empty() && !Trim(xt.password).empty() &&
-                           (xt.port > 0 && xt.port <= 65535);
-    if (!haveCreds)
+    const auto snap = CurrentSettings();
+    if (!snap->haveCredentials)
     {
-      bool shouldWarn = false;
-      {
-        std::lock_guard<std::mutex> lock(m_mutex);
-        if (!m_warnedMissingCreds)
-        {
-          m_warnedMissingCreds = true;
-          shouldWarn = true;
-        }
-      }
-      if (shouldWarn)
+      if (!m_warnedMissingCreds.exchange(true))
       {
         kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: credentials missing or invalid; skipping load");
         kodi::QueueNotification(QUEUE_ERROR, ADDON_NAME,
@@ -1947,93 +2696,64 @@ private:
       }
       return;
     }
+    m_warnedMissingCreds.store(false);
 
-    {
-      std::lock_guard<std::mutex> lock(m_mutex);
-      m_warnedMissingCreds = false;
-    }
-
-    std::string streamFormat;
-    kodi::addon::GetSettingString("stream_format", streamFormat);
-    if (streamFormat.empty())
-      streamFormat = "ts";
-
-    std::string channelNumbering;
-    kodi::addon::GetSettingString("channel_numbering", channelNumbering);
-    if (channelNumbering.empty())
-      channelNumbering = "sequential";
-
-    std::string filterRaw;
-    kodi::addon::GetSettingString("channel_filter_patterns", filterRaw);
-
-    bool filterChannelSeparators = true;
-    kodi::addon::GetSettingBoolean("filter_channel_separators", filterChannelSeparators);
-
-    std::string categoryFilterMode;
-    kodi::addon::GetSettingString("category_filter_mode", categoryFilterMode);
-    if (categoryFilterMode.empty())
-      categoryFilterMode = "all";
-
-    std::string categoryFilterRaw;
-    kodi::addon::GetSettingString("category_filter_patterns", categoryFilterRaw);
+    // Hot path: once a call has found nothing to start for this settings version (the
+    // data is loaded or a load is running or retrying for its signature), later calls
+    // with the same version have nothing to do either and skip m_mutex.
+    if (m_settledVersion.load(std::memory_order_acquire) == snap->version)
+      return;
 
-    // Kodi can fail to initialize addon settings for binary addons early during startup.
-    // In that case, GetSettingString() can return defaults/empties even though settings are
-    // persisted in addon_data. Heuristic: if everything looks like defaults, load from
-    // addon_data/settings.xml.
-    const bool looksLikeDefaults = (ToLower(categoryFilterMode) == "all") &&
-                                  Trim(categoryFilterRaw).empty() &&
-                                  Trim(filterRaw).empty();
+    const std::string& sig = snap->signature;
 
-    if (looksLikeDefaults)
+    // Seed from the on-disk caches once per settings version, not on every callback.
+    if (m_cacheAttemptVersion.exchange(snap->version) != snap->version)
     {
-      std::string xml;
-      if (ReadVfsTextFile("special://profile/addon_data/pvr.dispatcharr/settings.xml", xml))
+      bool attempt = false;
       {
-        std::string tmp;
-        if (ExtractSettingValue(xml, "stream_format", tmp) && !tmp.empty())
-          streamFormat = tmp;
-        if (ExtractSettingValue(xml, "channel_numbering", tmp) && !tmp.empty())
-          channelNumbering = tmp;
-
-        if (ExtractSettingValue(xml, "channel_filter_patterns", tmp))
-          filterRaw = tmp;
-        if (ExtractSettingValue(xml, "category_filter_mode", tmp) && !tmp.empty())
-          categoryFilterMode = tmp;
-        if (ExtractSettingValue(xml, "category_filter_patterns", tmp))
-          categoryFilterRaw = tmp;
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_cacheSignatureAttempted != sig)
+        {
+          m_cacheSignatureAttempted = sig;
+          attempt = true;
+        }
+      }
+      if (attempt)
+      {
+        (void)TryLoadCacheForSignature(sig);
+        (void)TryLoadEpgCacheForSignature(sig);
       }
-    }
-
-    if (categoryFilterMode.empty())
-      categoryFilterMode = "all";
-
-    const std::string sig = xt.server + ":" + std::to_string(xt.port) + "/" + xt.username + "/" +
-                HashHex(xt.password) + "|fmt=" + ToLower(streamFormat) + "|num=" +
-                ToLower(channelNumbering) + "|flt=" + HashHex(filterRaw) + "|catmode=" +
-                ToLower(categoryFilterMode) + "|catflt=" + HashHex(categoryFilterRaw) + "|sep=" +
-                (filterChannelSeparators ? "1" : "0");
-
-    if (m_cacheSignatureAttempted != sig)
-    {
-      m_cacheSignatureAttempted = sig;
-      (void)TryLoadCacheForSignature(sig);
     }
 
     bool shouldStart = false;
     {
       std::lock_guard<std::mutex> lock(m_mutex);
-      if (m_dataLoaded && sig == m_settingsSignature && !m_loading)
-        return;
-      if (m_loading && sig == m_settingsSignature)
+      // Each of these stays true for a signature until the settings change: a load
+      // ends loaded or failed, and a reload or retry sets m_loading again.
+      const bool settled = sig == m_settingsSignature &&
+                           (m_dataLoaded || m_loading ||
+                            // A failed load is retried by the worker on its backoff
+                            // schedule, not on every call.
+                            m_channelFailures > 0);
+      m_settledVersion.store(snap->version, std::memory_order_release);
+      if (settled)
         return;
 
       m_settingsSignature = sig;
+      m_channelFailures = 0;
+      m_epgFailures = 0;
+      m_nextChannelRefresh = std::chrono::steady_clock::time_point::max();
+      m_nextEpgRefresh = std::chrono::steady_clock::time_point::max();
       m_loading = true;
       m_dataLoaded = false;
-      m_groupsReady = false;
+      PublishLocked([&](Snapshot& next) {
+        // Groups built for these settings (a cache seed) stay visible during the load.
+        next.groupsReady = next.groupsReady && next.dataSignature == sig;
+        next.settings = snap->xt;
+        next.streamFormat = snap->streamFormat;
+      });
 
-      m_xtreamSettings = std::move(xt);
+      m_xtreamSettings = snap->xt;
 
       // Initialize Dispatcharr Client
       dispatcharr::DvrSettings ds;
@@ -2045,14 +2765,25 @@ private:
                       ? m_xtreamSettings.dispatcharrPassword 
                       : m_xtreamSettings.password;
       ds.timeoutSeconds = m_xtreamSettings.timeoutSeconds;
-      m_dispatcharrClient = std::make_unique<dispatcharr::Client>(ds);
+      // Updated in place so its tokens survive setting changes that keep the same
+      // server and credentials. Callbacks load it without taking m_mutex.
+      if (const auto dvr = DvrClient())
+        dvr->UpdateSettings(ds);
+      else
+      {
+        auto client = std::make_shared<dispatcharr::Client>(ds);
+        // A background DVR refresh that found changes (a recording finishing, a rule
+        // edited on the server) is pushed to Kodi like a local change.
+        client->SetDvrStateListener([this]() { NotifyDvrChanged(); });
+        std::atomic_store(&m_dispatcharrClient, std::move(client));
+      }
 
-      m_streamFormat = ToLower(streamFormat);
-      m_channelNumbering = ToLower(channelNumbering);
-      m_filterPatternsRaw = filterRaw;
-      m_categoryFilterMode = ToLower(categoryFilterMode);
-      m_categoryFilterPatternsRaw = categoryFilterRaw;
-      m_filterChannelSeparators = filterChannelSeparators;
+      m_streamFormat = snap->streamFormat;
+      m_channelNumbering = snap->channelNumbering;
+      m_filterPatternsRaw = snap->xt.channelFilterPatterns;
+      m_categoryFilterMode = snap->categoryFilterMode;
+      m_categoryFilterPatternsRaw = snap->xt.categoryFilterPatterns;
+      m_filterChannelSeparators = snap->xt.filterChannelSeparators;
 
       ++m_generation;
       m_workRequested = true;
@@ -2072,34 +2803,291 @@ private:
   std::thread m_bootstrap;
   std::atomic<bool> m_stopRequested{false};
   std::atomic<uint64_t> m_generation{0};
+  // Refresh schedule; max() means nothing is due. Guarded by m_mutex.
+  std::chrono::steady_clock::time_point m_nextChannelRefresh = std::chrono::steady_clock::time_point::max();
+  std::chrono::steady_clock::time_point m_nextEpgRefresh = std::chrono::steady_clock::time_point::max();
+  int m_channelFailures = 0;
+  int m_epgFailures = 0;
+  std::mt19937 m_refreshRng{std::random_device{}()};
   std::atomic<int64_t> m_lastRefreshTriggerMs{0};
   bool m_workerStarted = false;
   bool m_workRequested = false;
   bool m_loading = false;
   bool m_dataLoaded = false;
-  bool m_groupsReady = false;
   std::string m_settingsSignature;
-  bool m_hasSettingsOverride = false;
-  xtream::Settings m_settingsOverride;
+  // Latest published settings; accessed only through std::atomic_load/atomic_store.
+  std::shared_ptr<const SettingsSnapshot> m_settingsSnapshot;
+  std::atomic<uint64_t> m_settingsVersion{0};
+  std::atomic<uint64_t> m_cacheAttemptVersion{0};
+  // Settings version EnsureLoaded last handled; it returns early while it still matches.
+  std::atomic<uint64_t> m_settledVersion{0};
   xtream::Settings m_xtreamSettings;
-  std::unique_ptr<dispatcharr::Client> m_dispatcharrClient;
+  // Created by the first EnsureLoaded and kept for the session; atomic_load/store.
+  std::shared_ptr<dispatcharr::Client> m_dispatcharrClient;
   std::string m_streamFormat;
   std::string m_channelNumbering;
   std::string m_filterPatternsRaw;
   std::string m_categoryFilterMode;
   std::string m_categoryFilterPatternsRaw;
   bool m_filterChannelSeparators = true;
-  bool m_warnedMissingCreds = false;
+  std::atomic<bool> m_warnedMissingCreds{false};
   using ChannelList = std::vector<kodi::addon::PVRChannel>;
   using UidToStreamMap = std::unordered_map<unsigned int, int>;
   using GroupMembersMap = std::unordered_map<std::string, std::vector<GroupMember>>;
 
-  std::shared_ptr<const ChannelList> m_channels;
-  std::shared_ptr<const UidToStreamMap> m_uidToStreamId;
-  std::shared_ptr<const std::vector<std::string>> m_groupNamesOrdered;
-  std::shared_ptr<const GroupMembersMap> m_groupMembers;
-  std::shared_ptr<const std::vector<xtream::ChannelEpg>> m_epgData;
-  std::shared_ptr<const std::vector<xtream::LiveStream>> m_streams;
+  // Where a channel sits for zapping: its index in the first group that lists it, or in
+  // the channel list when `group` is null. `group` points into the GroupMembersMap
+  // published alongside.
+  struct ChannelPosition
+  {
+    const std::vector<GroupMember>* group = nullptr;
+    size_t index = 0;
+  };
+  using ChannelPositionMap = std::unordered_map<unsigned int, ChannelPosition>;
+  // Local logos the icon thread fetched after a list was published, as (index into the
+  // list, path) in index order.
+  using IconOverlay = std::vector<std::pair<size_t, std::string>>;
+
+  // What a reload changed relative to the snapshot Kodi was last offered.
+  struct ChannelDelta
+  {
+    size_t added = 0;
+    size_t removed = 0;
+    size_t changed = 0;
+    bool reordered = false;
+    bool groupsChanged = false;
+
+    bool ChannelsChanged() const { return added || removed || changed || reordered; }
+  };
+
+  // Content hash of everything GetChannels hands to Kodi for one channel; `icon`, when
+  // set, replaces its logo as the channel's IconOverlay entry does.
+  static uint64_t HashChannel(const kodi::addon::PVRChannel& ch, const std::string* icon = nullptr)
+  {
+    uint64_t h = DeterministicHash64(std::to_string(ch.GetUniqueId()));
+    h = DeterministicHash64(std::string_view("\x1f", 1), h);
+    h = DeterministicHash64(std::to_string(ch.GetChannelNumber()) + "." + std::to_string(ch.GetSubChannelNumber()), h);
+    h = DeterministicHash64(std::string_view("\x1f", 1), h);
+    h = DeterministicHash64(ch.GetChannelName(), h);
+    h = DeterministicHash64(std::string_view("\x1f", 1), h);
+    h = DeterministicHash64(icon ? *icon : ch.GetIconPath(), h);
+    h = DeterministicHash64(ch.GetIsRadio() ? "r" : "t", h);
+    return h;
+  }
+
+  // Hash of the group list and every member set, in the order Kodi receives them.
+  static uint64_t HashGroups(const std::vector<std::string>& names, const GroupMembersMap& members)
+  {
+    uint64_t h = kFnvOffset;
+    for (const auto& name : names)
+    {
+      h = DeterministicHash64(name, h);
+      h = DeterministicHash64(std::string_view("\x1e", 1), h);
+      const auto it = members.find(name);
+      if (it == members.end())
+        continue;
+      for (const auto& m : it->second)
+      {
+        h = DeterministicHash64(std::to_string(m.channelUid) + ":" + std::to_string(m.channelNumber) + "." +
+                                    std::to_string(m.subChannelNumber),
+                                h);
+        h = DeterministicHash64(std::string_view("\x1f", 1), h);
+      }
+    }
+    return h;
+  }
+
+  // Compares a new snapshot with the previously published one (null when there was none).
+  static ChannelDelta DiffChannels(const ChannelList* beforeChannels,
+                                   const IconOverlay* beforeIcons,
+                                   const std::vector<std::string>* beforeGroupNames,
+                                   const GroupMembersMap* beforeGroupMembers,
+                                   const ChannelList& channels,
+                                   const std::vector<std::string>& groupNames,
+                                   const GroupMembersMap& groupMembers)
+  {
+    ChannelDelta delta;
+    if (!beforeGroupNames || !beforeGroupMembers)
+      delta.groupsChanged = true;
+    else
+      delta.groupsChanged = HashGroups(*beforeGroupNames, *beforeGroupMembers) != HashGroups(groupNames, groupMembers);
+
+    if (!beforeChannels)
+    {
+      delta.added = channels.size();
+      return delta;
+    }
+
+    std::unordered_map<unsigned int, uint64_t> previous;
+    previous.reserve(beforeChannels->size());
+    size_t nextIcon = 0;
+    for (size_t i = 0; i < beforeChannels->size(); ++i)
+    {
+      const std::string* icon = nullptr;
+      if (beforeIcons && nextIcon < beforeIcons->size() && (*beforeIcons)[nextIcon].first == i)
+        icon = &(*beforeIcons)[nextIcon++].second;
+      const kodi::addon::PVRChannel& ch = (*beforeChannels)[i];
+      previous.emplace(ch.GetUniqueId(), HashChannel(ch, icon));
+    }
+
+    for (const auto& ch : channels)
+    {
+      const auto it = previous.find(ch.GetUniqueId());
+      if (it == previous.end())
+      {
+        ++delta.added;
+        continue;
+      }
+      if (it->second != HashChannel(ch))
+        ++delta.changed;
+      previous.erase(it);
+    }
+    delta.removed = previous.size();
+
+    // Same members with the same content can still come back in a different order.
+    if (!delta.added && !delta.removed && beforeChannels->size() == channels.size())
+    {
+      for (size_t i = 0; i < channels.size(); ++i)
+      {
+        if ((*beforeChannels)[i].GetUniqueId() != channels[i].GetUniqueId())
+        {
+          delta.reordered = true;
+          break;
+        }
+      }
+    }
+    return delta;
+  }
+
+  // Everything the Kodi callbacks read, published as one immutable object. Readers take
+  // it with a single atomic load and never block; writers build the next one under
+  // m_mutex with PublishLocked, so concurrent publishes can't lose each other's fields.
+  struct Snapshot
+  {
+    std::shared_ptr<const ChannelList> channels;
+    std::shared_ptr<const UidToStreamMap> uidToStreamId;
+    std::shared_ptr<const std::vector<std::string>> groupNamesOrdered;
+    std::shared_ptr<const GroupMembersMap> groupMembers;
+    std::shared_ptr<const ChannelPositionMap> channelPositions; // built from the two above
+    std::shared_ptr<const IconOverlay> channelIcons; // laid over `channels` by GetChannels
+    bool groupsReady = false;
+    std::string dataSignature; // settings signature the lists above were built for
+    std::shared_ptr<const xtream::StreamTable> streams;
+    std::shared_ptr<const xtream::EpgStore> epgStore;
+    std::string epgSignature; // settings signature epgStore was mapped with
+    xtream::Settings settings;
+    std::string streamFormat;
+  };
+
+  std::shared_ptr<const Snapshot> CurrentSnapshot() const { return std::atomic_load(&m_snapshot); }
+
+  std::shared_ptr<dispatcharr::Client> DvrClient() const
+  {
+    return std::atomic_load(&m_dispatcharrClient);
+  }
+
+  // The client has already dropped its cached DVR state; Kodi refetches both lists
+  // now rather than at its next poll.
+  void NotifyDvrChanged()
+  {
+    TriggerTimerUpdate();
+    TriggerRecordingUpdate();
+  }
+
+  // Copies the current snapshot, applies `update` and publishes the result, which is
+  // returned. The caller holds m_mutex.
+  template<typename Update>
+  std::shared_ptr<const Snapshot> PublishLocked(Update&& update)
+  {
+    auto next = std::make_shared<Snapshot>(*CurrentSnapshot());
+    update(*next);
+    std::shared_ptr<const Snapshot> published = std::move(next);
+    std::atomic_store(&m_snapshot, published);
+    return published;
+  }
+
+  // Indexes every channel's position once per published list, so a tune looks its
+  // neighbours up instead of scanning the groups.
+  static std::shared_ptr<const ChannelPositionMap> IndexChannelPositions(const ChannelList& channels,
+                                                                         const GroupMembersMap& groupMembers)
+  {
+    auto positions = std::make_shared<ChannelPositionMap>();
+    positions->reserve(channels.size());
+    for (const auto& group : groupMembers)
+    {
+      for (size_t i = 0; i < group.second.size(); ++i)
+        positions->emplace(group.second[i].channelUid, ChannelPosition{&group.second, i});
+    }
+    for (size_t i = 0; i < channels.size(); ++i)
+      positions->emplace(channels[i].GetUniqueId(), ChannelPosition{nullptr, i});
+    return positions;
+  }
+
+  // Queues the previous and next channel of `uid`'s group (or of the whole list when it
+  // has none) for background redirect resolution.
+  void WarmZapNeighbours(const Snapshot& snap, unsigned int uid)
+  {
+    if (!snap.uidToStreamId || !snap.channelPositions || !snap.channels)
+      return;
+    const auto pos = snap.channelPositions->find(uid);
+    if (pos == snap.channelPositions->end())
+      return;
+    std::vector<unsigned int> neighbours;
+    const size_t i = pos->second.index;
+    if (pos->second.group)
+    {
+      const std::vector<GroupMember>& members = *pos->second.group;
+      for (const size_t n : {i + members.size() - 1, i + 1})
+        neighbours.push_back(members[n % members.size()].channelUid);
+    }
+    else
+    {
+      const ChannelList& channels = *snap.channels;
+      for (const size_t n : {i + channels.size() - 1, i + 1})
+        neighbours.push_back(channels[n % channels.size()].GetUniqueId());
+    }
+
+    std::vector<std::string> urls;
+    for (const unsigned int n : neighbours)
+    {
+      const auto it = snap.uidToStreamId->find(n);
+      if (n == uid || it == snap.uidToStreamId->end())
+        continue;
+      std::string url = xtream::BuildLiveStreamUrl(snap.settings, it->second, snap.streamFormat);
+      if (!url.empty() && std::find(urls.begin(), urls.end(), url) == urls.end())
+        urls.push_back(std::move(url));
+    }
+    m_zapRedirects.Warm(std::move(urls));
+  }
+
+  // Accessed only through CurrentSnapshot/PublishLocked.
+  std::shared_ptr<const Snapshot> m_snapshot = std::make_shared<const Snapshot>();
+  // Stream URLs of the channels around the last tune, resolved past their redirects.
+  // Declared after m_snapshot, which its resolver thread reads until it is destroyed.
+  xtream::RedirectCache m_zapRedirects{
+      [this](const std::string& url) {
+        return xtream::ResolveStreamRedirect(CurrentSnapshot()->settings, url);
+      },
+      kZapRedirectTtl};
+  // Local copies of channel logos for large lists.
+  xtream::IconCache m_iconCache{TranslateSpecial("special://profile/addon_data/pvr.dispatcharr/icons")};
+  // The icon thread and its next job; started by the first QueueChannelIcons and
+  // joined by the destructor. The job fields are guarded by m_mutex.
+  std::thread m_iconThread;
+  std::condition_variable m_iconCv;
+  IconJob m_iconJob;
+  bool m_iconJobQueued = false;
+  std::atomic<uint64_t> m_iconJobSeq{0};
+  // Worker state for the published guide, one entry per XMLTV source. Guarded by m_mutex.
+  std::vector<EpgSourceState> m_epgSources;
+  // The last memory plan's outcome, so a change of modes is logged once.
+  int m_memoryEconomies = 0;
+  bool m_memoryFits = true;
+  // Fuzzy XMLTV channel matches from earlier refreshes per source, read from
+  // epg_match.cache on the first mapping. Only the worker thread, one refresh at a
+  // time, touches them.
+  std::vector<xtream::EpgMatchTable> m_epgMatches;
+  std::vector<bool> m_epgMatchesLoaded;
 
   // Catchup playback state - set by GetEPGTagStreamProperties, consumed by GetChannelStreamProperties
   struct PendingCatchup
@@ -2128,6 +3116,19 @@ public:
   ADDON_STATUS SetSetting(const std::string& settingName,
                           const kodi::addon::CSettingValue& settingValue) override
   {
+    // A one-shot action: write the report, then switch the toggle back off.
+    if (settingName == "perf_log_report")
+    {
+      if (settingValue.GetBoolean())
+      {
+        kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: performance report (since start)");
+        for (const auto& line : xtream::perf::FormatReport())
+          kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: perf %s", line.c_str());
+        kodi::addon::SetSettingBoolean("perf_log_report", false);
+      }
+      return ADDON_STATUS_OK;
+    }
+
     const bool isConnectionSetting = (settingName == "server") || (settingName == "port") ||
                                      (settingName == "username") || (settingName == "password") ||
                                      (settingName == "timeout_seconds");
@@ -2148,6 +3149,11 @@ public:
       return true;
     };
 
+    // Start from the persisted values the first time, so a single change notification
+    // doesn't publish defaults for every other setting.
+    if (!m_hasCachedSettings)
+      m_cachedSettings = xtream::LoadSettings();
+
     // Cache latest values as Kodi reports them, so actions (like Test connection)
     // can use the current UI values even if Kodi hasn't persisted them yet.
     if (settingName == "server")
@@ -2158,14 +3164,58 @@ public:
       m_cachedSettings.username = settingValue.GetString();
     else if (settingName == "password")
       m_cachedSettings.password = settingValue.GetString();
+    else if (settingName == "dispatcharr_password")
+      m_cachedSettings.dispatcharrPassword = settingValue.GetString();
     else if (settingName == "timeout_seconds")
       m_cachedSettings.timeoutSeconds = settingValue.GetInt();
+    else if (settingName == "max_parallel_requests")
+      m_cachedSettings.maxParallelRequests = std::max(1, std::min(settingValue.GetInt(), 16));
     else if (settingName == "catchup_start_offset_hours")
       m_cachedSettings.catchupStartOffsetHours = settingValue.GetInt();
     else if (settingName == "enable_user_agent_spoofing")
       m_cachedSettings.enableUserAgentSpoofing = settingValue.GetBoolean();
     else if (settingName == "custom_user_agent")
       m_cachedSettings.customUserAgent = settingValue.GetString();
+    else if (settingName == "enable_play_from_start")
+      m_cachedSettings.enablePlayFromStart = settingValue.GetBoolean();
+    else if (settingName == "use_ffmpegdirect")
+      m_cachedSettings.useFFmpegDirect = settingValue.GetBoolean();
+    else if (settingName == "fast_zapping")
+      m_cachedSettings.fastZapping = settingValue.GetBoolean();
+    else if (settingName == "stream_format")
+      m_cachedSettings.streamFormat = settingValue.GetString();
+    else if (settingName == "channel_numbering")
+      m_cachedSettings.channelNumbering = settingValue.GetString();
+    else if (settingName == "channel_filter_patterns")
+      m_cachedSettings.channelFilterPatterns = settingValue.GetString();
+    else if (settingName == "category_filter_mode")
+      m_cachedSettings.categoryFilterMode = settingValue.GetString();
+    else if (settingName == "category_filter_patterns")
+      m_cachedSettings.categoryFilterPatterns = settingValue.GetString();
+    else if (settingName == "filter_channel_separators")
+      m_cachedSettings.filterChannelSeparators = settingValue.GetBoolean();
+    else if (settingName == "http_compression")
+      m_cachedSettings.httpCompression = settingValue.GetBoolean();
+    else if (settingName == "xmltv_url")
+      m_cachedSettings.xmltvUrl = settingValue.GetString();
+    else if (settingName == "xmltv_extra_urls")
+      m_cachedSettings.xmltvExtraUrls = settingValue.GetString();
+    else if (settingName == "epg_streaming_parse")
+      m_cachedSettings.epgStreamingParse = settingValue.GetBoolean();
+    else if (settingName == "channel_refresh_minutes")
+      m_cachedSettings.channelRefreshMinutes = std::max(0, settingValue.GetInt());
+    else if (settingName == "epg_refresh_minutes")
+      m_cachedSettings.epgRefreshMinutes = std::max(0, settingValue.GetInt());
+    else if (settingName == "epg_days_past")
+      m_cachedSettings.epgDaysPast = std::max(0, std::min(settingValue.GetInt(), 31));
+    else if (settingName == "epg_days_future")
+      m_cachedSettings.epgDaysFuture = std::max(0, std::min(settingValue.GetInt(), 31));
+    else if (settingName == "epg_lazy_text")
+      m_cachedSettings.epgLazyText = settingValue.GetBoolean();
+    else if (settingName == "epg_parse_threads")
+      m_cachedSettings.epgParseThreads = std::max(0, std::min(settingValue.GetInt(), 16));
+    else if (settingName == "memory_budget_mb")
+      m_cachedSettings.memoryBudgetMb = std::max(0, std::min(settingValue.GetInt(), 65536));
 
     m_hasCachedSettings = true;
 
@@ -2179,8 +3229,7 @@ public:
     // when the user presses the Apply button.
     if (isReloadAffectingSetting && m_pvrClient)
     {
-      const xtream::Settings s = m_hasCachedSettings ? m_cachedSettings : xtream::LoadSettings();
-      if (haveMinCredentials(s))
+      if (haveMinCredentials(m_cachedSettings))
       {
         kodi::Log(ADDON_LOG_INFO,
                   "pvr.dispatcharr: settings changed (%s) -> trigger channel refresh",
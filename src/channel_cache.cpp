@@ -0,0 +1,325 @@
+#include "channel_cache.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr uint32_t kCacheMagicV1 = 0x31435458; // 'XTC1' little-endian
+constexpr uint32_t kCacheMagicV2 = 0x32435458; // 'XTC2'
+
+void AppendU32(std::string& out, uint32_t v)
+{
+  out.push_back(static_cast<char>(v & 0xFF));
+  out.push_back(static_cast<char>((v >> 8) & 0xFF));
+  out.push_back(static_cast<char>((v >> 16) & 0xFF));
+  out.push_back(static_cast<char>((v >> 24) & 0xFF));
+}
+
+void AppendI32(std::string& out, int32_t v)
+{
+  AppendU32(out, static_cast<uint32_t>(v));
+}
+
+void AppendU64(std::string& out, uint64_t v)
+{
+  for (int i = 0; i < 8; ++i)
+    out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+bool ReadU32(const std::string& in, size_t& off, uint32_t& out)
+{
+  if (off + 4 > in.size())
+    return false;
+  out = static_cast<uint32_t>(static_cast<unsigned char>(in[off])) |
+        (static_cast<uint32_t>(static_cast<unsigned char>(in[off + 1])) << 8) |
+        (static_cast<uint32_t>(static_cast<unsigned char>(in[off + 2])) << 16) |
+        (static_cast<uint32_t>(static_cast<unsigned char>(in[off + 3])) << 24);
+  off += 4;
+  return true;
+}
+
+bool ReadI32(const std::string& in, size_t& off, int32_t& out)
+{
+  uint32_t u = 0;
+  if (!ReadU32(in, off, u))
+    return false;
+  out = static_cast<int32_t>(u);
+  return true;
+}
+
+bool ReadU64(const std::string& in, size_t& off, uint64_t& out)
+{
+  if (off + 8 > in.size())
+    return false;
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i)
+    v |= (static_cast<uint64_t>(static_cast<unsigned char>(in[off + i])) << (8 * i));
+  off += 8;
+  out = v;
+  return true;
+}
+
+// String references are (offset, length) into the blob's text block.
+void AppendRef(std::string& out, const xtream::StreamTextRef& ref)
+{
+  AppendU32(out, ref.offset);
+  AppendU32(out, ref.length);
+}
+
+bool ReadRef(const std::string& in, size_t& off, uint32_t textSize, xtream::StreamTextRef& out)
+{
+  if (!ReadU32(in, off, out.offset) || !ReadU32(in, off, out.length))
+    return false;
+  return out.offset <= textSize && out.length <= textSize - out.offset;
+}
+
+bool HasCategoryName(const xtream::LiveCategory& c)
+{
+  return c.id > 0 && !c.name.empty();
+}
+
+// Stream records: id, category, number, three refs, flags and archive hours.
+constexpr size_t kStreamRecordBytes = 4 * 3 + 8 * 3 + 4 * 2;
+constexpr size_t kChannelRecordBytes = 4 * 3 + 8;
+
+bool DecodeV1(const std::string& blob, size_t off, xtream::ChannelCacheData& out)
+{
+  // Counts come from the file, so reservations are capped by what its size allows.
+  uint32_t catCount = 0;
+  if (!ReadU32(blob, off, catCount))
+    return false;
+  out.categories.reserve(std::min<size_t>(catCount, (blob.size() - off) / 8));
+  for (uint32_t i = 0; i < catCount; ++i)
+  {
+    int32_t id = 0;
+    uint32_t nameLen = 0;
+    if (!ReadI32(blob, off, id) || !ReadU32(blob, off, nameLen) || off + nameLen > blob.size())
+      return false;
+    xtream::LiveCategory c;
+    c.id = static_cast<int>(id);
+    c.name.assign(blob, off, nameLen);
+    off += nameLen;
+    out.categories.push_back(std::move(c));
+  }
+
+  uint32_t chCount = 0;
+  if (!ReadU32(blob, off, chCount))
+    return false;
+  out.channels.reserve(std::min<size_t>(chCount, (blob.size() - off) / 16));
+  for (uint32_t i = 0; i < chCount; ++i)
+  {
+    uint32_t uid = 0;
+    int32_t catId = 0;
+    uint32_t chNum = 0;
+    uint32_t nameLen = 0;
+    if (!ReadU32(blob, off, uid) || !ReadI32(blob, off, catId) || !ReadU32(blob, off, chNum) ||
+        !ReadU32(blob, off, nameLen) || off + nameLen > blob.size())
+      return false;
+    xtream::CacheChannel c;
+    c.uid = uid;
+    c.categoryId = static_cast<int>(catId);
+    c.channelNumber = chNum;
+    c.name.assign(blob, off, nameLen);
+    off += nameLen;
+    out.channels.push_back(std::move(c));
+  }
+  return true;
+}
+
+bool DecodeV2(const std::string& blob, size_t off, xtream::ChannelCacheData& out)
+{
+  uint32_t textSize = 0;
+  if (!ReadU32(blob, off, textSize) || off + textSize > blob.size())
+    return false;
+  const size_t textOff = off;
+  off += textSize;
+  auto text = [&](const xtream::StreamTextRef& ref) {
+    return std::string(blob, textOff + ref.offset, ref.length);
+  };
+
+  uint32_t catCount = 0;
+  if (!ReadU32(blob, off, catCount))
+    return false;
+  out.categories.reserve(std::min<size_t>(catCount, (blob.size() - off) / 12));
+  for (uint32_t i = 0; i < catCount; ++i)
+  {
+    int32_t id = 0;
+    xtream::StreamTextRef name;
+    if (!ReadI32(blob, off, id) || !ReadRef(blob, off, textSize, name))
+      return false;
+    xtream::LiveCategory c;
+    c.id = static_cast<int>(id);
+    c.name = text(name);
+    out.categories.push_back(std::move(c));
+  }
+
+  uint32_t groupCount = 0;
+  if (!ReadU32(blob, off, groupCount))
+    return false;
+  out.groupNames.reserve(std::min<size_t>(groupCount, (blob.size() - off) / 8));
+  for (uint32_t i = 0; i < groupCount; ++i)
+  {
+    xtream::StreamTextRef name;
+    if (!ReadRef(blob, off, textSize, name))
+      return false;
+    out.groupNames.push_back(text(name));
+  }
+
+  // The records keep their references; the builder's buffer is the text block itself.
+  uint32_t streamCount = 0;
+  if (!ReadU32(blob, off, streamCount))
+    return false;
+  xtream::StreamTableBuilder builder;
+  builder.Reserve(std::min<size_t>(streamCount, (blob.size() - off) / kStreamRecordBytes), 0);
+  builder.Text().assign(blob, textOff, textSize);
+  for (uint32_t i = 0; i < streamCount; ++i)
+  {
+    int32_t id = 0;
+    int32_t catId = 0;
+    int32_t number = 0;
+    uint32_t flags = 0;
+    int32_t archiveHours = 0;
+    xtream::StreamTableBuilder::Row row;
+    if (!ReadI32(blob, off, id) || !ReadI32(blob, off, catId) || !ReadI32(blob, off, number) ||
+        !ReadRef(blob, off, textSize, row.name) || !ReadRef(blob, off, textSize, row.icon) ||
+        !ReadRef(blob, off, textSize, row.epgChannelId) || !ReadU32(blob, off, flags) ||
+        !ReadI32(blob, off, archiveHours))
+      return false;
+    row.id = static_cast<int>(id);
+    row.categoryId = static_cast<int>(catId);
+    row.number = static_cast<int>(number);
+    row.tvArchive = (flags & 1u) != 0;
+    row.tvArchiveDuration = static_cast<int>(archiveHours);
+    builder.Add(row);
+  }
+
+  uint32_t chCount = 0;
+  if (!ReadU32(blob, off, chCount))
+    return false;
+  out.channels.reserve(std::min<size_t>(chCount, (blob.size() - off) / kChannelRecordBytes));
+  for (uint32_t i = 0; i < chCount; ++i)
+  {
+    uint32_t uid = 0;
+    int32_t catId = 0;
+    uint32_t chNum = 0;
+    xtream::StreamTextRef name;
+    if (!ReadU32(blob, off, uid) || !ReadI32(blob, off, catId) || !ReadU32(blob, off, chNum) ||
+        !ReadRef(blob, off, textSize, name))
+      return false;
+    xtream::CacheChannel c;
+    c.uid = uid;
+    c.categoryId = static_cast<int>(catId);
+    c.channelNumber = chNum;
+    c.name = text(name);
+    out.channels.push_back(std::move(c));
+  }
+
+  out.streams = builder.Build();
+  out.hasStreams = true;
+  return true;
+}
+} // namespace
+
+namespace xtream
+{
+std::string EncodeChannelCache(const std::string& signature,
+                               uint64_t timestamp,
+                               const std::vector<LiveCategory>& categories,
+                               const std::vector<std::string>& groupNames,
+                               const StreamTable& streams,
+                               const std::vector<CacheChannel>& channels)
+{
+  // Every string goes into one block first; records only carry references.
+  StreamTableBuilder text;
+  size_t textBytes = streams.TextBytes();
+  size_t categoryCount = 0;
+  for (const auto& c : categories)
+  {
+    if (!HasCategoryName(c))
+      continue;
+    ++categoryCount;
+    textBytes += c.name.size();
+  }
+  for (const auto& g : groupNames)
+    textBytes += g.size();
+  for (const auto& c : channels)
+    textBytes += c.name.size();
+  text.Text().reserve(textBytes);
+
+  std::string records;
+  records.reserve(12 + categoryCount * 12 + groupNames.size() * 8 +
+                  streams.size() * kStreamRecordBytes + channels.size() * kChannelRecordBytes);
+
+  AppendU32(records, static_cast<uint32_t>(categoryCount));
+  for (const auto& c : categories)
+  {
+    if (!HasCategoryName(c))
+      continue;
+    AppendI32(records, static_cast<int32_t>(c.id));
+    AppendRef(records, text.Append(c.name));
+  }
+
+  AppendU32(records, static_cast<uint32_t>(groupNames.size()));
+  for (const auto& g : groupNames)
+    AppendRef(records, text.Append(g));
+
+  AppendU32(records, static_cast<uint32_t>(streams.size()));
+  for (const auto& s : streams)
+  {
+    AppendI32(records, static_cast<int32_t>(s.id));
+    AppendI32(records, static_cast<int32_t>(s.categoryId));
+    AppendI32(records, static_cast<int32_t>(s.number));
+    AppendRef(records, text.Append(s.name));
+    AppendRef(records, text.Append(s.icon));
+    AppendRef(records, text.Append(s.epgChannelId));
+    AppendU32(records, s.tvArchive ? 1u : 0u);
+    AppendI32(records, static_cast<int32_t>(s.tvArchiveDuration));
+  }
+
+  AppendU32(records, static_cast<uint32_t>(channels.size()));
+  for (const auto& c : channels)
+  {
+    AppendU32(records, static_cast<uint32_t>(c.uid));
+    AppendI32(records, static_cast<int32_t>(c.categoryId));
+    AppendU32(records, static_cast<uint32_t>(c.channelNumber));
+    AppendRef(records, text.Append(c.name));
+  }
+
+  const std::string& block = text.Text();
+  std::string blob;
+  blob.reserve(24 + signature.size() + block.size() + records.size());
+  AppendU32(blob, kCacheMagicV2);
+  AppendU32(blob, static_cast<uint32_t>(signature.size()));
+  blob.append(signature);
+  AppendU64(blob, timestamp);
+  AppendU32(blob, static_cast<uint32_t>(block.size()));
+  blob.append(block);
+  blob.append(records);
+  return blob;
+}
+
+bool DecodeChannelCache(const std::string& blob, const std::string& signature, ChannelCacheData& out)
+{
+  out = ChannelCacheData();
+
+  size_t off = 0;
+  uint32_t magic = 0;
+  if (!ReadU32(blob, off, magic) || (magic != kCacheMagicV1 && magic != kCacheMagicV2))
+    return false;
+
+  uint32_t sigLen = 0;
+  if (!ReadU32(blob, off, sigLen) || off + sigLen > blob.size())
+    return false;
+  if (blob.compare(off, sigLen, signature) != 0)
+    return false;
+  off += sigLen;
+
+  if (!ReadU64(blob, off, out.timestamp))
+    return false;
+
+  const bool ok = magic == kCacheMagicV2 ? DecodeV2(blob, off, out) : DecodeV1(blob, off, out);
+  if (!ok)
+    out = ChannelCacheData();
+  return ok;
+}
+} // namespace xtream
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "stream_table.h"
+#include "xtream_client.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xtream
+{
+// One channel as channels.cache stores it.
+struct CacheChannel
+{
+  unsigned int uid = 0;
+  int categoryId = 0;
+  unsigned int channelNumber = 0;
+  std::string name;
+};
+
+// Decoded channels.cache contents.
+struct ChannelCacheData
+{
+  uint64_t timestamp = 0;
+  std::vector<LiveCategory> categories;
+  std::vector<CacheChannel> channels;
+  // Only 'XTC2' files carry these; hasStreams is false after reading an 'XTC1' file.
+  std::vector<std::string> groupNames; // in the order they were published to Kodi
+  StreamTable streams;
+  bool hasStreams = false;
+};
+
+// Serialises everything startup needs to serve Kodi before the first fetch ('XTC2',
+// little-endian): the settings signature and write time, one block holding every
+// string, then fixed-size records referencing it: categories with an id and name,
+// ordered group names, the complete stream records (icon, EPG channel id, archive) and
+// the channels.
+std::string EncodeChannelCache(const std::string& signature,
+                               uint64_t timestamp,
+                               const std::vector<LiveCategory>& categories,
+                               const std::vector<std::string>& groupNames,
+                               const StreamTable& streams,
+                               const std::vector<CacheChannel>& channels);
+
+// Parses a blob written by EncodeChannelCache, or an 'XTC1' file from an older version
+// (categories and channels only). The stream table is rebuilt over a single copy of
+// the string block. Returns false when the blob is truncated or malformed, or was
+// written for another signature.
+bool DecodeChannelCache(const std::string& blob, const std::string& signature, ChannelCacheData& out);
+} // namespace xtream
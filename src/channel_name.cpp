@@ -0,0 +1,110 @@
+#include "channel_name.h"
+
+#include <cctype>
+
+namespace
+{
+bool IsHex(char ch)
+{
+  return (ch >= '0' && ch <= '9') || (ch >= 'a' && ch <= 'f') || (ch >= 'A' && ch <= 'F');
+}
+
+bool HexRun4(std::string_view s, size_t pos)
+{
+  return IsHex(s[pos]) && IsHex(s[pos + 1]) && IsHex(s[pos + 2]) && IsHex(s[pos + 3]);
+}
+
+// Matches an entity body ("quot;" etc., the part after '&') at `pos`.
+bool MatchEntityBody(std::string_view s, size_t pos, char& decoded, size_t& length)
+{
+  struct Entity
+  {
+    std::string_view body;
+    char decoded;
+  };
+  static constexpr Entity kEntities[] = {{"quot;", '"'}, {"#039;", '\''}, {"lt;", '<'}, {"gt;", '>'}};
+  for (const Entity& e : kEntities)
+  {
+    if (s.compare(pos, e.body.size(), e.body) == 0)
+    {
+      decoded = e.decoded;
+      length = e.body.size();
+      return true;
+    }
+  }
+  return false;
+}
+} // namespace
+
+namespace xtream
+{
+void SanitizeChannelName(std::string_view in, std::string& out)
+{
+  out.clear();
+  out.reserve(in.size());
+
+  // Whitespace is held back until the next visible character, which collapses runs and
+  // trims both ends without a second pass.
+  bool pendingSpace = false;
+  auto emit = [&](char ch) {
+    if (std::isspace(static_cast<unsigned char>(ch)))
+    {
+      pendingSpace = !out.empty();
+      return;
+    }
+    if (pendingSpace)
+    {
+      out.push_back(' ');
+      pendingSpace = false;
+    }
+    out.push_back(ch);
+  };
+
+  const size_t n = in.size();
+  size_t i = 0;
+  while (i < n)
+  {
+    const char ch = in[i];
+    if (ch == '&')
+    {
+      char decoded = 0;
+      size_t length = 0;
+      if (MatchEntityBody(in, i + 1, decoded, length))
+      {
+        emit(decoded);
+        i += 1 + length;
+        continue;
+      }
+      // "&amp;" decodes first, so its '&' can start one of the others ("&amp;quot;" is a
+      // quote) but never another "&amp;".
+      if (in.compare(i, 5, "&amp;") == 0)
+      {
+        i += 5;
+        if (i < n && MatchEntityBody(in, i, decoded, length))
+        {
+          emit(decoded);
+          i += length;
+        }
+        else
+        {
+          emit('&');
+        }
+        continue;
+      }
+    }
+    // Decoded entities are never hex digits, so the escape can be spotted in the input.
+    if (ch == '\\' && i + 5 < n && in[i + 1] == 'u' && HexRun4(in, i + 2))
+    {
+      i += 6;
+      continue;
+    }
+    if (ch == 'u' && i + 4 < n && HexRun4(in, i + 1))
+    {
+      i += 5;
+      continue;
+    }
+    emit(ch);
+    ++i;
+  }
+}
+} // namespace xtream
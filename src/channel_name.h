@@ -0,0 +1,14 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace xtream
+{
+// Cleans a provider channel name for display, in one pass into `out` (cleared first, so
+// one buffer can be reused across a whole channel list):
+// - decodes &amp; &quot; &#039; &lt; &gt;, including the double-encoded "&amp;quot;" forms;
+// - drops literal unicode escape text left by providers ("\u2605" and a bare "u2605");
+// - collapses whitespace runs to one space and trims both ends.
+void SanitizeChannelName(std::string_view in, std::string& out);
+} // namespace xtream
@@ -8,6 +8,7 @@
 #include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <future>
 #include <iomanip>
 #include <sstream>
 #include <string>
@@ -209,6 +210,132 @@ std::string TimeToIso(time_t t)
   return std::string(buf);
 }
 
+// ----------------------------------------------------------------------------
+// HTTP Helpers
+// ----------------------------------------------------------------------------
+
+constexpr size_t kMaxResponseBytes = 16 * 1024 * 1024; // DVR lists are small; guard against runaway bodies
+
+// "HTTP/1.1 201 Created" -> 201; 0 when there is no status line.
+int HttpStatusCode(const std::string& protocol)
+{
+  const size_t firstSpace = protocol.find(' ');
+  if (firstSpace == std::string::npos)
+    return 0;
+  int code = 0;
+  size_t pos = firstSpace + 1;
+  while (pos < protocol.size() && std::isdigit(static_cast<unsigned char>(protocol[pos])))
+    code = code * 10 + (protocol[pos++] - '0');
+  return code;
+}
+
+bool IsSuccess(int statusCode)
+{
+  return statusCode >= 200 && statusCode < 300;
+}
+
+bool ReadBody(kodi::vfs::CFile& file, std::string& out)
+{
+  out.clear();
+  char buf[16 * 1024];
+  while (true)
+  {
+    const int n = static_cast<int>(file.Read(buf, sizeof(buf)));
+    if (n <= 0)
+      break;
+    out.append(buf, static_cast<size_t>(n));
+    if (out.size() > kMaxResponseBytes)
+      return false;
+  }
+  return true;
+}
+
+std::string Base64Encode(const std::string& input)
+{
+  static const char kAlphabet[] =
+      "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  std::string out;
+  out.reserve((input.size() + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 2 < input.size(); i += 3)
+  {
+    const unsigned v = (static_cast<unsigned char>(input[i]) << 16) |
+                       (static_cast<unsigned char>(input[i + 1]) << 8) |
+                       static_cast<unsigned char>(input[i + 2]);
+    out += kAlphabet[(v >> 18) & 0x3F];
+    out += kAlphabet[(v >> 12) & 0x3F];
+    out += kAlphabet[(v >> 6) & 0x3F];
+    out += kAlphabet[v & 0x3F];
+  }
+  if (i < input.size())
+  {
+    unsigned v = static_cast<unsigned char>(input[i]) << 16;
+    if (i + 1 < input.size())
+      v |= static_cast<unsigned char>(input[i + 1]) << 8;
+    out += kAlphabet[(v >> 18) & 0x3F];
+    out += kAlphabet[(v >> 12) & 0x3F];
+    out += i + 1 < input.size() ? kAlphabet[(v >> 6) & 0x3F] : '=';
+    out += '=';
+  }
+  return out;
+}
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+
+// FNV-1a over a field, with a terminator so adjacent fields can't run together.
+uint64_t HashField(uint64_t h, std::string_view s)
+{
+  for (const char c : s)
+  {
+    h ^= static_cast<unsigned char>(c);
+    h *= 1099511628211ULL;
+  }
+  h ^= 0xFF;
+  return h * 1099511628211ULL;
+}
+
+uint64_t HashField(uint64_t h, long long v)
+{
+  return HashField(h, std::to_string(v));
+}
+
+// Detects whether a background refresh changed anything Kodi shows.
+uint64_t StateSignature(const DvrState& state)
+{
+  uint64_t h = kFnvOffset;
+  h = HashField(h, (state.seriesRulesOk ? 1 : 0) | (state.recurringRulesOk ? 2 : 0) |
+                       (state.recordingsOk ? 4 : 0));
+  for (const auto& r : state.seriesRules)
+  {
+    h = HashField(h, r.tvgId);
+    h = HashField(h, r.title);
+    h = HashField(h, r.mode);
+  }
+  for (const auto& r : state.recurringRules)
+  {
+    h = HashField(h, r.id);
+    h = HashField(h, r.channelId);
+    for (const int d : r.daysOfWeek)
+      h = HashField(h, d);
+    h = HashField(h, r.startTime);
+    h = HashField(h, r.endTime);
+    h = HashField(h, r.startDate);
+    h = HashField(h, r.endDate);
+    h = HashField(h, r.name);
+    h = HashField(h, r.enabled ? 1 : 0);
+  }
+  for (const auto& r : state.recordings)
+  {
+    h = HashField(h, r.id);
+    h = HashField(h, r.channelId);
+    h = HashField(h, r.title);
+    h = HashField(h, r.plot);
+    h = HashField(h, static_cast<long long>(r.startTime));
+    h = HashField(h, static_cast<long long>(r.endTime));
+  }
+  return h;
+}
+
 // Iterates top-level objects in a JSON array string
 template<typename Fn>
 bool ForEachObjectInArray(std::string_view jsonArray, Fn&& fn)
@@ -256,7 +383,44 @@ Client::Client(const DvrSettings& settings) : m_settings(settings)
 {
 }
 
+Client::~Client()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_stateMutex);
+    m_stop = true;
+  }
+  m_stateCv.notify_all();
+  if (m_refreshThread.joinable())
+    m_refreshThread.join();
+}
+
+void Client::UpdateSettings(const DvrSettings& settings)
+{
+  bool serverChanged = false;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    serverChanged = settings.server != m_settings.server || settings.port != m_settings.port ||
+                    settings.username != m_settings.username ||
+                    settings.password != m_settings.password;
+    if (serverChanged)
+    {
+      m_accessToken.clear();
+      m_refreshToken.clear();
+      ++m_credentialsEpoch;
+    }
+    m_settings = settings;
+  }
+  if (serverChanged)
+    InvalidateDvrState();
+}
+
 std::string Client::GetBaseUrl() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  return BaseUrlLocked();
+}
+
+std::string Client::BaseUrlLocked() const
 {
   std::stringstream ss;
   ss << "http://" << m_settings.server;
@@ -265,89 +429,193 @@ std::string Client::GetBaseUrl() const
   return ss.str();
 }
 
-Client::HttpResponse Client::Request(const std::string& method, const std::string& endpoint, const std::string& jsonBody)
+Client::Target Client::TargetLocked(bool withAuth) const
+{
+  Target target;
+  target.baseUrl = BaseUrlLocked();
+  target.timeoutSeconds = m_settings.timeoutSeconds;
+  if (withAuth)
+    target.token = m_accessToken;
+  return target;
+}
+
+Client::HttpResponse Client::Send(const Target& target,
+                                  const std::string& method,
+                                  const std::string& endpoint,
+                                  const std::string& jsonBody)
 {
   HttpResponse resp;
   kodi::vfs::CFile file;
-  std::string url = GetBaseUrl() + endpoint;
-  
-  file.CURLCreate(url);
-  
-  // Headers
-  file.CURLAddOption(KODI_VFS_CURLOPT_HTTPHEADER, "Content-Type: application/json");
-  if (!m_accessToken.empty()) {
-    std::string auth = "Authorization: Bearer " + m_accessToken;
-    file.CURLAddOption(KODI_VFS_CURLOPT_HTTPHEADER, auth.c_str());
+  file.CURLCreate(target.baseUrl + endpoint);
+
+  if (target.timeoutSeconds > 0)
+  {
+    const std::string t = std::to_string(target.timeoutSeconds);
+    file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "connection-timeout", t);
+    file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "timeout", t);
+    // A backend that accepts the connection and then stalls is cut off too.
+    file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "lowspeedtime", t);
   }
+  // Keep 4xx responses readable so their status line can be inspected.
+  file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "failonerror", "false");
+
+  // Headers
+  file.CURLAddOption(ADDON_CURL_OPTION_HEADER, "Content-Type", "application/json");
+  file.CURLAddOption(ADDON_CURL_OPTION_HEADER, "Accept", "application/json");
+  if (!target.token.empty())
+    file.CURLAddOption(ADDON_CURL_OPTION_HEADER, "Authorization", "Bearer " + target.token);
 
   // Method
   if (method == "POST") {
-    file.CURLAddOption(KODI_VFS_CURLOPT_CUSTOMREQUEST, "POST");
-    file.CURLAddOption(KODI_VFS_CURLOPT_POSTFIELDS, jsonBody);
+    file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "customrequest", "POST");
+    // Kodi's curl layer takes the request body base64 encoded.
+    file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "postdata", Base64Encode(jsonBody));
   } else if (method == "DELETE") {
-    file.CURLAddOption(KODI_VFS_CURLOPT_CUSTOMREQUEST, "DELETE");
+    file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "customrequest", "DELETE");
   }
 
-  // Timeout
-  // file.CURLAddOption(KODI_VFS_CURLOPT_TIMEOUT, m_settings.timeoutSeconds);
+  if (!file.CURLOpen(0))
+  {
+    kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: DVR %s %s failed to connect", method.c_str(),
+              endpoint.c_str());
+    return resp;
+  }
 
-  if (file.CURLOpen(0)) {
-    char buf[4096];
-    while (true) {
-      ssize_t read = file.Read(buf, sizeof(buf));
-      if (read <= 0) break;
-      resp.body.append(buf, read);
-    }
-    file.Close();
-    resp.statusCode = 200; 
-  } else {
+  resp.statusCode = HttpStatusCode(file.GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_PROTOCOL, ""));
+  if (!ReadBody(file, resp.body))
+  {
+    kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: DVR %s %s response exceeded %zu bytes",
+              method.c_str(), endpoint.c_str(), kMaxResponseBytes);
     resp.statusCode = 0;
+    resp.body.clear();
   }
-  
+  file.Close();
+
+  if (!IsSuccess(resp.statusCode))
+    kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: DVR %s %s returned %d", method.c_str(),
+              endpoint.c_str(), resp.statusCode);
   return resp;
 }
 
+Client::HttpResponse Client::Request(const std::string& method, const std::string& endpoint, const std::string& jsonBody)
+{
+  Target target;
+  if (!AcquireToken(std::string(), target))
+    return {};
+
+  HttpResponse resp = Send(target, method, endpoint, jsonBody);
+  if (resp.statusCode != 401)
+    return resp;
+
+  // Access tokens are short lived; renew and retry once. A concurrent request may
+  // already have renewed the token this one was sent with.
+  if (!AcquireToken(target.token, target))
+    return resp;
+  return Send(target, method, endpoint, jsonBody);
+}
+
 bool Client::EnsureToken()
 {
-  if (!m_accessToken.empty()) return true;
-  
+  Target target;
+  return AcquireToken(std::string(), target);
+}
+
+bool Client::AcquireToken(const std::string& rejected, Target& target)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (m_renewing)
+  {
+    // Another caller is renewing; its outcome is ours too, so a failing server sees
+    // one login attempt rather than one per waiting request.
+    m_tokenCv.wait(lock, [this]() { return !m_renewing; });
+    if (m_accessToken.empty() || m_accessToken == rejected)
+      return false;
+  }
+  if (!m_accessToken.empty() && m_accessToken != rejected)
+  {
+    target = TargetLocked(true);
+    return true;
+  }
+
+  // Renew without holding m_mutex, so other requests with a valid token (and
+  // UpdateSettings) aren't blocked for the round trip.
+  m_renewing = true;
+  m_accessToken.clear();
+  const Target authTarget = TargetLocked(false);
+  const std::string refreshToken = m_refreshToken;
+  const std::string username = m_settings.username;
+  const std::string password = m_settings.password;
+  const uint64_t epoch = m_credentialsEpoch;
+  lock.unlock();
+
+  TokenResponse tokens;
+  const bool refreshed = !refreshToken.empty() && RefreshAccessToken(authTarget, refreshToken, tokens);
+  const bool ok = refreshed || Login(authTarget, username, password, tokens);
+
+  lock.lock();
+  m_renewing = false;
+  // Tokens for credentials that changed meanwhile are dropped.
+  const bool current = epoch == m_credentialsEpoch;
+  if (current)
+  {
+    if (ok)
+      m_accessToken = tokens.accessToken;
+    // Servers that rotate refresh tokens return the replacement alongside; one that
+    // was refused (expired or revoked) is dropped.
+    if (!tokens.refreshToken.empty())
+      m_refreshToken = tokens.refreshToken;
+    else if (!refreshed)
+      m_refreshToken.clear();
+  }
+  m_tokenCv.notify_all();
+  if (!ok || !current)
+    return false;
+  target = TargetLocked(true);
+  return true;
+}
+
+bool Client::RefreshAccessToken(const Target& target, const std::string& refreshToken, TokenResponse& out)
+{
+  const std::string body = "{\"refresh\":\"" + JsonEscape(refreshToken) + "\"}";
+  const HttpResponse resp = Send(target, "POST", "/api/accounts/token/refresh/", body);
+
+  std::string token;
+  if (IsSuccess(resp.statusCode) && ExtractStringField(resp.body, "access", token) && !token.empty()) {
+    out.accessToken = token;
+    ExtractStringField(resp.body, "refresh", out.refreshToken);
+    return true;
+  }
+  return false;
+}
+
+bool Client::Login(const Target& target,
+                   const std::string& username,
+                   const std::string& password,
+                   TokenResponse& out)
+{
   std::stringstream ss;
-  ss << "{\"username\":\"" << JsonEscape(m_settings.username) 
-     << "\",\"password\":\"" << JsonEscape(m_settings.password) << "\"}";
-  
-  // Bypass Request() to avoid recursion and auth header
-  HttpResponse resp;
-  kodi::vfs::CFile file;
-  file.CURLCreate(GetBaseUrl() + "/api/accounts/token/");
-  file.CURLAddOption(KODI_VFS_CURLOPT_HTTPHEADER, "Content-Type: application/json");
-  file.CURLAddOption(KODI_VFS_CURLOPT_POSTFIELDS, ss.str().c_str());
-  
-  if (file.CURLOpen(0)) {
-    char buf[4096];
-    while (true) {
-      ssize_t read = file.Read(buf, sizeof(buf));
-      if (read <= 0) break;
-      resp.body.append(buf, read);
-    }
-    file.Close();
-    
-    // Parse
-    std::string token;
-    if (ExtractStringField(resp.body, "access", token) && !token.empty()) {
-      m_accessToken = token;
-      return true;
-    }
+  ss << "{\"username\":\"" << JsonEscape(username)
+     << "\",\"password\":\"" << JsonEscape(password) << "\"}";
+
+  const HttpResponse resp = Send(target, "POST", "/api/accounts/token/", ss.str());
+
+  // Parse
+  std::string token;
+  if (IsSuccess(resp.statusCode) && ExtractStringField(resp.body, "access", token) && !token.empty()) {
+    out.accessToken = token;
+    ExtractStringField(resp.body, "refresh", out.refreshToken);
+    return true;
   }
-  kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: Failed to authenticate user %s", m_settings.username.c_str());
+  kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: Failed to authenticate user %s (HTTP %d)",
+            username.c_str(), resp.statusCode);
   return false;
 }
 
 bool Client::FetchSeriesRules(std::vector<SeriesRule>& outRules)
 {
-  if (!EnsureToken()) return false;
   
   auto resp = Request("GET", "/api/channels/series-rules/");
-  if (resp.statusCode != 200) return false;
+  if (!IsSuccess(resp.statusCode)) return false;
   
   outRules.clear();
   // Expecting {"rules": [...]}
@@ -371,7 +639,6 @@ bool Client::FetchSeriesRules(std::vector<SeriesRule>& outRules)
 
 bool Client::AddSeriesRule(const std::string& tvgId, const std::string& title, const std::string& mode)
 {
-  if (!EnsureToken()) return false;
   
   std::stringstream ss;
   ss << "{\"tvg_id\":\"" << JsonEscape(tvgId) << "\"";
@@ -380,22 +647,22 @@ bool Client::AddSeriesRule(const std::string& tvgId, const std::string& title, c
   ss << "}";
   
   auto resp = Request("POST", "/api/channels/series-rules/", ss.str());
-  return resp.statusCode == 200 && resp.body.find("\"success\":true") != std::string::npos;
+  InvalidateDvrState();
+  return IsSuccess(resp.statusCode) && resp.body.find("\"success\":true") != std::string::npos;
 }
 
 bool Client::DeleteSeriesRule(const std::string& tvgId)
 {
-  if (!EnsureToken()) return false;
   // URL encode? Assuming tvgId is safe-ish or basic chars
   auto resp = Request("DELETE", "/api/channels/series-rules/" + tvgId + "/");
-  return resp.statusCode == 200;
+  InvalidateDvrState();
+  return IsSuccess(resp.statusCode);
 }
 
 bool Client::FetchRecurringRules(std::vector<RecurringRule>& outRules)
 {
-  if (!EnsureToken()) return false;
   auto resp = Request("GET", "/api/channels/recurring-rules/");
-  if (resp.statusCode != 200) return false;
+  if (!IsSuccess(resp.statusCode)) return false;
   
   outRules.clear();
   ForEachObjectInArray(resp.body, [&](std::string_view obj){
@@ -433,7 +700,6 @@ bool Client::FetchRecurringRules(std::vector<RecurringRule>& outRules)
 
 bool Client::AddRecurringRule(const RecurringRule& rule)
 {
-  if (!EnsureToken()) return false;
   std::stringstream ss;
   ss << "{\"channel\":" << rule.channelId 
      << ",\"name\":\"" << JsonEscape(rule.name) << "\""
@@ -450,23 +716,24 @@ bool Client::AddRecurringRule(const RecurringRule& rule)
   ss << "]}";
   
   auto resp = Request("POST", "/api/channels/recurring-rules/", ss.str());
-  return resp.statusCode == 200; // 201 actually, but Open returns true
+  InvalidateDvrState();
+  return IsSuccess(resp.statusCode);
 }
 
 bool Client::DeleteRecurringRule(int id)
 {
-  if (!EnsureToken()) return false;
   auto resp = Request("DELETE", "/api/channels/recurring-rules/" + std::to_string(id) + "/");
-  return resp.statusCode == 200;
+  InvalidateDvrState();
+  return IsSuccess(resp.statusCode);
 }
 
 bool Client::FetchRecordings(std::vector<Recording>& outRecordings)
 {
-  if (!EnsureToken()) return false;
   auto resp = Request("GET", "/api/channels/recordings/");
-  if (resp.statusCode != 200) return false;
+  if (!IsSuccess(resp.statusCode)) return false;
   
   outRecordings.clear();
+  const std::string baseUrl = GetBaseUrl();
   ForEachObjectInArray(resp.body, [&](std::string_view obj){
     Recording r;
     if (ExtractIntField(obj, "id", r.id)) {
@@ -487,7 +754,7 @@ bool Client::FetchRecordings(std::vector<Recording>& outRecordings)
       
       // Stream URL
       // /api/channels/recordings/{id}/file/
-      r.streamUrl = GetBaseUrl() + "/api/channels/recordings/" + std::to_string(r.id) + "/file/";
+      r.streamUrl = baseUrl + "/api/channels/recordings/" + std::to_string(r.id) + "/file/";
       
       outRecordings.push_back(r);
     }
@@ -497,14 +764,13 @@ bool Client::FetchRecordings(std::vector<Recording>& outRecordings)
 
 bool Client::DeleteRecording(int id)
 {
-  if (!EnsureToken()) return false;
   auto resp = Request("DELETE", "/api/channels/recordings/" + std::to_string(id) + "/");
-  return resp.statusCode == 200;
+  InvalidateDvrState();
+  return IsSuccess(resp.statusCode);
 }
 
 bool Client::ScheduleRecording(int channelId, time_t startTime, time_t endTime, const std::string& title)
 {
-  if (!EnsureToken()) return false;
   std::stringstream ss;
   ss << "{\"channel\":" << channelId 
      << ",\"start_time\":\"" << TimeToIso(startTime) << "\""
@@ -512,7 +778,205 @@ bool Client::ScheduleRecording(int channelId, time_t startTime, time_t endTime,
      << ",\"custom_properties\":{\"program\":{\"title\":\"" << JsonEscape(title) << "\"}} }";
   
   auto resp = Request("POST", "/api/channels/recordings/", ss.str());
-  return resp.statusCode == 200;
+  InvalidateDvrState();
+  return IsSuccess(resp.statusCode);
+}
+
+// ----------------------------------------------------------------------------
+// DVR state cache
+// ----------------------------------------------------------------------------
+
+bool Client::ListOk(const DvrState& state, unsigned list)
+{
+  switch (list)
+  {
+    case kSeriesRules:
+      return state.seriesRulesOk;
+    case kRecurringRules:
+      return state.recurringRulesOk;
+    default:
+      return state.recordingsOk;
+  }
+}
+
+std::shared_ptr<DvrState> Client::FetchDvrState(unsigned lists)
+{
+  auto state = std::make_shared<DvrState>();
+  // Independent requests; recordings, usually the largest, run on this thread.
+  std::future<bool> series;
+  std::future<bool> recurring;
+  if (lists & (1u << kSeriesRules))
+    series = std::async(std::launch::async, [this, &state]() { return FetchSeriesRules(state->seriesRules); });
+  if (lists & (1u << kRecurringRules))
+    recurring = std::async(std::launch::async, [this, &state]() {
+      return FetchRecurringRules(state->recurringRules);
+    });
+  if (lists & (1u << kRecordings))
+    state->recordingsOk = FetchRecordings(state->recordings);
+  if (series.valid())
+    state->seriesRulesOk = series.get();
+  if (recurring.valid())
+    state->recurringRulesOk = recurring.get();
+  return state;
+}
+
+unsigned Client::DueListsLocked(std::chrono::steady_clock::time_point now) const
+{
+  unsigned due = 0;
+  for (unsigned list = 0; list < kDvrListCount; ++list)
+  {
+    const DvrListTimes& t = m_listTimes[list];
+    if (t.failing ? now - t.attemptedAt >= kDvrListRetry : now - t.fetchedAt >= kDvrStateTtl)
+      due |= 1u << list;
+  }
+  return due;
+}
+
+bool Client::ExpiredLocked(std::chrono::steady_clock::time_point now) const
+{
+  for (unsigned list = 0; list < kDvrListCount; ++list)
+  {
+    // A failing list's copy is dropped by its retries instead.
+    const DvrListTimes& t = m_listTimes[list];
+    if (!t.failing && ListOk(*m_state, list) && now - t.fetchedAt >= kDvrStateMaxStale)
+      return true;
+  }
+  return false;
+}
+
+std::shared_ptr<const DvrState> Client::FetchStateLocked(std::unique_lock<std::mutex>& lock,
+                                                         unsigned lists,
+                                                         bool& changed)
+{
+  changed = false;
+  m_fetching = true;
+  const uint64_t generation = m_stateGeneration;
+  const std::shared_ptr<const DvrState> base = m_state;
+
+  lock.unlock();
+  std::shared_ptr<DvrState> fetched = FetchDvrState(lists);
+  lock.lock();
+
+  m_fetching = false;
+  ++m_fetchSeq;
+  // A fetch that straddled a change may predate it: its result goes to the caller
+  // that asked for it but isn't cached.
+  const bool current = generation == m_stateGeneration;
+  const auto now = std::chrono::steady_clock::now();
+  auto merged = base ? std::make_shared<DvrState>(*base) : std::make_shared<DvrState>();
+  auto take = [&](unsigned list, auto& from, auto& to, bool fromOk, bool& toOk) {
+    if (!(lists & (1u << list)))
+      return;
+    DvrListTimes& t = m_listTimes[list];
+    if (fromOk)
+    {
+      to = std::move(from);
+      toOk = true;
+    }
+    // A list that fails keeps its last good copy until that is too old to serve.
+    else if (!toOk || !current || now - t.fetchedAt >= kDvrStateMaxStale)
+    {
+      to.clear();
+      toOk = false;
+    }
+    if (!current)
+      return;
+    t.attemptedAt = now;
+    t.failing = !fromOk;
+    if (fromOk)
+      t.fetchedAt = now;
+  };
+  take(kSeriesRules, fetched->seriesRules, merged->seriesRules, fetched->seriesRulesOk, merged->seriesRulesOk);
+  take(kRecurringRules, fetched->recurringRules, merged->recurringRules, fetched->recurringRulesOk,
+       merged->recurringRulesOk);
+  take(kRecordings, fetched->recordings, merged->recordings, fetched->recordingsOk, merged->recordingsOk);
+
+  if (current)
+  {
+    const uint64_t signature = StateSignature(*merged);
+    changed = m_state && signature != m_stateSignature;
+    m_state = merged;
+    m_stateSignature = signature;
+  }
+  m_stateCv.notify_all();
+  return merged;
+}
+
+std::shared_ptr<const DvrState> Client::GetDvrState()
+{
+  std::unique_lock<std::mutex> lock(m_stateMutex);
+  while (true)
+  {
+    if (m_state)
+    {
+      const auto now = std::chrono::steady_clock::now();
+      if (DueListsLocked(now) == 0)
+        return m_state;
+      if (!ExpiredLocked(now))
+      {
+        if (!m_fetching && !m_stop)
+        {
+          m_refreshWanted = true;
+          if (!m_refreshThread.joinable())
+            m_refreshThread = std::thread([this]() { RunStateRefresh(); });
+          m_stateCv.notify_all();
+        }
+        return m_state;
+      }
+    }
+    if (!m_fetching)
+      break;
+
+    // Share the round already in flight; fetch again only if it was invalidated.
+    const uint64_t seq = m_fetchSeq;
+    m_stateCv.wait(lock, [this, seq]() { return m_fetchSeq != seq; });
+    if (m_state)
+      return m_state;
+  }
+
+  bool changed = false;
+  const unsigned lists = m_state ? DueListsLocked(std::chrono::steady_clock::now()) : kAllDvrLists;
+  return FetchStateLocked(lock, lists, changed);
+}
+
+void Client::InvalidateDvrState()
+{
+  std::lock_guard<std::mutex> lock(m_stateMutex);
+  m_state.reset();
+  m_refreshWanted = false;
+  ++m_stateGeneration;
+}
+
+void Client::SetDvrStateListener(StateListener listener)
+{
+  std::lock_guard<std::mutex> lock(m_stateMutex);
+  m_listener = std::move(listener);
+}
+
+void Client::RunStateRefresh()
+{
+  std::unique_lock<std::mutex> lock(m_stateMutex);
+  while (true)
+  {
+    m_stateCv.wait(lock, [this]() { return m_stop || (m_refreshWanted && !m_fetching); });
+    if (m_stop)
+      return;
+    m_refreshWanted = false;
+    // Only lists due by now; an invalidated state is refetched by the next caller.
+    const unsigned lists = m_state ? DueListsLocked(std::chrono::steady_clock::now()) : 0;
+    if (lists == 0)
+      continue;
+
+    bool changed = false;
+    FetchStateLocked(lock, lists, changed);
+    if (changed && m_listener && !m_stop)
+    {
+      const StateListener listener = m_listener;
+      lock.unlock();
+      listener();
+      lock.lock();
+    }
+  }
 }
 
 } // namespace dispatcharr
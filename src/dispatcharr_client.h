@@ -1,8 +1,15 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
 #include <string>
+#include <thread>
 #include <vector>
 #include <map>
+#include <mutex>
 #include <ctime>
 
 namespace dispatcharr
@@ -48,16 +55,57 @@ struct Recording
   time_t endTime = 0;
 };
 
+// Everything the timer and recording screens show. The lists are fetched in parallel
+// and cached independently; each *Ok flag says whether that list is usable.
+struct DvrState
+{
+  std::vector<SeriesRule> seriesRules;
+  std::vector<RecurringRule> recurringRules;
+  std::vector<Recording> recordings; // past and scheduled
+  bool seriesRulesOk = false;
+  bool recurringRulesOk = false;
+  bool recordingsOk = false;
+};
+
 struct TokenResponse
 {
   std::string accessToken;
   std::string refreshToken;
 };
 
+// One instance lives for the whole addon session and is safe to call from any
+// callback thread. Requests run concurrently, each on its own handle (a DVR state
+// fetch issues its three in parallel); m_mutex is held only to copy the target and
+// token. The access token is shared across calls, refreshed with the refresh token
+// on 401 and only re-obtained by a full login when that fails. One caller renews
+// it outside the lock while the others wait for its result. Bodies are read to the
+// end before the handle closes so Kodi's curl session pool can reuse the connection
+// for the next request.
+//
+// DVR state for GetTimers and GetRecordings comes from one cache: a fetch asks for
+// the lists it needs concurrently, and each list is cached on its own. A list is
+// reused for kDvrStateTtl and served for up to kDvrStateMaxStale while a background
+// thread refetches it; a list whose fetch failed (a server without that endpoint,
+// one that keeps erroring) is retried alone after kDvrListRetry, keeping its last
+// good copy meanwhile, and never makes callers refetch the others. Every change
+// made through this client invalidates the whole cache.
 class Client
 {
 public:
+  using StateListener = std::function<void()>;
+
+  static constexpr std::chrono::seconds kDvrStateTtl{10};
+  static constexpr std::chrono::seconds kDvrStateMaxStale{300};
+  static constexpr std::chrono::seconds kDvrListRetry{5};
+
   Client(const DvrSettings& settings);
+  ~Client();
+  Client(const Client&) = delete;
+  Client& operator=(const Client&) = delete;
+
+  // Applies changed settings in place. Tokens are kept unless the server or
+  // credentials changed.
+  void UpdateSettings(const DvrSettings& settings);
 
   // Auth
   bool EnsureToken();
@@ -77,18 +125,101 @@ public:
   bool DeleteRecording(int id);
   bool ScheduleRecording(int channelId, time_t startTime, time_t endTime, const std::string& title);
 
+  // Cached DVR state; blocks only when nothing recent enough is cached. Concurrent
+  // callers share one fetch. Never null; check the *Ok flags.
+  std::shared_ptr<const DvrState> GetDvrState();
+
+  // Drops the cached state so the next GetDvrState fetches again.
+  void InvalidateDvrState();
+
+  // Called on the refresh thread when a background refresh found the state changed.
+  void SetDvrStateListener(StateListener listener);
+
 private:
-  DvrSettings m_settings;
-  std::string m_accessToken;
-  
+  // Where and as whom a request goes, copied out of m_mutex so transfers run
+  // without holding it.
+  struct Target {
+    std::string baseUrl;
+    int timeoutSeconds = 0;
+    std::string token; // empty: no Authorization header
+  };
+
   // Helper for HTTP requests
   struct HttpResponse {
-    int statusCode = 0;
+    int statusCode = 0; // parsed from the status line; 0 when the transfer failed
     std::string body;
   };
   
+  // Authenticated request; retries once after refreshing the token on 401.
   HttpResponse Request(const std::string& method, const std::string& endpoint, const std::string& jsonBody = "");
+  static HttpResponse Send(const Target& target, const std::string& method,
+                           const std::string& endpoint, const std::string& jsonBody);
+  Target TargetLocked(bool withAuth) const;
+  // Sets `target` up with a usable access token, renewing it when none is held or
+  // the one held is `rejected`. Returns false when no token could be obtained.
+  bool AcquireToken(const std::string& rejected, Target& target);
+  // Token endpoints, called without m_mutex by the one caller renewing the token.
+  static bool RefreshAccessToken(const Target& target, const std::string& refreshToken, TokenResponse& out);
+  static bool Login(const Target& target,
+                    const std::string& username,
+                    const std::string& password,
+                    TokenResponse& out);
   std::string GetBaseUrl() const;
+  std::string BaseUrlLocked() const;
+
+  // The lists of a DvrState, as bits of a fetch mask.
+  enum DvrList
+  {
+    kSeriesRules,
+    kRecurringRules,
+    kRecordings,
+    kDvrListCount
+  };
+  static constexpr unsigned kAllDvrLists = (1u << kDvrListCount) - 1;
+
+  // When one list of the cached state was last fetched and last attempted.
+  struct DvrListTimes
+  {
+    std::chrono::steady_clock::time_point fetchedAt;
+    std::chrono::steady_clock::time_point attemptedAt;
+    bool failing = false;
+  };
+
+  static bool ListOk(const DvrState& state, unsigned list);
+  std::shared_ptr<DvrState> FetchDvrState(unsigned lists);
+  // Lists of the cached state due for a refetch, and whether one is too old to serve.
+  unsigned DueListsLocked(std::chrono::steady_clock::time_point now) const;
+  bool ExpiredLocked(std::chrono::steady_clock::time_point now) const;
+  // Fetches `lists` with m_stateMutex released around it and merges them into the
+  // cached state. Returns the merged state and sets `changed` when it replaced a
+  // different cached state.
+  std::shared_ptr<const DvrState> FetchStateLocked(std::unique_lock<std::mutex>& lock,
+                                                   unsigned lists,
+                                                   bool& changed);
+  void RunStateRefresh();
+
+  // Guards settings and tokens. Never held across a transfer.
+  mutable std::mutex m_mutex;
+  DvrSettings m_settings;
+  std::string m_accessToken;
+  std::string m_refreshToken;
+  std::condition_variable m_tokenCv; // signalled when a renewal ends
+  bool m_renewing = false;            // a caller is renewing the token
+  uint64_t m_credentialsEpoch = 0;    // bumped when the server or credentials change
+
+  // Guards the DVR state cache below.
+  std::mutex m_stateMutex;
+  std::condition_variable m_stateCv;
+  std::shared_ptr<const DvrState> m_state;
+  DvrListTimes m_listTimes[kDvrListCount];
+  uint64_t m_stateSignature = 0;
+  uint64_t m_stateGeneration = 0; // bumped by InvalidateDvrState
+  uint64_t m_fetchSeq = 0;        // bumped when a fetch finishes
+  bool m_fetching = false;
+  bool m_refreshWanted = false;
+  bool m_stop = false;
+  StateListener m_listener;
+  std::thread m_refreshThread; // started on the first background refresh
 };
 
 } // namespace dispatcharr
@@ -0,0 +1,516 @@
+#include "epg_name_match.h"
+
+#include <algorithm>
+
+namespace
+{
+constexpr uint32_t kMatchMagic = 0x31544D45; // 'EMT1' little-endian
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+// Whole words that only describe the feed, not the channel.
+constexpr std::string_view kTagWords[] = {"hd",    "fhd",   "uhd",   "sd",    "hq",   "4k",
+                                          "8k",    "hevc",  "h264",  "h265",  "x264", "x265",
+                                          "hdr",   "720p",  "1080p", "1080i", "2160p", "720",
+                                          "1080",  "50fps", "60fps"};
+
+constexpr std::string_view kNumberWords[] = {"one", "two",   "three", "four", "five",
+                                             "six", "seven", "eight", "nine", "ten"};
+
+bool IsAsciiLower(char c)
+{
+  return c >= 'a' && c <= 'z';
+}
+
+bool IsDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+// Letters for tokenising: ASCII letters and any UTF-8 byte.
+bool IsWordChar(char c)
+{
+  return IsAsciiLower(c) || IsDigit(c) || static_cast<unsigned char>(c) >= 0x80;
+}
+
+bool IsTagWord(std::string_view word)
+{
+  return std::find(std::begin(kTagWords), std::end(kTagWords), word) != std::end(kTagWords);
+}
+
+// Length of a leading "uk: ", "us | ", "de - " or "[uk] " / "(uk) " prefix in a lower-cased
+// name; 0 when there is none or nothing would be left after it.
+size_t CountryPrefixLength(const std::string& s)
+{
+  size_t pos = 0;
+  const bool bracketed = pos < s.size() && (s[pos] == '[' || s[pos] == '(');
+  if (bracketed)
+    ++pos;
+  const size_t letters = pos;
+  while (pos < s.size() && IsAsciiLower(s[pos]))
+    ++pos;
+  if (pos - letters < 2 || pos - letters > 3)
+    return 0;
+
+  if (bracketed)
+  {
+    if (pos >= s.size() || (s[pos] != ']' && s[pos] != ')'))
+      return 0;
+    ++pos;
+  }
+  else
+  {
+    while (pos < s.size() && s[pos] == ' ')
+      ++pos;
+    if (pos >= s.size() || (s[pos] != ':' && s[pos] != '|' && s[pos] != '-'))
+      return 0;
+    const bool dash = s[pos] == '-';
+    ++pos;
+    // "e-4" is a name, "de - sport" a prefix.
+    if (dash && (pos >= s.size() || s[pos] != ' '))
+      return 0;
+  }
+  while (pos < s.size() && s[pos] == ' ')
+    ++pos;
+  return pos < s.size() ? pos : 0;
+}
+
+void AddWordTokens(std::string_view word, std::vector<std::string>& tokens)
+{
+  if (IsTagWord(word))
+    return;
+  // "bbc1" -> "bbc", "1"
+  size_t start = 0;
+  for (size_t i = 1; i <= word.size(); ++i)
+  {
+    if (i < word.size() && IsDigit(word[i]) == IsDigit(word[i - 1]))
+      continue;
+    const std::string_view part = word.substr(start, i - start);
+    const auto number = std::find(std::begin(kNumberWords), std::end(kNumberWords), part);
+    if (number != std::end(kNumberWords))
+      tokens.push_back(std::to_string(number - std::begin(kNumberWords) + 1));
+    else
+      tokens.emplace_back(part);
+    start = i;
+  }
+}
+
+bool IsNumberToken(const std::string& token)
+{
+  return !token.empty() && (IsDigit(token[0]) || token[0] == '+');
+}
+
+// The numeric tokens of a key, sorted, as one string.
+std::string KeyNumbers(std::string_view key)
+{
+  std::vector<std::string> numbers;
+  size_t start = 0;
+  while (start < key.size())
+  {
+    size_t end = key.find(' ', start);
+    if (end == std::string_view::npos)
+      end = key.size();
+    std::string token(key.substr(start, end - start));
+    if (IsNumberToken(token))
+      numbers.push_back(std::move(token));
+    start = end + 1;
+  }
+  std::sort(numbers.begin(), numbers.end());
+  std::string out;
+  for (const auto& n : numbers)
+  {
+    if (!out.empty())
+      out.push_back(' ');
+    out += n;
+  }
+  return out;
+}
+
+// Distinct byte trigrams of " key ", sorted.
+std::vector<uint32_t> Trigrams(std::string_view key)
+{
+  std::vector<uint32_t> out;
+  if (key.empty())
+    return out;
+  std::string padded;
+  padded.reserve(key.size() + 2);
+  padded.push_back(' ');
+  padded.append(key.data(), key.size());
+  padded.push_back(' ');
+  out.reserve(padded.size() - 2);
+  for (size_t i = 0; i + 3 <= padded.size(); ++i)
+    out.push_back(static_cast<uint32_t>(static_cast<unsigned char>(padded[i])) |
+                  (static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 1])) << 8) |
+                  (static_cast<uint32_t>(static_cast<unsigned char>(padded[i + 2])) << 16));
+  std::sort(out.begin(), out.end());
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+  return out;
+}
+
+uint64_t HashKey(std::string_view key)
+{
+  uint64_t h = kFnvOffset;
+  for (const char c : key)
+  {
+    h ^= static_cast<unsigned char>(c);
+    h *= kFnvPrime;
+  }
+  return h ? h : 1; // 0 means "unknown stream"
+}
+
+// splitmix64 finaliser, so summing pair hashes doesn't let similar pairs cancel.
+uint64_t Mix(uint64_t x)
+{
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+std::string TableKey(const std::string& xmltvId, const std::string& nameKey)
+{
+  std::string key;
+  key.reserve(xmltvId.size() + 1 + nameKey.size());
+  key += xmltvId;
+  key.push_back('\n');
+  key += nameKey;
+  return key;
+}
+
+void AppendU32(std::string& out, uint32_t v)
+{
+  out.push_back(static_cast<char>(v & 0xFF));
+  out.push_back(static_cast<char>((v >> 8) & 0xFF));
+  out.push_back(static_cast<char>((v >> 16) & 0xFF));
+  out.push_back(static_cast<char>((v >> 24) & 0xFF));
+}
+
+void AppendU64(std::string& out, uint64_t v)
+{
+  for (int i = 0; i < 8; ++i)
+    out.push_back(static_cast<char>((v >> (8 * i)) & 0xFF));
+}
+
+bool ReadU32(const std::string& in, size_t& off, uint32_t& out)
+{
+  if (off + 4 > in.size())
+    return false;
+  out = static_cast<uint32_t>(static_cast<unsigned char>(in[off])) |
+        (static_cast<uint32_t>(static_cast<unsigned char>(in[off + 1])) << 8) |
+        (static_cast<uint32_t>(static_cast<unsigned char>(in[off + 2])) << 16) |
+        (static_cast<uint32_t>(static_cast<unsigned char>(in[off + 3])) << 24);
+  off += 4;
+  return true;
+}
+
+bool ReadU64(const std::string& in, size_t& off, uint64_t& out)
+{
+  if (off + 8 > in.size())
+    return false;
+  uint64_t v = 0;
+  for (int i = 0; i < 8; ++i)
+    v |= (static_cast<uint64_t>(static_cast<unsigned char>(in[off + i])) << (8 * i));
+  off += 8;
+  out = v;
+  return true;
+}
+} // namespace
+
+namespace xtream
+{
+std::string EpgNameKey(std::string_view name)
+{
+  std::string s;
+  s.reserve(name.size());
+  for (const char c : name)
+    s.push_back(c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c);
+
+  std::vector<std::string> tokens;
+  size_t i = CountryPrefixLength(s);
+  while (i < s.size())
+  {
+    const char c = s[i];
+    if (IsWordChar(c))
+    {
+      const size_t start = i;
+      while (i < s.size() && IsWordChar(s[i]))
+        ++i;
+      AddWordTokens(std::string_view(s).substr(start, i - start), tokens);
+      continue;
+    }
+    ++i;
+    if (c == '&')
+    {
+      tokens.emplace_back("and");
+    }
+    else if (c == '+')
+    {
+      // "+1" is a timeshift and part of the channel's identity.
+      if (i < s.size() && IsDigit(s[i]))
+      {
+        const size_t start = i - 1;
+        while (i < s.size() && IsDigit(s[i]))
+          ++i;
+        tokens.emplace_back(s, start, i - start);
+      }
+      else
+      {
+        tokens.emplace_back("plus");
+      }
+    }
+  }
+
+  std::string key;
+  for (const auto& token : tokens)
+  {
+    if (!key.empty())
+      key.push_back(' ');
+    key += token;
+  }
+  return key;
+}
+
+void EpgNameIndex::Add(int streamId, std::string_view name)
+{
+  std::string key = EpgNameKey(name);
+  if (key.empty() || m_streamKeyHash.count(streamId))
+    return;
+
+  const uint64_t hash = HashKey(key);
+  m_streamKeyHash.emplace(streamId, hash);
+  m_namesHash += Mix(hash ^ (static_cast<uint64_t>(static_cast<uint32_t>(streamId)) << 32));
+
+  const auto it = m_keyIndex.find(key);
+  if (it != m_keyIndex.end())
+  {
+    m_keyStreams[it->second].push_back(streamId);
+    return;
+  }
+  m_keyIndex.emplace(key, static_cast<uint32_t>(m_keys.size()));
+  m_keys.push_back(std::move(key));
+  m_keyStreams.push_back({streamId});
+  m_trigramsBuilt = false;
+}
+
+const std::vector<int>* EpgNameIndex::FindKey(const std::string& key) const
+{
+  const auto it = m_keyIndex.find(key);
+  return it == m_keyIndex.end() ? nullptr : &m_keyStreams[it->second];
+}
+
+uint64_t EpgNameIndex::KeyHash(int streamId) const
+{
+  const auto it = m_streamKeyHash.find(streamId);
+  return it == m_streamKeyHash.end() ? 0 : it->second;
+}
+
+void EpgNameIndex::BuildTrigrams()
+{
+  m_postings.clear();
+  m_keyTrigrams.assign(m_keys.size(), 0);
+  m_keyNumbers.assign(m_keys.size(), std::string());
+  for (size_t k = 0; k < m_keys.size(); ++k)
+  {
+    const std::vector<uint32_t> trigrams = Trigrams(m_keys[k]);
+    m_keyTrigrams[k] = static_cast<uint32_t>(trigrams.size());
+    m_keyNumbers[k] = KeyNumbers(m_keys[k]);
+    for (const uint32_t t : trigrams)
+      m_postings[t].push_back(static_cast<uint32_t>(k));
+  }
+  m_shared.assign(m_keys.size(), 0);
+  m_touched.clear();
+  m_trigramsBuilt = true;
+}
+
+std::vector<int> EpgNameIndex::FindFuzzy(const std::string& key)
+{
+  const std::vector<uint32_t> query = Trigrams(key);
+  if (query.empty() || m_keys.empty())
+    return {};
+  if (!m_trigramsBuilt)
+    BuildTrigrams();
+
+  for (const uint32_t t : query)
+  {
+    const auto it = m_postings.find(t);
+    if (it == m_postings.end())
+      continue;
+    for (const uint32_t k : it->second)
+    {
+      if (m_shared[k]++ == 0)
+        m_touched.push_back(k);
+    }
+  }
+
+  const std::string numbers = KeyNumbers(key);
+  double best = 0.0;
+  double second = 0.0;
+  uint32_t bestKey = 0;
+  for (const uint32_t k : m_touched)
+  {
+    const uint32_t shared = m_shared[k];
+    m_shared[k] = 0;
+    if (m_keyNumbers[k] != numbers)
+      continue;
+    const double score = 2.0 * shared / static_cast<double>(query.size() + m_keyTrigrams[k]);
+    if (score > best)
+    {
+      second = best;
+      best = score;
+      bestKey = k;
+    }
+    else if (score > second)
+    {
+      second = score;
+    }
+  }
+  m_touched.clear();
+
+  if (best < kMinScore || best - second < kMinLead)
+    return {};
+  return m_keyStreams[bestKey];
+}
+
+void EpgMatchTable::BeginPass()
+{
+  for (auto& entry : m_entries)
+    entry.second.used = false;
+}
+
+void EpgMatchTable::EndPass()
+{
+  for (auto it = m_entries.begin(); it != m_entries.end();)
+  {
+    if (it->second.used)
+    {
+      ++it;
+      continue;
+    }
+    it = m_entries.erase(it);
+    m_dirty = true;
+  }
+}
+
+bool EpgMatchTable::Lookup(const std::string& xmltvId,
+                           const std::string& nameKey,
+                           const EpgNameIndex& index,
+                           std::vector<int>& out)
+{
+  const auto it = m_entries.find(TableKey(xmltvId, nameKey));
+  if (it == m_entries.end())
+    return false;
+  Entry& entry = it->second;
+  if (entry.streamIds.empty())
+  {
+    if (entry.namesHash != index.NamesHash())
+      return false;
+  }
+  else
+  {
+    for (size_t i = 0; i < entry.streamIds.size(); ++i)
+    {
+      if (index.KeyHash(entry.streamIds[i]) != entry.keyHashes[i])
+        return false;
+    }
+  }
+  entry.used = true;
+  out = entry.streamIds;
+  return true;
+}
+
+void EpgMatchTable::Remember(const std::string& xmltvId,
+                             const std::string& nameKey,
+                             const EpgNameIndex& index,
+                             const std::vector<int>& streamIds)
+{
+  Entry next;
+  next.streamIds = streamIds;
+  next.keyHashes.reserve(streamIds.size());
+  for (const int id : streamIds)
+    next.keyHashes.push_back(index.KeyHash(id));
+  if (streamIds.empty())
+    next.namesHash = index.NamesHash();
+  next.used = true;
+
+  Entry& entry = m_entries[TableKey(xmltvId, nameKey)];
+  if (entry.streamIds != next.streamIds || entry.keyHashes != next.keyHashes ||
+      entry.namesHash != next.namesHash)
+    m_dirty = true;
+  entry = std::move(next);
+}
+
+std::string EpgMatchTable::Encode() const
+{
+  // Sorted so an unchanged table encodes to the same bytes.
+  std::vector<const std::pair<const std::string, Entry>*> entries;
+  entries.reserve(m_entries.size());
+  for (const auto& entry : m_entries)
+    entries.push_back(&entry);
+  std::sort(entries.begin(), entries.end(),
+            [](const auto* a, const auto* b) { return a->first < b->first; });
+
+  std::string out;
+  AppendU32(out, kMatchMagic);
+  AppendU32(out, static_cast<uint32_t>(entries.size()));
+  for (const auto* entry : entries)
+  {
+    AppendU32(out, static_cast<uint32_t>(entry->first.size()));
+    out += entry->first;
+    AppendU64(out, entry->second.namesHash);
+    AppendU32(out, static_cast<uint32_t>(entry->second.streamIds.size()));
+    for (size_t i = 0; i < entry->second.streamIds.size(); ++i)
+    {
+      AppendU32(out, static_cast<uint32_t>(entry->second.streamIds[i]));
+      AppendU64(out, entry->second.keyHashes[i]);
+    }
+  }
+  return out;
+}
+
+bool EpgMatchTable::Decode(const std::string& blob)
+{
+  m_entries.clear();
+  m_dirty = false;
+
+  size_t off = 0;
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  if (!ReadU32(blob, off, magic) || magic != kMatchMagic || !ReadU32(blob, off, count))
+    return false;
+
+  std::unordered_map<std::string, Entry> entries;
+  // Counts come from the file, so the reservation is capped by what its size allows.
+  entries.reserve(std::min<size_t>(count, (blob.size() - off) / 16));
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    uint32_t keyLen = 0;
+    if (!ReadU32(blob, off, keyLen) || keyLen > blob.size() - off)
+      return false;
+    std::string key(blob, off, keyLen);
+    off += keyLen;
+
+    Entry entry;
+    uint32_t streams = 0;
+    if (!ReadU64(blob, off, entry.namesHash) || !ReadU32(blob, off, streams) ||
+        streams > (blob.size() - off) / 12)
+      return false;
+    entry.streamIds.reserve(streams);
+    entry.keyHashes.reserve(streams);
+    for (uint32_t s = 0; s < streams; ++s)
+    {
+      uint32_t id = 0;
+      uint64_t hash = 0;
+      if (!ReadU32(blob, off, id) || !ReadU64(blob, off, hash))
+        return false;
+      entry.streamIds.push_back(static_cast<int>(id));
+      entry.keyHashes.push_back(hash);
+    }
+    entries[std::move(key)] = std::move(entry);
+  }
+  if (off != blob.size())
+    return false;
+
+  m_entries = std::move(entries);
+  return true;
+}
+} // namespace xtream
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace xtream
+{
+// Canonical form of a channel name for guide matching: lower case, a short country or
+// category prefix ("UK: ", "[US] ") dropped, quality and codec tags (HD, FHD, 4K, HEVC,
+// 1080p, ...) dropped, punctuation removed, letters and digits split ("BBC1" ->
+// "bbc 1"), number words one to ten written as digits, '&' as "and" and a '+' that is
+// not a timeshift ("+1") as "plus". Tokens are joined by single spaces; empty when
+// nothing but tags is left.
+std::string EpgNameKey(std::string_view name);
+
+// Stream names indexed by EpgNameKey for the inexact XMLTV mapping tiers. Exact key
+// lookups are a hash probe; the trigram index for fuzzy lookups is only built by the
+// first FindFuzzy call. Not thread-safe.
+class EpgNameIndex
+{
+public:
+  // Lowest trigram Dice score a fuzzy candidate needs, and how far it must lead the
+  // runner-up to be taken.
+  static constexpr double kMinScore = 0.75;
+  static constexpr double kMinLead = 0.08;
+
+  void Add(int streamId, std::string_view name);
+
+  // Streams whose key is exactly `key`, or nullptr.
+  const std::vector<int>* FindKey(const std::string& key) const;
+
+  // Streams under the key closest to `key` by trigram similarity. Empty when no key
+  // scores kMinScore, when two keys are too close to call, or when the numbers in the
+  // names differ ("Sport 1" never matches "Sport 2").
+  std::vector<int> FindFuzzy(const std::string& key);
+
+  // Hash of the key `streamId` was indexed under; 0 for an unknown stream.
+  uint64_t KeyHash(int streamId) const;
+
+  // Order-independent hash over every (stream, key) pair. Changes whenever a stream is
+  // added, removed or renamed.
+  uint64_t NamesHash() const { return m_namesHash; }
+
+private:
+  void BuildTrigrams();
+
+  std::vector<std::string> m_keys; // distinct keys
+  std::vector<std::vector<int>> m_keyStreams;
+  std::unordered_map<std::string, uint32_t> m_keyIndex;
+  std::unordered_map<int, uint64_t> m_streamKeyHash;
+  uint64_t m_namesHash = 0;
+
+  bool m_trigramsBuilt = false;
+  std::unordered_map<uint32_t, std::vector<uint32_t>> m_postings; // trigram -> keys
+  std::vector<uint32_t> m_keyTrigrams;                            // distinct trigrams per key
+  std::vector<std::string> m_keyNumbers;                          // numeric tokens per key
+  std::vector<uint32_t> m_shared;                                 // FindFuzzy scratch
+  std::vector<uint32_t> m_touched;
+};
+
+// Results of the fuzzy tier remembered across refreshes (epg_match.cache), so only
+// XMLTV channels that are new, renamed, or whose matched streams changed are scored
+// again. Entries are keyed by XMLTV channel id and display-name key. A match stays
+// valid while every stream it named still has the same key; a miss only while the
+// stream names as a whole are unchanged. Not thread-safe.
+class EpgMatchTable
+{
+public:
+  // Marks every entry unused; EndPass drops those still unused.
+  void BeginPass();
+  void EndPass();
+
+  // The remembered result, if it still applies to `index`. `out` may be empty: a
+  // remembered miss.
+  bool Lookup(const std::string& xmltvId,
+              const std::string& nameKey,
+              const EpgNameIndex& index,
+              std::vector<int>& out);
+
+  void Remember(const std::string& xmltvId,
+                const std::string& nameKey,
+                const EpgNameIndex& index,
+                const std::vector<int>& streamIds);
+
+  size_t Size() const { return m_entries.size(); }
+
+  // Set by Remember and EndPass when the table differs from what was last decoded or
+  // encoded.
+  bool Dirty() const { return m_dirty; }
+  void ClearDirty() { m_dirty = false; }
+
+  // 'EMT1', little-endian: entry count, then per entry the key, the names hash of a
+  // miss and the (stream id, key hash) pairs of a match.
+  std::string Encode() const;
+  // Replaces the table. Returns false (leaving it empty) on a truncated or foreign blob.
+  bool Decode(const std::string& blob);
+
+private:
+  struct Entry
+  {
+    std::vector<int> streamIds;      // empty for a miss
+    std::vector<uint64_t> keyHashes; // EpgNameIndex::KeyHash of each stream
+    uint64_t namesHash = 0;          // EpgNameIndex::NamesHash of a miss
+    bool used = false;
+  };
+
+  std::unordered_map<std::string, Entry> m_entries;
+  bool m_dirty = false;
+};
+} // namespace xtream
@@ -0,0 +1,851 @@
+#include "epg_store.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <random>
+#include <system_error>
+#include <type_traits>
+#include <unordered_set>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+
+// FNV-1a 64-bit, resumable by passing the previous result as `h`.
+uint64_t Hash64(std::string_view s, uint64_t h = kFnvOffset)
+{
+  constexpr uint64_t kPrime = 1099511628211ULL;
+  for (unsigned char c : s)
+  {
+    h ^= static_cast<uint64_t>(c);
+    h *= kPrime;
+  }
+  return h;
+}
+
+template<typename T>
+uint64_t HashValue(const T& v, uint64_t h)
+{
+  return Hash64(std::string_view(reinterpret_cast<const char*>(&v), sizeof(v)), h);
+}
+
+// Orders records by start time and drops all but the last of each equal start time,
+// matching the previous map-keyed-by-start-time behaviour.
+void SortAndDedupe(std::vector<xtream::EpgProgrammeRecord>& records)
+{
+  std::stable_sort(records.begin(), records.end(),
+                   [](const xtream::EpgProgrammeRecord& a, const xtream::EpgProgrammeRecord& b) {
+                     return a.startTime < b.startTime;
+                   });
+  size_t out = 0;
+  for (size_t i = 0; i < records.size(); ++i)
+  {
+    if (i + 1 < records.size() && records[i + 1].startTime == records[i].startTime)
+      continue;
+    records[out++] = records[i];
+  }
+  records.resize(out);
+}
+
+// EPG cache file layout (all integers host-endian, sections 8-byte aligned):
+//   EpgCacheHeader
+//   signature bytes, zero-padded to 8
+//   source state bytes, zero-padded to 8
+//   EpgChannelRun[runCount]
+//   EpgStreamIndexEntry[indexCount]    sorted by stream id
+//   EpgProgrammeRecord[programmeCount]
+//   text arena[textBytes]
+// The reader checks magic, version, byte order and record sizes and otherwise uses
+// the sections in place, so a mapped file needs no decoding. A store with lazy text
+// records the id and size of its separate text file (LazyTextHeader + bytes).
+constexpr uint32_t kEpgCacheMagic = 0x31455458; // 'XTE1' little-endian
+constexpr uint32_t kEpgCacheVersion = 3;
+constexpr uint32_t kLazyTextMagic = 0x314c5458; // 'XTL1' little-endian
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct EpgCacheHeader
+{
+  uint32_t magic = kEpgCacheMagic;
+  uint32_t version = kEpgCacheVersion;
+  uint32_t byteOrder = kByteOrderMark;
+  uint32_t recordSize = sizeof(xtream::EpgProgrammeRecord);
+  uint32_t runSize = sizeof(xtream::EpgChannelRun);
+  uint32_t signatureBytes = 0;
+  uint32_t sourceStateBytes = 0;
+  uint32_t reserved = 0;
+  uint64_t timestamp = 0;
+  uint64_t runCount = 0;
+  uint64_t indexCount = 0;
+  uint64_t programmeCount = 0;
+  uint64_t textBytes = 0;
+  uint64_t lazyTextId = 0; // 0 = no lazy text file
+  uint64_t lazyTextBytes = 0;
+};
+
+struct LazyTextHeader
+{
+  uint32_t magic = kLazyTextMagic;
+  uint32_t reserved = 0;
+  uint64_t id = 0;
+};
+
+static_assert(std::is_trivially_copyable<xtream::EpgProgrammeRecord>::value, "record must be POD");
+static_assert(std::is_trivially_copyable<xtream::EpgChannelRun>::value, "run must be POD");
+static_assert(std::is_trivially_copyable<xtream::EpgStreamIndexEntry>::value, "index entry must be POD");
+static_assert(sizeof(EpgCacheHeader) % 8 == 0, "header must keep sections aligned");
+static_assert(sizeof(LazyTextHeader) == 16, "lazy text header must be 16 bytes");
+static_assert(sizeof(xtream::EpgProgrammeRecord) % 8 == 0, "records must keep sections aligned");
+static_assert(sizeof(xtream::EpgStreamIndexEntry) == 8, "index entry must be 8 bytes");
+
+size_t Align8(size_t n)
+{
+  return (n + 7) & ~static_cast<size_t>(7);
+}
+
+// Backing memory for a store built in this process.
+struct OwnedStorage
+{
+  std::string text;
+  std::vector<xtream::EpgProgrammeRecord> programmes;
+  std::vector<xtream::EpgChannelRun> runs;
+};
+
+// Backing memory for a store loaded from a cache file.
+class CacheFileStorage
+{
+public:
+  CacheFileStorage() = default;
+  CacheFileStorage(const CacheFileStorage&) = delete;
+  CacheFileStorage& operator=(const CacheFileStorage&) = delete;
+
+  ~CacheFileStorage()
+  {
+#if !defined(_WIN32)
+    if (m_mapped)
+      munmap(m_mapped, m_size);
+#endif
+  }
+
+  bool Open(const std::string& path)
+  {
+#if !defined(_WIN32)
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      return false;
+    struct stat st = {};
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+    {
+      void* p = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED)
+      {
+        m_mapped = p;
+        m_size = static_cast<size_t>(st.st_size);
+      }
+    }
+    close(fd);
+    if (m_mapped)
+      return true;
+#endif
+    // Windows (where a mapped file cannot be replaced by the next refresh) and mmap
+    // failures: read the file into an 8-byte aligned buffer instead.
+    std::ifstream f(path, std::ios::binary);
+    if (!f)
+      return false;
+    f.seekg(0, std::ios::end);
+    const std::streamoff sz = f.tellg();
+    if (sz <= 0)
+      return false;
+    f.seekg(0, std::ios::beg);
+    m_buffer.resize((static_cast<size_t>(sz) + 7) / 8);
+    f.read(reinterpret_cast<char*>(m_buffer.data()), sz);
+    if (!f.good())
+      return false;
+    m_size = static_cast<size_t>(sz);
+    return true;
+  }
+
+  const char* Data() const
+  {
+    return m_mapped ? static_cast<const char*>(m_mapped) : reinterpret_cast<const char*>(m_buffer.data());
+  }
+  size_t Size() const { return m_size; }
+  bool IsMapped() const { return m_mapped != nullptr; }
+
+private:
+  void* m_mapped = nullptr;
+  std::vector<uint64_t> m_buffer;
+  size_t m_size = 0;
+};
+
+// Opens a lazy text file and checks that it is the one `id` was written with.
+std::shared_ptr<CacheFileStorage> OpenLazyText(const std::string& path, uint64_t id, std::string_view& text)
+{
+  auto file = std::make_shared<CacheFileStorage>();
+  if (path.empty() || !file->Open(path) || file->Size() < sizeof(LazyTextHeader))
+    return nullptr;
+  LazyTextHeader header;
+  std::memcpy(&header, file->Data(), sizeof(header));
+  if (header.magic != kLazyTextMagic || header.id != id)
+    return nullptr;
+  text = std::string_view(file->Data() + sizeof(header), file->Size() - sizeof(header));
+  return file;
+}
+
+// Whether the lazy text file at `path` is the one `id` was written with.
+bool LazyTextIs(const std::string& path, uint64_t id)
+{
+  std::ifstream f(path, std::ios::binary);
+  LazyTextHeader header;
+  f.read(reinterpret_cast<char*>(&header), sizeof(header));
+  return f.good() && header.magic == kLazyTextMagic && header.id == id;
+}
+
+// Renames `tmp` over `path`.
+bool ReplaceFile(const std::string& tmp, const std::string& path)
+{
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  if (!ec)
+    return true;
+  // Fallback for platforms where rename over existing isn't atomic.
+  std::filesystem::remove(path, ec);
+  ec.clear();
+  std::filesystem::rename(tmp, path, ec);
+  return !ec;
+}
+} // namespace
+
+namespace xtream
+{
+EpgProgramme EpgStore::View(const EpgProgrammeRecord& r) const
+{
+  EpgProgramme p;
+  p.startTime = static_cast<time_t>(r.startTime);
+  p.endTime = static_cast<time_t>(r.endTime);
+  p.title = Text(r.title);
+  p.description = Text(r.description, (r.flags & kEpgLazyDescription) != 0);
+  p.episodeName = Text(r.episodeName);
+  p.iconPath = Text(r.iconPath, (r.flags & kEpgLazyIcon) != 0);
+  p.genreString = Text(r.genreString);
+  p.genreType = r.genreType;
+  p.genreSubType = r.genreSubType;
+  p.year = r.year;
+  p.starRating = r.starRating;
+  p.seasonNumber = r.seasonNumber;
+  p.episodeNumber = r.episodeNumber;
+  return p;
+}
+
+void EpgStore::BuildIndex(const EpgStreamIndexEntry* entries, size_t count)
+{
+  m_channelIndex.clear();
+  m_channelIndex.reserve(count);
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (entries[i].run < m_runCount)
+      m_channelIndex.emplace(entries[i].streamId, entries[i].run);
+  }
+}
+
+uint64_t EpgStore::RunHash(uint32_t run) const
+{
+  // Hash contents rather than offsets: two stores never share an arena layout.
+  const EpgChannelRun& r = m_runs[run];
+  uint64_t h = HashValue(r.count, kFnvOffset);
+  for (uint32_t i = 0; i < r.count; ++i)
+  {
+    const EpgProgrammeRecord& p = m_programmes[r.first + i];
+    h = HashValue(p.startTime, h);
+    h = HashValue(p.endTime, h);
+    const bool lazyDescription = (p.flags & kEpgLazyDescription) != 0;
+    const bool lazyIcon = (p.flags & kEpgLazyIcon) != 0;
+    const std::pair<const EpgStrRef*, bool> fields[] = {{&p.title, false},
+                                                        {&p.description, lazyDescription},
+                                                        {&p.episodeName, false},
+                                                        {&p.iconPath, lazyIcon},
+                                                        {&p.genreString, false}};
+    for (const auto& field : fields)
+    {
+      h = HashValue(field.first->length, h);
+      h = Hash64(Text(*field.first, field.second), h);
+    }
+    h = HashValue(p.seasonNumber, h);
+    h = HashValue(p.episodeNumber, h);
+    h = HashValue(p.year, h);
+    h = HashValue(p.genreType, h);
+    h = HashValue(p.genreSubType, h);
+    h = HashValue(p.starRating, h);
+  }
+  return h;
+}
+
+std::vector<int> EpgStore::ChangedStreams(const EpgStore& previous) const
+{
+  // Variant streams share runs, so hash each run at most once per store.
+  auto hashRuns = [](const EpgStore& store) {
+    std::unordered_map<uint32_t, uint64_t> hashes;
+    for (const auto& kv : store.m_channelIndex)
+    {
+      if (hashes.find(kv.second) == hashes.end())
+        hashes.emplace(kv.second, store.RunHash(kv.second));
+    }
+    return hashes;
+  };
+  const auto current = hashRuns(*this);
+  const auto before = hashRuns(previous);
+
+  std::vector<int> changed;
+  for (const auto& kv : m_channelIndex)
+  {
+    const auto prevIt = previous.m_channelIndex.find(kv.first);
+    if (prevIt == previous.m_channelIndex.end() || before.at(prevIt->second) != current.at(kv.second))
+      changed.push_back(kv.first);
+  }
+  for (const auto& kv : previous.m_channelIndex)
+  {
+    if (m_channelIndex.find(kv.first) == m_channelIndex.end())
+      changed.push_back(kv.first);
+  }
+  std::sort(changed.begin(), changed.end());
+  return changed;
+}
+
+bool EpgStore::WriteCacheFile(const std::string& path,
+                              const std::string& signature,
+                              const std::string& sourceState,
+                              uint64_t timestamp) const
+{
+  std::vector<EpgStreamIndexEntry> index;
+  index.reserve(m_channelIndex.size());
+  for (const auto& kv : m_channelIndex)
+    index.push_back({static_cast<int32_t>(kv.first), kv.second});
+  std::sort(index.begin(), index.end(), [](const EpgStreamIndexEntry& a, const EpgStreamIndexEntry& b) {
+    return a.streamId < b.streamId;
+  });
+
+  EpgCacheHeader header;
+  header.signatureBytes = static_cast<uint32_t>(signature.size());
+  header.sourceStateBytes = static_cast<uint32_t>(sourceState.size());
+  header.timestamp = timestamp;
+  header.runCount = m_runCount;
+  header.indexCount = index.size();
+  header.programmeCount = m_programmeCount;
+  header.textBytes = m_text.size();
+  header.lazyTextId = m_lazyTextId;
+  header.lazyTextBytes = m_lazyText.size();
+
+  try
+  {
+    const std::filesystem::path p(path);
+    std::filesystem::create_directories(p.parent_path());
+    const std::string tmp = path + ".tmp";
+    {
+      std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+      if (!f)
+        return false;
+      static const char kPad[8] = {};
+      f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      f.write(signature.data(), static_cast<std::streamsize>(signature.size()));
+      f.write(kPad, static_cast<std::streamsize>(Align8(signature.size()) - signature.size()));
+      f.write(sourceState.data(), static_cast<std::streamsize>(sourceState.size()));
+      f.write(kPad, static_cast<std::streamsize>(Align8(sourceState.size()) - sourceState.size()));
+      f.write(reinterpret_cast<const char*>(m_runs), static_cast<std::streamsize>(m_runCount * sizeof(EpgChannelRun)));
+      f.write(reinterpret_cast<const char*>(index.data()),
+              static_cast<std::streamsize>(index.size() * sizeof(EpgStreamIndexEntry)));
+      f.write(reinterpret_cast<const char*>(m_programmes),
+              static_cast<std::streamsize>(m_programmeCount * sizeof(EpgProgrammeRecord)));
+      f.write(m_text.data(), static_cast<std::streamsize>(m_text.size()));
+      if (!f.good())
+        return false;
+    }
+    // Text still in the builder's temporary file moves into place just before the
+    // cache that refers to it. One already moved by an earlier write is left alone.
+    if (!m_lazyTextPath.empty() && !LazyTextIs(m_lazyTextPath, m_lazyTextId))
+    {
+      const std::string textTmp = m_lazyTextPath + ".tmp";
+      if (!LazyTextIs(textTmp, m_lazyTextId) || !ReplaceFile(textTmp, m_lazyTextPath))
+      {
+        std::error_code ec;
+        std::filesystem::remove(tmp, ec);
+        return false;
+      }
+    }
+    return ReplaceFile(tmp, path);
+  }
+  catch (...)
+  {
+    return false;
+  }
+}
+
+bool EpgStore::ReadCacheFile(const std::string& path,
+                             const std::string& signature,
+                             EpgStore& out,
+                             std::string& sourceState,
+                             uint64_t& timestamp,
+                             const std::string& lazyTextPath)
+{
+  auto file = std::make_shared<CacheFileStorage>();
+  if (!file->Open(path) || file->Size() < sizeof(EpgCacheHeader))
+    return false;
+
+  const char* base = file->Data();
+  EpgCacheHeader header;
+  std::memcpy(&header, base, sizeof(header));
+  if (header.magic != kEpgCacheMagic || header.version != kEpgCacheVersion ||
+      header.byteOrder != kByteOrderMark || header.recordSize != sizeof(EpgProgrammeRecord) ||
+      header.runSize != sizeof(EpgChannelRun))
+    return false;
+
+  // Validate every section against the file size before handing out pointers.
+  const uint64_t size = file->Size();
+  uint64_t off = sizeof(EpgCacheHeader);
+  auto take = [&](uint64_t count, uint64_t elemSize, uint64_t& at) {
+    if (elemSize != 0 && count > (size - off) / elemSize)
+      return false;
+    at = off;
+    off += count * elemSize;
+    return true;
+  };
+
+  uint64_t sigAt = 0, stateAt = 0, runsAt = 0, indexAt = 0, recordsAt = 0, textAt = 0;
+  if (!take(header.signatureBytes, 1, sigAt))
+    return false;
+  if (std::string_view(base + sigAt, header.signatureBytes) != signature)
+    return false;
+  off = Align8(static_cast<size_t>(off));
+  if (off > size || !take(header.sourceStateBytes, 1, stateAt))
+    return false;
+  off = Align8(static_cast<size_t>(off));
+  if (off > size || !take(header.runCount, sizeof(EpgChannelRun), runsAt) ||
+      !take(header.indexCount, sizeof(EpgStreamIndexEntry), indexAt) ||
+      !take(header.programmeCount, sizeof(EpgProgrammeRecord), recordsAt) ||
+      !take(header.textBytes, 1, textAt) || off != size)
+    return false;
+
+  EpgStore store;
+  store.m_text = std::string_view(base + textAt, static_cast<size_t>(header.textBytes));
+  store.m_programmes = reinterpret_cast<const EpgProgrammeRecord*>(base + recordsAt);
+  store.m_programmeCount = static_cast<size_t>(header.programmeCount);
+  store.m_runs = reinterpret_cast<const EpgChannelRun*>(base + runsAt);
+  store.m_runCount = static_cast<size_t>(header.runCount);
+  for (size_t i = 0; i < store.m_runCount; ++i)
+  {
+    const EpgChannelRun& run = store.m_runs[i];
+    if (static_cast<uint64_t>(run.first) + run.count > header.programmeCount)
+      return false;
+  }
+  if (header.lazyTextId != 0)
+  {
+    auto lazy = OpenLazyText(lazyTextPath, header.lazyTextId, store.m_lazyText);
+    if (!lazy || store.m_lazyText.size() != header.lazyTextBytes)
+      return false;
+    store.m_lazyTextId = header.lazyTextId;
+    store.m_lazyStorage = std::move(lazy);
+  }
+  store.BuildIndex(reinterpret_cast<const EpgStreamIndexEntry*>(base + indexAt),
+                   static_cast<size_t>(header.indexCount));
+  store.m_storage = std::move(file);
+
+  sourceState.assign(base + stateAt, header.sourceStateBytes);
+  timestamp = header.timestamp;
+  out = std::move(store);
+  return true;
+}
+
+uint32_t EpgStoreBuilder::AddChannel()
+{
+  m_pending.emplace_back();
+  return static_cast<uint32_t>(m_pending.size() - 1);
+}
+
+void EpgStoreBuilder::MapStream(int streamId, uint32_t channel)
+{
+  if (channel < m_pending.size())
+    m_streamMap.emplace_back(streamId, channel);
+}
+
+void EpgStoreBuilder::AddProgramme(uint32_t channel, const EpgProgramme& programme)
+{
+  if (channel >= m_pending.size())
+    return;
+
+  EpgProgrammeRecord r;
+  r.startTime = static_cast<int64_t>(programme.startTime);
+  r.endTime = static_cast<int64_t>(programme.endTime);
+  r.title = Append(programme.title);
+  r.episodeName = Append(programme.episodeName);
+  r.genreString = Intern(programme.genreString);
+  if (m_lazyFile)
+  {
+    r.description = AppendLazy(programme.description);
+    r.iconPath = InternLazy(programme.iconPath);
+    r.flags = kEpgLazyDescription | kEpgLazyIcon;
+  }
+  else
+  {
+    r.description = Append(programme.description);
+    r.iconPath = Intern(programme.iconPath);
+  }
+  r.seasonNumber = programme.seasonNumber;
+  r.episodeNumber = programme.episodeNumber;
+  r.year = static_cast<int16_t>(programme.year);
+  r.genreType = static_cast<uint8_t>(programme.genreType);
+  r.genreSubType = static_cast<uint8_t>(programme.genreSubType);
+  r.starRating = static_cast<uint8_t>(programme.starRating);
+  m_pending[channel].push_back(r);
+  m_programmeCount++;
+}
+
+void EpgStoreBuilder::AddMerged(const std::vector<const EpgStore*>& sources)
+{
+  // Stream id -> its run in each source (kNoRun where a source has none).
+  constexpr uint32_t kNoRun = std::numeric_limits<uint32_t>::max();
+  std::map<int, std::vector<uint32_t>> streamRuns;
+  for (size_t s = 0; s < sources.size(); ++s)
+  {
+    for (const auto& kv : sources[s]->m_channelIndex)
+    {
+      auto& runs = streamRuns[kv.first];
+      runs.resize(sources.size(), kNoRun);
+      runs[s] = kv.second;
+    }
+  }
+
+  // Taken time ranges as disjoint [start, end) spans in start order; a programme with
+  // no length still occupies its start second.
+  std::vector<std::pair<int64_t, int64_t>> taken;
+  std::vector<std::pair<int64_t, int64_t>> added;
+  auto overlapsTaken = [&taken](int64_t start, int64_t end) {
+    auto it = std::upper_bound(taken.begin(), taken.end(), start,
+                               [](int64_t t, const std::pair<int64_t, int64_t>& span) { return t < span.second; });
+    return it != taken.end() && it->first < end;
+  };
+
+  std::map<std::vector<uint32_t>, uint32_t> merged; // runs per source -> channel
+  for (const auto& kv : streamRuns)
+  {
+    auto it = merged.find(kv.second);
+    if (it == merged.end())
+    {
+      const uint32_t channel = AddChannel();
+      taken.clear();
+      for (size_t s = 0; s < sources.size(); ++s)
+      {
+        if (kv.second[s] == kNoRun)
+          continue;
+        const EpgStore& store = *sources[s];
+        const EpgChannelRun& run = store.m_runs[kv.second[s]];
+        added.clear();
+        for (uint32_t i = 0; i < run.count; ++i)
+        {
+          const EpgProgrammeRecord& r = store.m_programmes[run.first + i];
+          const int64_t end = std::max(r.endTime, r.startTime + 1);
+          if (overlapsTaken(r.startTime, end))
+            continue;
+          AddProgramme(channel, store.View(r));
+          added.emplace_back(r.startTime, end);
+        }
+
+        // A source's own programmes may overlap each other; only later sources are
+        // held off by them.
+        taken.insert(taken.end(), added.begin(), added.end());
+        std::sort(taken.begin(), taken.end());
+        size_t out = 0;
+        for (const auto& span : taken)
+        {
+          if (out > 0 && span.first <= taken[out - 1].second)
+            taken[out - 1].second = std::max(taken[out - 1].second, span.second);
+          else
+            taken[out++] = span;
+        }
+        taken.resize(out);
+      }
+      it = merged.emplace(kv.second, channel).first;
+    }
+    MapStream(kv.first, it->second);
+  }
+}
+
+EpgStrRef EpgStoreBuilder::Append(std::string_view s)
+{
+  EpgStrRef ref;
+  if (s.empty() || m_text.size() + s.size() > std::numeric_limits<uint32_t>::max())
+    return ref;
+  ref.offset = static_cast<uint32_t>(m_text.size());
+  ref.length = static_cast<uint32_t>(s.size());
+  m_text.append(s.data(), s.size());
+  return ref;
+}
+
+EpgStrRef EpgStoreBuilder::Intern(std::string_view s)
+{
+  if (s.empty())
+    return EpgStrRef();
+
+  const uint64_t h = Hash64(s);
+  const auto it = m_interned.find(h);
+  if (it != m_interned.end())
+  {
+    const EpgStrRef& ref = it->second;
+    if (std::string_view(m_text.data() + ref.offset, ref.length) == s)
+      return ref;
+    // Hash collision: keep a private copy rather than chaining.
+    return Append(s);
+  }
+
+  const EpgStrRef ref = Append(s);
+  if (ref.length > 0)
+    m_interned.emplace(h, ref);
+  return ref;
+}
+
+bool EpgStoreBuilder::EnableLazyText(const std::string& path)
+{
+  if (path.empty() || m_programmeCount > 0)
+    return false;
+  try
+  {
+    std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+  }
+  catch (...)
+  {
+    return false;
+  }
+
+  // Unlinked rather than truncated: a published store whose cache was never written
+  // may still have the previous temporary file mapped.
+  std::error_code ec;
+  std::filesystem::remove(path + ".tmp", ec);
+  auto file = std::make_unique<std::ofstream>(path + ".tmp", std::ios::binary | std::ios::trunc);
+  if (!*file)
+    return false;
+
+  // A random id ties the text file to the cache file written from the same store.
+  std::random_device rd;
+  LazyTextHeader header;
+  do
+    header.id = (static_cast<uint64_t>(rd()) << 32) ^ rd();
+  while (header.id == 0);
+  file->write(reinterpret_cast<const char*>(&header), sizeof(header));
+  if (!file->good())
+    return false;
+
+  m_lazyFile = std::move(file);
+  m_lazyPath = path;
+  m_lazyId = header.id;
+  m_lazyBytes = 0;
+  m_lazyInterned.clear();
+  return true;
+}
+
+EpgStrRef EpgStoreBuilder::AppendLazy(std::string_view s)
+{
+  EpgStrRef ref;
+  if (s.empty() || m_lazyBytes + s.size() > std::numeric_limits<uint32_t>::max())
+    return ref;
+  ref.offset = static_cast<uint32_t>(m_lazyBytes);
+  ref.length = static_cast<uint32_t>(s.size());
+  m_lazyFile->write(s.data(), static_cast<std::streamsize>(s.size()));
+  m_lazyBytes += s.size();
+  return ref;
+}
+
+EpgStrRef EpgStoreBuilder::InternLazy(std::string_view s)
+{
+  if (s.empty())
+    return EpgStrRef();
+
+  // The text is already on disk, so the key is the hash and length alone.
+  const uint64_t key = HashValue(static_cast<uint64_t>(s.size()), Hash64(s));
+  const auto it = m_lazyInterned.find(key);
+  if (it != m_lazyInterned.end())
+    return it->second;
+  const EpgStrRef ref = AppendLazy(s);
+  if (ref.length > 0)
+    m_lazyInterned.emplace(key, ref);
+  return ref;
+}
+
+bool EpgStoreBuilder::FinishLazyText(EpgStore& store)
+{
+  std::unique_ptr<std::ofstream> file = std::move(m_lazyFile);
+  file->close();
+  if (file->fail())
+    return false;
+
+  // The text stays in the temporary file until WriteCacheFile moves it into place with
+  // the cache, so a guide that is never published doesn't replace the text the cache
+  // on disk was written with.
+  auto lazy = OpenLazyText(m_lazyPath + ".tmp", m_lazyId, store.m_lazyText);
+  if (!lazy || store.m_lazyText.size() != m_lazyBytes)
+  {
+    store.m_lazyText = std::string_view();
+    return false;
+  }
+  store.m_lazyTextId = m_lazyId;
+  store.m_lazyTextPath = m_lazyPath;
+  store.m_lazyStorage = std::move(lazy);
+  return true;
+}
+
+void EpgStoreBuilder::CompactText(std::vector<EpgProgrammeRecord>& records)
+{
+  std::string text;
+  // Interned strings are shared by reference, so equal refs keep sharing one copy.
+  std::unordered_map<uint64_t, uint32_t> moved; // (offset << 32 | length) -> new offset
+  auto remap = [&](EpgStrRef& ref) {
+    if (ref.length == 0)
+      return;
+    const uint64_t key = (static_cast<uint64_t>(ref.offset) << 32) | ref.length;
+    const auto it = moved.find(key);
+    if (it != moved.end())
+    {
+      ref.offset = it->second;
+      return;
+    }
+    const uint32_t offset = static_cast<uint32_t>(text.size());
+    text.append(m_text, ref.offset, ref.length);
+    moved.emplace(key, offset);
+    ref.offset = offset;
+  };
+  for (auto& r : records)
+  {
+    remap(r.title);
+    if (!(r.flags & kEpgLazyDescription))
+      remap(r.description);
+    remap(r.episodeName);
+    if (!(r.flags & kEpgLazyIcon))
+      remap(r.iconPath);
+    remap(r.genreString);
+  }
+  m_text = std::move(text);
+}
+
+EpgStore EpgStoreBuilder::Build()
+{
+  for (auto& records : m_pending)
+    SortAndDedupe(records);
+
+  // Group mappings by stream, keeping the order in which sources were mapped.
+  std::stable_sort(m_streamMap.begin(), m_streamMap.end(),
+                   [](const std::pair<int, uint32_t>& a, const std::pair<int, uint32_t>& b) {
+                     return a.first < b.first;
+                   });
+
+  struct StreamSources
+  {
+    int streamId = 0;
+    std::vector<uint32_t> sources;
+  };
+  std::vector<StreamSources> groups;
+  for (const auto& m : m_streamMap)
+  {
+    if (m_pending[m.second].empty())
+      continue;
+    if (groups.empty() || groups.back().streamId != m.first)
+      groups.push_back({m.first, {}});
+    auto& sources = groups.back().sources;
+    if (std::find(sources.begin(), sources.end(), m.second) == sources.end())
+      sources.push_back(m.second);
+  }
+
+  size_t totalRecords = 0;
+  std::unordered_set<uint32_t> mergedSources;
+  for (const auto& g : groups)
+  {
+    if (g.sources.size() > 1)
+      mergedSources.insert(g.sources.begin(), g.sources.end());
+  }
+  for (const auto& records : m_pending)
+    totalRecords += records.size();
+
+  auto storage = std::make_shared<OwnedStorage>();
+  storage->programmes.reserve(totalRecords);
+
+  auto emit = [&storage](const std::vector<EpgProgrammeRecord>& records) {
+    EpgChannelRun run;
+    run.first = static_cast<uint32_t>(storage->programmes.size());
+    run.count = static_cast<uint32_t>(records.size());
+    for (const auto& r : records)
+    {
+      run.maxDuration = std::max(run.maxDuration, r.endTime - r.startTime);
+      storage->programmes.push_back(r);
+    }
+    storage->runs.push_back(run);
+    return static_cast<uint32_t>(storage->runs.size() - 1);
+  };
+
+  std::unordered_map<uint32_t, uint32_t> emitted; // source channel -> run
+  std::vector<EpgStreamIndexEntry> index;
+  index.reserve(groups.size());
+  for (const auto& g : groups)
+  {
+    if (g.sources.size() == 1)
+    {
+      const uint32_t src = g.sources.front();
+      auto it = emitted.find(src);
+      if (it == emitted.end())
+      {
+        it = emitted.emplace(src, emit(m_pending[src])).first;
+        if (mergedSources.find(src) == mergedSources.end())
+          std::vector<EpgProgrammeRecord>().swap(m_pending[src]);
+      }
+      index.push_back({static_cast<int32_t>(g.streamId), it->second});
+      continue;
+    }
+
+    // Rare: one stream matched several XMLTV channels. Give it its own merged run.
+    std::vector<EpgProgrammeRecord> merged;
+    for (uint32_t src : g.sources)
+      merged.insert(merged.end(), m_pending[src].begin(), m_pending[src].end());
+    SortAndDedupe(merged);
+    index.push_back({static_cast<int32_t>(g.streamId), emit(merged)});
+  }
+
+  // Channels no stream was mapped to (e.g. a guide collected before the stream list
+  // was known) left their text behind; copy only what the emitted records reference.
+  bool dropped = false;
+  for (size_t src = 0; src < m_pending.size() && !dropped; ++src)
+    dropped = !m_pending[src].empty() && emitted.find(static_cast<uint32_t>(src)) == emitted.end() &&
+              mergedSources.find(static_cast<uint32_t>(src)) == mergedSources.end();
+  if (dropped)
+    CompactText(storage->programmes);
+
+  m_text.shrink_to_fit();
+  storage->text = std::move(m_text);
+  storage->programmes.shrink_to_fit();
+
+  EpgStore store;
+  store.m_text = storage->text;
+  store.m_programmes = storage->programmes.data();
+  store.m_programmeCount = storage->programmes.size();
+  store.m_runs = storage->runs.data();
+  store.m_runCount = storage->runs.size();
+  store.BuildIndex(index.data(), index.size());
+  store.m_storage = std::move(storage);
+  // A lazy file that can't be mapped back leaves those fields empty rather than
+  // failing the whole guide.
+  if (m_lazyFile)
+    (void)FinishLazyText(store);
+
+  m_text.clear();
+  m_pending.clear();
+  m_streamMap.clear();
+  m_interned.clear();
+  m_programmeCount = 0;
+  m_lazyInterned.clear();
+  m_lazyBytes = 0;
+  return store;
+}
+} // namespace xtream
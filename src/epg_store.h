@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace xtream
+{
+// Text reference into an EPG string arena.
+struct EpgStrRef
+{
+  uint32_t offset = 0;
+  uint32_t length = 0;
+};
+
+// EpgProgrammeRecord::flags: the field's text lives in the store's lazy text file
+// rather than in its arena.
+constexpr uint8_t kEpgLazyDescription = 0x01;
+constexpr uint8_t kEpgLazyIcon = 0x02;
+
+// Fixed-size programme record. Text lives in the store's arena (or, per `flags`, in its
+// lazy text file); genre and icon strings are interned so repeated values share one copy.
+struct EpgProgrammeRecord
+{
+  int64_t startTime = 0;
+  int64_t endTime = 0;
+  EpgStrRef title;
+  EpgStrRef description;
+  EpgStrRef episodeName; // Sub-title
+  EpgStrRef iconPath;
+  EpgStrRef genreString;
+  int32_t seasonNumber = -1;
+  int32_t episodeNumber = -1;
+  int16_t year = 0;
+  uint8_t genreType = 0;
+  uint8_t genreSubType = 0;
+  uint8_t starRating = 0;
+  uint8_t flags = 0;
+  uint8_t reserved[2] = {};
+};
+
+// One source channel's run of records in start-time order.
+struct EpgChannelRun
+{
+  uint32_t first = 0;      // index of the first record
+  uint32_t count = 0;
+  int64_t maxDuration = 0; // longest endTime - startTime in the run
+};
+
+struct EpgStreamIndexEntry
+{
+  int32_t streamId = 0;
+  uint32_t run = 0;
+};
+
+// Programme as handed to the builder and to query callbacks. The views point into
+// parser buffers (builder input) or into the store arena (query output).
+struct EpgProgramme
+{
+  time_t startTime = 0;
+  time_t endTime = 0;
+  std::string_view title;
+  std::string_view description;
+  std::string_view episodeName;
+  std::string_view iconPath;
+  std::string_view genreString;
+  int genreType = 0;
+  int genreSubType = 0;
+  int year = 0;
+  int starRating = 0;
+  int seasonNumber = -1;
+  int episodeNumber = -1;
+};
+
+// Read-only EPG index built once per XMLTV load. Each source channel's programmes sit
+// in one contiguous start-sorted run of records, and stream ids map onto those runs,
+// so variant streams (HD/SD/FHD) of one XMLTV channel share a single programme list.
+//
+// Records, runs and text are plain arrays viewed over a backing buffer: either the
+// builder's output or a memory-mapped cache file, which is served in place.
+class EpgStore
+{
+public:
+  EpgStore() = default;
+  EpgStore(EpgStore&&) = default;
+  EpgStore& operator=(EpgStore&&) = default;
+
+  size_t ChannelCount() const { return m_channelIndex.size(); }
+  size_t ProgrammeCount() const { return m_programmeCount; }
+  size_t ArenaBytes() const { return m_text.size(); }
+  size_t LazyTextBytes() const { return m_lazyText.size(); }
+
+  // Calls fn(const EpgProgramme&) for every programme of streamId overlapping
+  // [start, end], in start-time order. Returns the number of programmes visited.
+  template<typename Fn>
+  size_t ForEachInWindow(int streamId, time_t start, time_t end, Fn&& fn) const
+  {
+    const auto it = m_channelIndex.find(streamId);
+    if (it == m_channelIndex.end())
+      return 0;
+
+    const EpgChannelRun& run = m_runs[it->second];
+    const EpgProgrammeRecord* first = m_programmes + run.first;
+    const EpgProgrammeRecord* last = first + run.count;
+
+    // Nothing starting before start - maxDuration can still be running at start.
+    const int64_t firstStart = static_cast<int64_t>(start) - run.maxDuration;
+    auto p = std::lower_bound(first, last, firstStart,
+                              [](const EpgProgrammeRecord& r, int64_t t) { return r.startTime < t; });
+
+    size_t visited = 0;
+    for (; p != last && p->startTime <= static_cast<int64_t>(end); ++p)
+    {
+      if (p->endTime < static_cast<int64_t>(start))
+        continue;
+      fn(View(*p));
+      ++visited;
+    }
+    return visited;
+  }
+
+  // Stream ids whose programme list differs from `previous`: added, removed or edited.
+  std::vector<int> ChangedStreams(const EpgStore& previous) const;
+
+  // Versioned binary cache (see epg_store.cpp for the layout). `sourceState` is an
+  // opaque blob stored with the data, e.g. the HTTP validators it was parsed from.
+  // Writing goes through a temporary file and a rename so a reader never sees a
+  // partial file. A freshly built store's lazy text file is renamed into place along
+  // with it.
+  bool WriteCacheFile(const std::string& path,
+                      const std::string& signature,
+                      const std::string& sourceState,
+                      uint64_t timestamp) const;
+
+  // Maps the cache file when the platform allows it, otherwise reads it. Fails when the
+  // file is missing, truncated, from another format version or for another signature.
+  // A store built with lazy text also needs the text file it was written with at
+  // `lazyTextPath`, checked by id and size.
+  static bool ReadCacheFile(const std::string& path,
+                            const std::string& signature,
+                            EpgStore& out,
+                            std::string& sourceState,
+                            uint64_t& timestamp,
+                            const std::string& lazyTextPath = std::string());
+
+private:
+  friend class EpgStoreBuilder;
+
+  std::string_view Text(const EpgStrRef& ref, bool lazy = false) const
+  {
+    const std::string_view& text = lazy ? m_lazyText : m_text;
+    if (static_cast<size_t>(ref.offset) + ref.length > text.size())
+      return std::string_view();
+    return text.substr(ref.offset, ref.length);
+  }
+
+  EpgProgramme View(const EpgProgrammeRecord& r) const;
+  uint64_t RunHash(uint32_t run) const;
+  void BuildIndex(const EpgStreamIndexEntry* entries, size_t count);
+
+  std::shared_ptr<const void> m_storage; // owns the memory the views below point into
+  std::string_view m_text;
+  const EpgProgrammeRecord* m_programmes = nullptr;
+  size_t m_programmeCount = 0;
+  const EpgChannelRun* m_runs = nullptr;
+  size_t m_runCount = 0;
+  std::unordered_map<int, uint32_t> m_channelIndex; // stream id -> index into m_runs
+
+  std::shared_ptr<const void> m_lazyStorage; // mapped lazy text file, if any
+  std::string_view m_lazyText;
+  uint64_t m_lazyTextId = 0;
+  std::string m_lazyTextPath; // built in lazy mode: mapped from "<path>.tmp" until a cache write moves it
+};
+
+// Accumulates parser output and lays it out into an EpgStore.
+class EpgStoreBuilder
+{
+public:
+  // Opens a programme list for one source (XMLTV) channel and returns its handle.
+  uint32_t AddChannel();
+
+  // Makes streamId show the programmes of `channel`. A stream mapped from several
+  // source channels gets the union, later mappings winning on equal start times.
+  void MapStream(int streamId, uint32_t channel);
+
+  // Copies the programme text into the arena. A later programme with the same start
+  // time on the same channel replaces the earlier one.
+  void AddProgramme(uint32_t channel, const EpgProgramme& programme);
+
+  // Adds the guides of several XMLTV sources, `sources` in priority order. Each stream
+  // keeps every programme of the first source that has any for it; a later source only
+  // fills the gaps, a programme overlapping one already taken being dropped. Streams
+  // that end up with the same sources share one programme list, as within a source.
+  void AddMerged(const std::vector<const EpgStore*>& sources);
+
+  size_t ProgrammeCount() const { return m_programmeCount; }
+
+  // Lazy mode: descriptions and programme icons are written to "<path>.tmp" instead of
+  // the arena, and Build maps the file back, so that text stays on disk until a query
+  // touches it. The file takes `path` when the store's cache is written. Returns false, leaving the builder in memory mode, when
+  // the file can't be created. Call before the first AddProgramme.
+  bool EnableLazyText(const std::string& path);
+
+  // Builds the store and resets the builder.
+  EpgStore Build();
+
+private:
+  EpgStrRef Append(std::string_view s);
+  EpgStrRef Intern(std::string_view s);
+  EpgStrRef AppendLazy(std::string_view s);
+  EpgStrRef InternLazy(std::string_view s);
+  void CompactText(std::vector<EpgProgrammeRecord>& records);
+  bool FinishLazyText(EpgStore& store);
+
+  std::string m_text;
+  std::vector<std::vector<EpgProgrammeRecord>> m_pending; // per source channel
+  std::vector<std::pair<int, uint32_t>> m_streamMap;      // (stream id, source channel)
+  std::unordered_map<uint64_t, EpgStrRef> m_interned;     // text hash -> first copy
+  size_t m_programmeCount = 0;
+
+  std::unique_ptr<std::ofstream> m_lazyFile; // open while parsing in lazy mode
+  std::string m_lazyPath;
+  uint64_t m_lazyId = 0;
+  uint64_t m_lazyBytes = 0;
+  std::unordered_map<uint64_t, EpgStrRef> m_lazyInterned; // (hash, length) -> first copy
+};
+} // namespace xtream
@@ -0,0 +1,255 @@
+#include "gzip_stream.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(XTREAM_HAVE_ZLIB)
+#include <zlib.h>
+#endif
+
+namespace
+{
+constexpr size_t kInputChunkBytes = 64 * 1024;
+} // namespace
+
+namespace xtream
+{
+struct AutoInflateReader::Inflater
+{
+#if defined(XTREAM_HAVE_ZLIB)
+  z_stream zs{};
+  bool initialized = false;
+  bool memberDone = false;
+  bool finished = false; // a member ended and no gzip member follows it
+
+  ~Inflater()
+  {
+    if (initialized)
+      inflateEnd(&zs);
+  }
+#endif
+};
+
+bool LooksGzip(const char* data, size_t size)
+{
+  return size >= 2 && static_cast<unsigned char>(data[0]) == 0x1f &&
+         static_cast<unsigned char>(data[1]) == 0x8b;
+}
+
+bool GzipSupported()
+{
+#if defined(XTREAM_HAVE_ZLIB)
+  return true;
+#else
+  return false;
+#endif
+}
+
+AutoInflateReader::AutoInflateReader(ByteReadFn source) : m_source(std::move(source))
+{
+}
+
+AutoInflateReader::~AutoInflateReader() = default;
+
+bool AutoInflateReader::FillInput()
+{
+  if (m_inPos < m_in.size())
+    return true;
+  if (m_sourceDone)
+    return false;
+
+  m_in.resize(kInputChunkBytes);
+  m_inPos = 0;
+  const int64_t n = m_source(&m_in[0], m_in.size());
+  if (n < 0)
+  {
+    m_in.clear();
+    m_mode = Mode::Failed;
+    return false;
+  }
+  if (n == 0)
+  {
+    m_in.clear();
+    m_sourceDone = true;
+    return false;
+  }
+  m_in.resize(static_cast<size_t>(n));
+  m_rawBytes += static_cast<uint64_t>(n);
+  return true;
+}
+
+bool AutoInflateReader::EnsureInput(size_t count)
+{
+  if (m_inPos > 0)
+  {
+    m_in.erase(0, m_inPos);
+    m_inPos = 0;
+  }
+  char chunk[kInputChunkBytes];
+  while (m_in.size() < count && !m_sourceDone)
+  {
+    const int64_t n = m_source(chunk, sizeof(chunk));
+    if (n < 0)
+    {
+      m_mode = Mode::Failed;
+      return false;
+    }
+    if (n == 0)
+      m_sourceDone = true;
+    m_in.append(chunk, static_cast<size_t>(n));
+    m_rawBytes += static_cast<uint64_t>(n);
+  }
+  return m_in.size() >= count;
+}
+
+int64_t AutoInflateReader::Read(char* buf, size_t size)
+{
+  if (m_mode == Mode::Failed)
+    return -1;
+  if (size == 0)
+    return 0;
+
+  if (m_mode == Mode::Detect)
+  {
+    // Two bytes decide it; a source may hand them over one at a time.
+    char head[kInputChunkBytes];
+    std::string prefix;
+    while (prefix.size() < 2 && !m_sourceDone)
+    {
+      const int64_t n = m_source(head, sizeof(head));
+      if (n < 0)
+      {
+        m_mode = Mode::Failed;
+        return -1;
+      }
+      if (n == 0)
+        m_sourceDone = true;
+      prefix.append(head, static_cast<size_t>(n));
+      m_rawBytes += static_cast<uint64_t>(n);
+    }
+    m_in = std::move(prefix);
+    m_inPos = 0;
+
+    if (!LooksGzip(m_in.data(), m_in.size()))
+    {
+      m_mode = Mode::Passthrough;
+    }
+    else
+    {
+#if defined(XTREAM_HAVE_ZLIB)
+      m_inflater = std::make_unique<Inflater>();
+      // 16 + MAX_WBITS: expect a gzip header and trailer.
+      if (inflateInit2(&m_inflater->zs, 16 + MAX_WBITS) != Z_OK)
+      {
+        m_mode = Mode::Failed;
+        return -1;
+      }
+      m_inflater->initialized = true;
+      m_mode = Mode::Inflate;
+#else
+      m_unsupported = true;
+      m_mode = Mode::Failed;
+      return -1;
+#endif
+    }
+  }
+
+  if (m_mode == Mode::Passthrough)
+  {
+    if (m_inPos < m_in.size())
+    {
+      const size_t n = std::min(size, m_in.size() - m_inPos);
+      std::memcpy(buf, m_in.data() + m_inPos, n);
+      m_inPos += n;
+      return static_cast<int64_t>(n);
+    }
+    if (m_sourceDone)
+      return 0;
+    const int64_t n = m_source(buf, size);
+    if (n > 0)
+      m_rawBytes += static_cast<uint64_t>(n);
+    return n;
+  }
+
+#if defined(XTREAM_HAVE_ZLIB)
+  z_stream& zs = m_inflater->zs;
+  while (true)
+  {
+    if (m_inflater->finished)
+      return 0;
+    if (!FillInput())
+    {
+      if (m_mode == Mode::Failed)
+        return -1;
+      // Clean end only after a complete member; otherwise the body was truncated.
+      if (m_inflater->memberDone)
+        return 0;
+      m_mode = Mode::Failed;
+      return -1;
+    }
+
+    if (m_inflater->memberDone)
+    {
+      // Concatenated gzip members are legal; keep going with the next one. Anything
+      // else after a member (zero padding, junk some servers append) ends the stream
+      // cleanly, as gzip -d does, rather than failing the whole body.
+      if (!EnsureInput(2) || !LooksGzip(m_in.data(), m_in.size()))
+      {
+        if (m_mode == Mode::Failed)
+          return -1;
+        m_inflater->finished = true;
+        return 0;
+      }
+      inflateReset(&zs);
+      m_inflater->memberDone = false;
+    }
+
+    zs.next_in = reinterpret_cast<Bytef*>(&m_in[m_inPos]);
+    zs.avail_in = static_cast<uInt>(m_in.size() - m_inPos);
+    zs.next_out = reinterpret_cast<Bytef*>(buf);
+    zs.avail_out = static_cast<uInt>(std::min<size_t>(size, 0x7fffffff));
+
+    const int ret = inflate(&zs, Z_NO_FLUSH);
+    m_inPos = m_in.size() - zs.avail_in;
+    const size_t produced = std::min<size_t>(size, 0x7fffffff) - zs.avail_out;
+
+    if (ret == Z_STREAM_END)
+      m_inflater->memberDone = true;
+    else if (ret != Z_OK && ret != Z_BUF_ERROR)
+    {
+      m_mode = Mode::Failed;
+      return -1;
+    }
+
+    if (produced > 0)
+      return static_cast<int64_t>(produced);
+  }
+#else
+  return -1;
+#endif
+}
+
+bool GunzipString(const std::string& in, std::string& out)
+{
+  out.clear();
+  size_t pos = 0;
+  AutoInflateReader reader([&](char* buf, size_t size) -> int64_t {
+    const size_t n = std::min(size, in.size() - pos);
+    std::memcpy(buf, in.data() + pos, n);
+    pos += n;
+    return static_cast<int64_t>(n);
+  });
+
+  char buf[kInputChunkBytes];
+  while (true)
+  {
+    const int64_t n = reader.Read(buf, sizeof(buf));
+    if (n < 0)
+      return false;
+    if (n == 0)
+      break;
+    out.append(buf, static_cast<size_t>(n));
+  }
+  return reader.IsCompressed();
+}
+} // namespace xtream
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace xtream
+{
+// Byte source in the XmltvReadFn convention: fill up to `size` bytes, return the count,
+// 0 at end of stream or a negative value on error.
+using ByteReadFn = std::function<int64_t(char* buf, size_t size)>;
+
+// True when `data` starts with the gzip magic bytes.
+bool LooksGzip(const char* data, size_t size);
+
+// False when the addon was built without zlib; gzip bodies are then rejected.
+bool GzipSupported();
+
+// Wraps a raw byte source and inflates it on the fly when it turns out to be gzip
+// (e.g. a provider serving xmltv.xml.gz as a plain file). Other content is passed
+// through unchanged. HTTP Content-Encoding is already undone by Kodi's curl layer, so
+// this only sees bodies that are gzip files in their own right.
+class AutoInflateReader
+{
+public:
+  explicit AutoInflateReader(ByteReadFn source);
+  ~AutoInflateReader();
+
+  AutoInflateReader(const AutoInflateReader&) = delete;
+  AutoInflateReader& operator=(const AutoInflateReader&) = delete;
+
+  int64_t Read(char* buf, size_t size);
+
+  bool IsCompressed() const { return m_mode == Mode::Inflate; }
+  bool UnsupportedGzip() const { return m_unsupported; }
+  uint64_t RawBytes() const { return m_rawBytes; }
+
+private:
+  enum class Mode
+  {
+    Detect,
+    Passthrough,
+    Inflate,
+    Failed
+  };
+
+  bool FillInput();
+  // Tops the unread input up to `count` bytes; false when the source ends first.
+  bool EnsureInput(size_t count);
+
+  struct Inflater;
+
+  ByteReadFn m_source;
+  std::unique_ptr<Inflater> m_inflater;
+  std::string m_in;
+  size_t m_inPos = 0;
+  bool m_sourceDone = false;
+  Mode m_mode = Mode::Detect;
+  bool m_unsupported = false;
+  uint64_t m_rawBytes = 0;
+};
+
+// Inflates a complete gzip buffer. Returns false on corrupt input or without zlib.
+bool GunzipString(const std::string& in, std::string& out);
+} // namespace xtream
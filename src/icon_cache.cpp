@@ -0,0 +1,233 @@
+#include "icon_cache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
+
+namespace
+{
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+constexpr uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t HashUrl(std::string_view url)
+{
+  uint64_t h = kFnvOffset;
+  for (unsigned char c : url)
+  {
+    h ^= c;
+    h *= kFnvPrime;
+  }
+  return h;
+}
+
+// Keeps a known image extension from the URL path, so the texture loader doesn't have
+// to sniff; anything else is stored without one.
+std::string_view ImageExtension(std::string_view url)
+{
+  const size_t end = url.find_first_of("?#|");
+  std::string_view path = url.substr(0, end);
+  const size_t dot = path.rfind('.');
+  const size_t slash = path.rfind('/');
+  if (dot == std::string_view::npos || (slash != std::string_view::npos && dot < slash))
+    return {};
+  const std::string_view ext = path.substr(dot);
+  static constexpr std::string_view kKnown[] = {".png", ".jpg", ".jpeg", ".gif", ".webp", ".bmp"};
+  for (std::string_view known : kKnown)
+  {
+    if (ext.size() != known.size())
+      continue;
+    bool same = true;
+    for (size_t i = 0; i < ext.size() && same; ++i)
+      same = std::tolower(static_cast<unsigned char>(ext[i])) == static_cast<unsigned char>(known[i]);
+    if (same)
+      return known;
+  }
+  return {};
+}
+
+bool ParseHashName(const std::string& name, uint64_t& hash)
+{
+  if (name.size() < 16)
+    return false;
+  for (size_t i = 0; i < 16; ++i)
+  {
+    if (!std::isxdigit(static_cast<unsigned char>(name[i])))
+      return false;
+  }
+  if (name.size() > 16 && name[16] != '.')
+    return false;
+  hash = std::strtoull(name.substr(0, 16).c_str(), nullptr, 16);
+  return true;
+}
+
+bool WriteFileAtomic(const std::filesystem::path& path, const std::string& data)
+{
+  const std::filesystem::path tmp = path.string() + ".tmp";
+  {
+    std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+    if (!f)
+      return false;
+    f.write(data.data(), static_cast<std::streamsize>(data.size()));
+    if (!f.good())
+      return false;
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  if (ec)
+    std::filesystem::remove(tmp, ec);
+  return !ec;
+}
+} // namespace
+
+namespace xtream
+{
+std::string IconCache::FileName(std::string_view url) const
+{
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(HashUrl(url)));
+  return std::string(hex) + std::string(ImageExtension(url));
+}
+
+void IconCache::LoadLocked()
+{
+  if (m_loaded)
+    return;
+  m_loaded = true;
+  std::error_code ec;
+  for (std::filesystem::directory_iterator it(m_dir, ec), end; !ec && it != end; it.increment(ec))
+  {
+    const std::string name = it->path().filename().string();
+    uint64_t hash = 0;
+    if (!it->is_regular_file(ec) || !ParseHashName(name, hash) ||
+        name.compare(name.size() - 4, 4, ".tmp") == 0)
+      continue;
+    const auto written = it->last_write_time(ec);
+    m_files.emplace(hash, CachedFile{name, ec ? std::filesystem::file_time_type() : written});
+  }
+}
+
+std::string IconCache::Lookup(std::string_view url)
+{
+  if (url.empty() || m_dir.empty())
+    return {};
+  std::lock_guard<std::mutex> lock(m_mutex);
+  LoadLocked();
+  const auto it = m_files.find(HashUrl(url));
+  if (it == m_files.end())
+    return {};
+  return (std::filesystem::path(m_dir) / it->second.name).string();
+}
+
+size_t IconCache::Prefetch(const std::vector<std::string_view>& urls,
+                           unsigned parallel,
+                           const FetchFn& fetch,
+                           const std::function<bool()>& cancelled)
+{
+  if (m_dir.empty())
+    return 0;
+
+  std::vector<std::string> todo;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    LoadLocked();
+    const auto now = std::chrono::steady_clock::now();
+    const auto oldest = std::filesystem::file_time_type::clock::now() - kMaxAge;
+    std::unordered_set<uint64_t> queued;
+    queued.reserve(urls.size());
+    for (std::string_view url : urls)
+    {
+      if (url.empty())
+        continue;
+      const uint64_t h = HashUrl(url);
+      const auto cached = m_files.find(h);
+      if (cached != m_files.end() && cached->second.written > oldest)
+        continue;
+      const auto failed = m_failed.find(h);
+      if (failed != m_failed.end() && now < failed->second)
+        continue;
+      if (queued.insert(h).second)
+        todo.emplace_back(url);
+    }
+  }
+  if (todo.empty())
+    return 0;
+
+  std::error_code ec;
+  std::filesystem::create_directories(m_dir, ec);
+
+  std::atomic<size_t> next{0};
+  std::atomic<size_t> added{0};
+  auto work = [&]() {
+    std::string body;
+    while (!(cancelled && cancelled()))
+    {
+      const size_t i = next.fetch_add(1);
+      if (i >= todo.size())
+        return;
+      const std::string& url = todo[i];
+      const uint64_t h = HashUrl(url);
+      const std::string name = FileName(url);
+      body.clear();
+      const bool ok = fetch(url, body) && !body.empty() &&
+                      WriteFileAtomic(std::filesystem::path(m_dir) / name, body);
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (ok)
+      {
+        auto& file = m_files[h];
+        if (file.name.empty())
+          added.fetch_add(1);
+        file = CachedFile{name, std::filesystem::file_time_type::clock::now()};
+        m_failed.erase(h);
+      }
+      else
+      {
+        m_failed[h] = std::chrono::steady_clock::now() + kRetryAfter;
+      }
+    }
+  };
+
+  const size_t workers = std::min(todo.size(), static_cast<size_t>(std::max(1u, parallel)));
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (size_t t = 1; t < workers; ++t)
+    threads.emplace_back(work);
+  work();
+  for (auto& t : threads)
+    t.join();
+  return added.load();
+}
+
+size_t IconCache::Prune(const std::vector<std::string_view>& urls)
+{
+  if (m_dir.empty())
+    return 0;
+  std::unordered_set<uint64_t> keep;
+  keep.reserve(urls.size());
+  for (std::string_view url : urls)
+    keep.insert(HashUrl(url));
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  LoadLocked();
+  size_t removed = 0;
+  for (auto it = m_files.begin(); it != m_files.end();)
+  {
+    if (keep.count(it->first))
+    {
+      ++it;
+      continue;
+    }
+    std::error_code ec;
+    std::filesystem::remove(std::filesystem::path(m_dir) / it->second.name, ec);
+    it = m_files.erase(it);
+    ++removed;
+  }
+  return removed;
+}
+} // namespace xtream
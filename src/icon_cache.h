@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace xtream
+{
+// Channel logos downloaded once into a local directory, one file per distinct URL, so
+// Kodi's texture loader reads local files instead of opening thousands of remote
+// connections for a large channel list. Files are named by a hash of the URL; the
+// directory is scanned on first use and afterwards tracked in memory. A copy older than
+// kMaxAge is downloaded again so a changed logo is picked up, and a URL that failed is
+// retried after kRetryAfter. Thread-safe.
+class IconCache
+{
+public:
+  // Fetches `url` into `body`; returns false on any failure.
+  using FetchFn = std::function<bool(const std::string& url, std::string& body)>;
+
+  static constexpr std::chrono::hours kMaxAge{7 * 24};
+  static constexpr std::chrono::minutes kRetryAfter{30};
+
+  explicit IconCache(std::string dir) : m_dir(std::move(dir)) {}
+
+  // The local file holding `url`, or empty when it hasn't been downloaded.
+  std::string Lookup(std::string_view url);
+
+  // Downloads the icons among `urls` that aren't cached yet or whose copy is older than
+  // kMaxAge, each distinct URL once and at most `parallel` at a time. A URL that failed
+  // within kRetryAfter is skipped; an old copy that fails to refresh is kept. Stops
+  // handing out work once `cancelled` returns true. Returns the number of files added,
+  // not counting refreshed ones.
+  size_t Prefetch(const std::vector<std::string_view>& urls,
+                  unsigned parallel,
+                  const FetchFn& fetch,
+                  const std::function<bool()>& cancelled);
+
+  // Deletes cached files whose URL is not among `urls`. Returns the number removed.
+  size_t Prune(const std::vector<std::string_view>& urls);
+
+private:
+  void LoadLocked();
+  std::string FileName(std::string_view url) const;
+
+  struct CachedFile
+  {
+    std::string name; // in m_dir
+    std::filesystem::file_time_type written;
+  };
+
+  std::string m_dir;
+  std::mutex m_mutex;
+  bool m_loaded = false;
+  std::unordered_map<uint64_t, CachedFile> m_files;                            // by URL hash
+  std::unordered_map<uint64_t, std::chrono::steady_clock::time_point> m_failed; // URL hash -> retry after
+};
+} // namespace xtream
@@ -0,0 +1,254 @@
+#include "memory_budget.h"
+
+#include "epg_store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/sysctl.h>
+#include <sys/types.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+// Per stream: its stream table record, the Kodi channel built from it and its entries
+// in the uid, group and icon maps; a generous average.
+constexpr uint64_t kStreamBytes = 640;
+// XMLTV markup around a programme's text (tags, attributes, entities, whitespace).
+constexpr uint64_t kMarkupPerProgramme = 320;
+// Share of EPG text left in memory in lazy mode when no lazy guide has been measured:
+// titles, sub-titles and genres, without descriptions and icons.
+constexpr double kLazyArenaShare = 0.35;
+// Windows reads the lazy text file back into memory (see CacheFileStorage in
+// epg_store.cpp), so there lazy mode keeps all the text resident.
+#if defined(_WIN32)
+constexpr bool kLazyTextOnDisk = false;
+#else
+constexpr bool kLazyTextOnDisk = true;
+#endif
+// Guide the streaming parser collects, unmapped channels included, relative to the
+// mapped store.
+constexpr double kUnmappedShare = 1.25;
+// Days counted for an open side of the horizon.
+constexpr int kOpenHorizonDays = 14;
+
+uint64_t Scale(uint64_t v, double factor)
+{
+  return static_cast<uint64_t>(static_cast<double>(v) * factor);
+}
+
+int HorizonDays(int past, int future)
+{
+  return (past > 0 ? past : kOpenHorizonDays) + (future > 0 ? future : kOpenHorizonDays);
+}
+
+// Keeps at most `limit` days of a side; 0 (everything) counts as more than any limit.
+int Narrow(int days, int limit)
+{
+  return days == 0 || days > limit ? limit : days;
+}
+
+#if defined(__linux__) || defined(__ANDROID__)
+// A "Vm...:   1234 kB" line of /proc/self/status, in bytes.
+uint64_t ProcStatusBytes(const char* key)
+{
+  FILE* f = std::fopen("/proc/self/status", "r");
+  if (!f)
+    return 0;
+  char line[256];
+  uint64_t bytes = 0;
+  const size_t keyLen = std::strlen(key);
+  while (std::fgets(line, sizeof(line), f))
+  {
+    if (std::strncmp(line, key, keyLen) != 0)
+      continue;
+    unsigned long long kb = 0;
+    if (std::sscanf(line + keyLen, " %llu", &kb) == 1)
+      bytes = static_cast<uint64_t>(kb) * 1024;
+    break;
+  }
+  std::fclose(f);
+  return bytes;
+}
+#endif
+} // namespace
+
+namespace xtream
+{
+uint64_t PhysicalMemoryBytes()
+{
+#if defined(_WIN32)
+  MEMORYSTATUSEX status;
+  status.dwLength = sizeof(status);
+  return GlobalMemoryStatusEx(&status) ? static_cast<uint64_t>(status.ullTotalPhys) : 0;
+#elif defined(__APPLE__)
+  uint64_t bytes = 0;
+  size_t size = sizeof(bytes);
+  return sysctlbyname("hw.memsize", &bytes, &size, nullptr, 0) == 0 ? bytes : 0;
+#else
+  const long pages = sysconf(_SC_PHYS_PAGES);
+  const long pageSize = sysconf(_SC_PAGESIZE);
+  return pages > 0 && pageSize > 0 ? static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize) : 0;
+#endif
+}
+
+uint64_t ResidentBytes()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  return K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))
+             ? static_cast<uint64_t>(counters.WorkingSetSize)
+             : 0;
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  return task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) ==
+                 KERN_SUCCESS
+             ? static_cast<uint64_t>(info.resident_size)
+             : 0;
+#elif defined(__linux__) || defined(__ANDROID__)
+  return ProcStatusBytes("VmRSS:");
+#else
+  return 0;
+#endif
+}
+
+uint64_t PeakResidentBytes()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  return K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))
+             ? static_cast<uint64_t>(counters.PeakWorkingSetSize)
+             : 0;
+#elif defined(__APPLE__)
+  mach_task_basic_info_data_t info;
+  mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+  return task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) ==
+                 KERN_SUCCESS
+             ? static_cast<uint64_t>(info.resident_size_max)
+             : 0;
+#elif defined(__linux__) || defined(__ANDROID__)
+  return ProcStatusBytes("VmHWM:");
+#else
+  return 0;
+#endif
+}
+
+uint64_t MemoryBudgetBytes(int configuredMb)
+{
+  constexpr uint64_t kMb = 1024 * 1024;
+  if (configuredMb > 0)
+    return static_cast<uint64_t>(configuredMb) * kMb;
+  const uint64_t physical = PhysicalMemoryBytes();
+  if (physical == 0)
+    return static_cast<uint64_t>(kMaxAutoBudgetMb) * kMb;
+  return std::max(static_cast<uint64_t>(kMinAutoBudgetMb) * kMb,
+                  std::min(physical / 8, static_cast<uint64_t>(kMaxAutoBudgetMb) * kMb));
+}
+
+MemoryFootprint AssumedFootprint()
+{
+  MemoryFootprint f;
+  f.streams = 20000;
+  f.streamTextBytes = 4 * 1024 * 1024;
+  f.programmes = 600000;
+  f.epgArenaBytes = 120 * 1024 * 1024;
+  f.epgDaysPast = 7;
+  f.epgDaysFuture = 7;
+  return f;
+}
+
+uint64_t EstimateHeldBytes(const MemoryFootprint& held)
+{
+  return held.streams * kStreamBytes + held.streamTextBytes +
+         held.programmes * sizeof(EpgProgrammeRecord) + held.epgArenaBytes +
+         (kLazyTextOnDisk ? 0 : held.epgLazyBytes);
+}
+
+uint64_t EstimateRefreshGrowth(const MemoryFootprint& last, const MemoryModes& modes, bool withStreams)
+{
+  // The new guide has as many days as the modes keep, in the proportions of the last one.
+  const bool known = last.epgDaysPast >= 0 && last.epgDaysFuture >= 0;
+  const double days = known ? static_cast<double>(HorizonDays(modes.daysPast, modes.daysFuture)) /
+                                  HorizonDays(last.epgDaysPast, last.epgDaysFuture)
+                            : 1.0;
+  const uint64_t programmes = Scale(last.programmes, days);
+  const uint64_t records = programmes * sizeof(EpgProgrammeRecord);
+  const uint64_t text = Scale(last.epgArenaBytes + last.epgLazyBytes, days);
+  uint64_t residentText = text;
+  if (modes.lazyText && kLazyTextOnDisk)
+  {
+    const uint64_t measured = last.epgArenaBytes + last.epgLazyBytes;
+    const double share = last.epgLazyBytes > 0 ? static_cast<double>(last.epgArenaBytes) / measured
+                                               : kLazyArenaShare;
+    residentText = Scale(text, share);
+  }
+  const uint64_t store = records + residentText;
+
+  // Streaming: the collected guide, then the store's records built from it. DOM: the
+  // body, its working copy and the node tree, with the store built alongside.
+  uint64_t growth = modes.streamingParse ? Scale(store, kUnmappedShare) + records
+                                         : 3 * (text + programmes * kMarkupPerProgramme) + store;
+  if (withStreams)
+    growth += last.streams * kStreamBytes + last.streamTextBytes;
+  return growth;
+}
+
+MemoryPlan PlanMemory(uint64_t budgetBytes,
+                      uint64_t heldBytes,
+                      const MemoryFootprint& last,
+                      const MemoryModes& wanted,
+                      bool withStreams)
+{
+  MemoryPlan plan;
+  plan.modes = wanted;
+  plan.budgetBytes = budgetBytes;
+  plan.heldBytes = heldBytes;
+
+  auto fits = [&]() {
+    plan.growthBytes = EstimateRefreshGrowth(last, plan.modes, withStreams);
+    return plan.heldBytes + plan.growthBytes <= budgetBytes;
+  };
+
+  // Cheapest economies first: the streaming parser costs nothing but the DOM parser's
+  // threads, lazy text costs a disk read per shown programme, a shorter horizon costs
+  // guide days.
+  plan.fits = fits();
+  if (!plan.fits && !plan.modes.streamingParse)
+  {
+    plan.modes.streamingParse = true;
+    ++plan.economies;
+    plan.fits = fits();
+  }
+  if (!plan.fits && !plan.modes.lazyText && kLazyTextOnDisk)
+  {
+    plan.modes.lazyText = true;
+    ++plan.economies;
+    plan.fits = fits();
+  }
+  if (!plan.fits)
+  {
+    const int past = Narrow(plan.modes.daysPast, kLowMemoryDaysPast);
+    const int future = Narrow(plan.modes.daysFuture, kLowMemoryDaysFuture);
+    if (past != plan.modes.daysPast || future != plan.modes.daysFuture)
+    {
+      plan.modes.daysPast = past;
+      plan.modes.daysFuture = future;
+      ++plan.economies;
+      plan.fits = fits();
+    }
+  }
+  return plan;
+}
+} // namespace xtream
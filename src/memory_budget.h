@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+namespace xtream
+{
+// Physical memory of the device, or 0 when the platform doesn't say.
+uint64_t PhysicalMemoryBytes();
+
+// The process's resident set now and its high-water mark, or 0 when unknown. The
+// process is Kodi's, so these include everything Kodi holds besides the addon.
+uint64_t ResidentBytes();
+uint64_t PeakResidentBytes();
+
+// Automatic budgets are an eighth of physical memory within these bounds.
+constexpr int kMinAutoBudgetMb = 64;
+constexpr int kMaxAutoBudgetMb = 1024;
+
+// `configuredMb` when positive, otherwise the automatic budget (kMaxAutoBudgetMb when the
+// device size is unknown). In bytes.
+uint64_t MemoryBudgetBytes(int configuredMb);
+
+// Sizes of the lists a refresh replaces: as currently held, or AssumedFootprint where
+// nothing is.
+struct MemoryFootprint
+{
+  uint64_t streams = 0;
+  uint64_t streamTextBytes = 0;
+  uint64_t programmes = 0;
+  uint64_t epgArenaBytes = 0; // EPG text in memory
+  uint64_t epgLazyBytes = 0;  // EPG text kept on disk (lazy mode; in memory on Windows)
+  int epgDaysPast = -1;       // horizon the guide was kept with, as in MemoryModes;
+  int epgDaysFuture = -1;     // -1 = unknown
+};
+
+// Stand-in when nothing is held yet (a first load without caches): a large provider,
+// so a small device starts out frugal rather than finding out the hard way.
+MemoryFootprint AssumedFootprint();
+
+// How a refresh builds the guide. Days of 0 keep everything, as in Settings.
+struct MemoryModes
+{
+  bool streamingParse = true;
+  bool lazyText = false;
+  int daysPast = 7;
+  int daysFuture = 7;
+};
+
+// Horizon of the last economy step.
+constexpr int kLowMemoryDaysPast = 1;
+constexpr int kLowMemoryDaysFuture = 3;
+
+struct MemoryPlan
+{
+  MemoryModes modes;
+  uint64_t budgetBytes = 0;
+  uint64_t heldBytes = 0;   // estimate of what the held lists occupy
+  uint64_t growthBytes = 0; // estimated peak on top of that while the refresh runs
+  int economies = 0;        // steps taken away from the wanted modes
+  bool fits = true;         // heldBytes + growthBytes within budgetBytes
+};
+
+// Rough models of the addon's own allocations, from the per-record sizes of the stream
+// table, channel list and EPG store and the working set of each XMLTV parser. The
+// growth of a refresh is sized from the lists it replaces, scaled to the horizon
+// `modes` keep. `withStreams` is false for a guide-only refresh, which keeps the
+// stream list.
+uint64_t EstimateHeldBytes(const MemoryFootprint& held);
+uint64_t EstimateRefreshGrowth(const MemoryFootprint& last, const MemoryModes& modes, bool withStreams);
+
+// Starts from `wanted` and, while `heldBytes` + growth exceeds `budgetBytes`, switches to
+// the streaming parser, then to lazy text (except on Windows, where it saves nothing),
+// then to the kLowMemoryDays horizon (never widening what `wanted` keeps). The plan reports whether the final modes fit.
+MemoryPlan PlanMemory(uint64_t budgetBytes,
+                      uint64_t heldBytes,
+                      const MemoryFootprint& last,
+                      const MemoryModes& wanted,
+                      bool withStreams);
+} // namespace xtream
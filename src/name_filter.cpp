@@ -0,0 +1,150 @@
+#include "name_filter.h"
+
+#include <cctype>
+#include <queue>
+
+namespace xtream
+{
+NameFilter::NameFilter(const std::vector<std::string>& patternsLower)
+{
+  // Same folding as the std::tolower the patterns were lower-cased with.
+  for (int c = 0; c < 256; ++c)
+    m_lower[c] = static_cast<unsigned char>(std::tolower(c));
+
+  std::vector<const std::string*> plain;
+  for (const auto& pattern : patternsLower)
+  {
+    if (pattern.empty())
+      continue;
+    if (pattern.find('*') != std::string::npos)
+      m_wildcards.push_back(pattern);
+    else
+      plain.push_back(&pattern);
+  }
+  if (plain.empty())
+    return;
+
+  size_t classes = 1;
+  for (const std::string* pattern : plain)
+  {
+    for (unsigned char c : *pattern)
+    {
+      if (m_class[c] == 0)
+        m_class[c] = static_cast<uint16_t>(classes++);
+    }
+  }
+  m_classes = classes;
+
+  // Trie first, with 0 as "no edge yet" (state 0 is the root, never a child).
+  constexpr uint32_t kNone = 0;
+  m_next.assign(m_classes, kNone);
+  m_accept.assign(1, 0);
+  m_states = 1;
+  for (const std::string* pattern : plain)
+  {
+    uint32_t state = 0;
+    for (unsigned char c : *pattern)
+    {
+      const uint16_t cls = m_class[c];
+      uint32_t& edge = m_next[state * m_classes + cls];
+      if (edge == kNone)
+      {
+        edge = static_cast<uint32_t>(m_states++);
+        m_next.resize(m_states * m_classes, kNone);
+        m_accept.push_back(0);
+      }
+      state = m_next[state * m_classes + cls];
+    }
+    m_accept[state] = 1;
+  }
+
+  // Breadth-first failure links, folded into the table so matching is one lookup per
+  // byte with no fallback loop.
+  std::vector<uint32_t> fail(m_states, 0);
+  std::queue<uint32_t> queue;
+  for (size_t cls = 0; cls < m_classes; ++cls)
+  {
+    const uint32_t child = m_next[cls];
+    if (child != kNone)
+      queue.push(child);
+  }
+  while (!queue.empty())
+  {
+    const uint32_t state = queue.front();
+    queue.pop();
+    m_accept[state] |= m_accept[fail[state]];
+    for (size_t cls = 0; cls < m_classes; ++cls)
+    {
+      uint32_t& edge = m_next[state * m_classes + cls];
+      const uint32_t viaFail = m_next[fail[state] * m_classes + cls];
+      if (edge == kNone)
+      {
+        edge = viaFail;
+        continue;
+      }
+      fail[edge] = viaFail;
+      queue.push(edge);
+    }
+  }
+}
+
+bool NameFilter::Matches(std::string_view name) const
+{
+  if (m_states > 0 && MatchesSubstring(name))
+    return true;
+  for (const auto& pattern : m_wildcards)
+  {
+    if (MatchesWildcard(pattern, name))
+      return true;
+  }
+  return false;
+}
+
+bool NameFilter::MatchesSubstring(std::string_view name) const
+{
+  uint32_t state = 0;
+  for (unsigned char c : name)
+  {
+    state = m_next[state * m_classes + m_class[m_lower[c]]];
+    if (m_accept[state])
+      return true;
+  }
+  return false;
+}
+
+// '*' matches any sequence; everything else one byte. Backtracks to the last star only,
+// which is enough for a whole-string match.
+bool NameFilter::MatchesWildcard(const std::string& patternLower, std::string_view name) const
+{
+  size_t p = 0;
+  size_t t = 0;
+  size_t star = std::string::npos;
+  size_t match = 0;
+  while (t < name.size())
+  {
+    const char c = static_cast<char>(m_lower[static_cast<unsigned char>(name[t])]);
+    if (p < patternLower.size() && patternLower[p] == c)
+    {
+      ++p;
+      ++t;
+      continue;
+    }
+    if (p < patternLower.size() && patternLower[p] == '*')
+    {
+      star = p++;
+      match = t;
+      continue;
+    }
+    if (star != std::string::npos)
+    {
+      p = star + 1;
+      t = ++match;
+      continue;
+    }
+    return false;
+  }
+  while (p < patternLower.size() && patternLower[p] == '*')
+    ++p;
+  return p == patternLower.size();
+}
+} // namespace xtream
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace xtream
+{
+// Channel/category name filter compiled once from lower-cased patterns. A pattern with
+// '*' must match the whole name ('*' = any sequence); any other pattern matches as a
+// substring. All plain patterns share one Aho-Corasick automaton, so a name is scanned
+// once however many there are; wildcard patterns are tried one by one. Names are
+// lower-cased byte by byte while matching, so a lookup allocates nothing.
+class NameFilter
+{
+public:
+  NameFilter() = default;
+  explicit NameFilter(const std::vector<std::string>& patternsLower);
+
+  bool Empty() const { return m_states == 0 && m_wildcards.empty(); }
+
+  // True when any pattern matches `name` (compared case-insensitively).
+  bool Matches(std::string_view name) const;
+
+private:
+  bool MatchesSubstring(std::string_view name) const;
+  bool MatchesWildcard(const std::string& patternLower, std::string_view name) const;
+
+  unsigned char m_lower[256] = {};
+  // Automaton over byte classes: bytes that occur in no pattern share class 0.
+  uint16_t m_class[256] = {};
+  size_t m_classes = 0;
+  size_t m_states = 0;
+  std::vector<uint32_t> m_next; // m_states x m_classes transitions, failure links folded in
+  std::vector<uint8_t> m_accept; // a pattern ends at this state or along its failure chain
+  std::vector<std::string> m_wildcards;
+};
+} // namespace xtream
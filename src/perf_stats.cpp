@@ -0,0 +1,243 @@
+#include "perf_stats.h"
+
+#include "memory_budget.h"
+
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
+
+namespace
+{
+using xtream::perf::Callback;
+using xtream::perf::Counter;
+using xtream::perf::Peak;
+using xtream::perf::Stage;
+
+constexpr size_t kStages = static_cast<size_t>(Stage::Count);
+constexpr size_t kCounters = static_cast<size_t>(Counter::Count);
+constexpr size_t kPeaks = static_cast<size_t>(Peak::Count);
+constexpr size_t kCallbacks = static_cast<size_t>(Callback::Count);
+
+// Log key stems, in enum order.
+constexpr const char* kStageNames[kStages] = {"categories",    "stream_fetch", "stream_parse",
+                                              "filter",        "sanitize",     "channel_cache",
+                                              "xmltv_fetch",   "xmltv_parse",  "epg_cache"};
+constexpr const char* kCounterNames[kCounters] = {"http_kb", "xmltv_kb", "streams", "channels",
+                                                  "programmes"};
+constexpr bool kCounterIsBytes[kCounters] = {true, true, false, false, false};
+constexpr const char* kPeakNames[kPeaks] = {"peak_http_body_kb", "peak_xmltv_body_kb",
+                                            "stream_text_kb", "epg_text_kb"};
+constexpr const char* kCallbackNames[kCallbacks] = {
+    "GetChannels",      "GetChannelGroups",           "GetChannelGroupMembers",
+    "GetEPGForChannel", "GetChannelStreamProperties", "GetEPGTagStreamProperties"};
+
+// Histogram bucket upper bounds in microseconds; the last bucket takes the rest.
+constexpr int64_t kBucketLimitsUs[] = {100, 500, 1000, 5000, 10000, 50000, 100000, 500000, 1000000};
+constexpr size_t kBuckets = sizeof(kBucketLimitsUs) / sizeof(kBucketLimitsUs[0]) + 1;
+constexpr const char* kBucketNames[kBuckets] = {"0.1ms", "0.5ms", "1ms",   "5ms", "10ms",
+                                                "50ms",  "100ms", "500ms", "1s",  ">1s"};
+
+struct StageStats
+{
+  std::atomic<uint64_t> runs{0};
+  std::atomic<uint64_t> totalUs{0};
+  std::atomic<uint64_t> maxUs{0};
+};
+
+struct Window
+{
+  StageStats stages[kStages];
+  std::atomic<uint64_t> counters[kCounters] = {};
+  std::atomic<uint64_t> peaks[kPeaks] = {};
+};
+
+struct CallbackStats
+{
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> totalUs{0};
+  std::atomic<uint64_t> maxUs{0};
+  std::atomic<uint64_t> buckets[kBuckets] = {};
+};
+
+Window g_refresh;
+Window g_total;
+CallbackStats g_callbacks[kCallbacks];
+
+// Memory figures of the current refresh.
+std::atomic<uint64_t> g_memBudget{0};
+std::atomic<uint64_t> g_memEstimate{0};
+std::atomic<uint64_t> g_rssStart{0};
+std::atomic<uint64_t> g_rssPeakStart{0};
+
+void StoreMax(std::atomic<uint64_t>& slot, uint64_t value)
+{
+  uint64_t seen = slot.load(std::memory_order_relaxed);
+  while (value > seen && !slot.compare_exchange_weak(seen, value, std::memory_order_relaxed))
+  {
+  }
+}
+
+uint64_t Micros(std::chrono::steady_clock::duration elapsed)
+{
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  return us > 0 ? static_cast<uint64_t>(us) : 0;
+}
+
+void AddStage(Window& window, size_t stage, uint64_t us)
+{
+  StageStats& s = window.stages[stage];
+  s.runs.fetch_add(1, std::memory_order_relaxed);
+  s.totalUs.fetch_add(us, std::memory_order_relaxed);
+  StoreMax(s.maxUs, us);
+}
+
+uint64_t CounterValue(const Window& window, size_t counter)
+{
+  const uint64_t v = window.counters[counter].load(std::memory_order_relaxed);
+  return kCounterIsBytes[counter] ? v / 1024 : v;
+}
+
+void AppendField(std::string& out, const char* key, const char* suffix, uint64_t value)
+{
+  char buf[96];
+  std::snprintf(buf, sizeof(buf), " %s%s=%" PRIu64, key, suffix, value);
+  out += buf;
+}
+} // namespace
+
+namespace xtream
+{
+namespace perf
+{
+void AddTime(Stage stage, std::chrono::steady_clock::duration elapsed)
+{
+  const size_t i = static_cast<size_t>(stage);
+  const uint64_t us = Micros(elapsed);
+  AddStage(g_refresh, i, us);
+  AddStage(g_total, i, us);
+}
+
+void Add(Counter counter, uint64_t value)
+{
+  const size_t i = static_cast<size_t>(counter);
+  g_refresh.counters[i].fetch_add(value, std::memory_order_relaxed);
+  g_total.counters[i].fetch_add(value, std::memory_order_relaxed);
+}
+
+void NotePeak(Peak peak, uint64_t bytes)
+{
+  const size_t i = static_cast<size_t>(peak);
+  StoreMax(g_refresh.peaks[i], bytes);
+  StoreMax(g_total.peaks[i], bytes);
+}
+
+void RecordCallback(Callback callback, std::chrono::steady_clock::duration elapsed)
+{
+  CallbackStats& c = g_callbacks[static_cast<size_t>(callback)];
+  const uint64_t us = Micros(elapsed);
+  size_t bucket = 0;
+  while (bucket + 1 < kBuckets && us > static_cast<uint64_t>(kBucketLimitsUs[bucket]))
+    ++bucket;
+  c.calls.fetch_add(1, std::memory_order_relaxed);
+  c.totalUs.fetch_add(us, std::memory_order_relaxed);
+  StoreMax(c.maxUs, us);
+  c.buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+void NoteMemoryPlan(uint64_t budgetBytes, uint64_t estimatedGrowthBytes)
+{
+  g_memBudget.store(budgetBytes, std::memory_order_relaxed);
+  g_memEstimate.store(estimatedGrowthBytes, std::memory_order_relaxed);
+}
+
+void BeginRefresh()
+{
+  for (auto& s : g_refresh.stages)
+  {
+    s.runs.store(0, std::memory_order_relaxed);
+    s.totalUs.store(0, std::memory_order_relaxed);
+    s.maxUs.store(0, std::memory_order_relaxed);
+  }
+  for (auto& c : g_refresh.counters)
+    c.store(0, std::memory_order_relaxed);
+  for (auto& p : g_refresh.peaks)
+    p.store(0, std::memory_order_relaxed);
+  g_memBudget.store(0, std::memory_order_relaxed);
+  g_memEstimate.store(0, std::memory_order_relaxed);
+  g_rssPeakStart.store(PeakResidentBytes(), std::memory_order_relaxed);
+  g_rssStart.store(ResidentBytes(), std::memory_order_relaxed);
+}
+
+std::string FormatRefresh(const char* kind, std::chrono::steady_clock::duration total)
+{
+  std::string out = "refresh=";
+  out += kind;
+  AppendField(out, "total", "_ms", Micros(total) / 1000);
+  for (size_t i = 0; i < kStages; ++i)
+    AppendField(out, kStageNames[i], "_ms",
+                g_refresh.stages[i].totalUs.load(std::memory_order_relaxed) / 1000);
+  for (size_t i = 0; i < kCounters; ++i)
+    AppendField(out, kCounterNames[i], "", CounterValue(g_refresh, i));
+  for (size_t i = 0; i < kPeaks; ++i)
+    AppendField(out, kPeakNames[i], "", g_refresh.peaks[i].load(std::memory_order_relaxed) / 1024);
+
+  const uint64_t rssStart = g_rssStart.load(std::memory_order_relaxed);
+  const uint64_t rssPeak = PeakResidentBytes();
+  // The peak is Kodi's lifetime one and isn't ours to reset, so it only tells the refresh's
+  // own peak when the refresh raised it.
+  const bool measured = rssPeak > g_rssPeakStart.load(std::memory_order_relaxed) && rssPeak > rssStart;
+  AppendField(out, "mem_budget", "_kb", g_memBudget.load(std::memory_order_relaxed) / 1024);
+  AppendField(out, "mem_estimate", "_kb", g_memEstimate.load(std::memory_order_relaxed) / 1024);
+  AppendField(out, "mem_rss_start", "_kb", rssStart / 1024);
+  AppendField(out, "mem_rss_peak", "_kb", rssPeak / 1024);
+  AppendField(out, "mem_growth", "_kb", measured ? (rssPeak - rssStart) / 1024 : 0);
+  return out;
+}
+
+std::vector<std::string> FormatReport()
+{
+  std::vector<std::string> lines;
+  char buf[160];
+  for (size_t i = 0; i < kStages; ++i)
+  {
+    const StageStats& s = g_total.stages[i];
+    const uint64_t runs = s.runs.load(std::memory_order_relaxed);
+    const uint64_t totalUs = s.totalUs.load(std::memory_order_relaxed);
+    std::snprintf(buf, sizeof(buf),
+                  "stage=%s runs=%" PRIu64 " total_ms=%" PRIu64 " avg_ms=%.1f max_ms=%.1f",
+                  kStageNames[i], runs, totalUs / 1000,
+                  runs ? static_cast<double>(totalUs) / 1000.0 / static_cast<double>(runs) : 0.0,
+                  static_cast<double>(s.maxUs.load(std::memory_order_relaxed)) / 1000.0);
+    lines.emplace_back(buf);
+  }
+
+  std::string counters = "totals";
+  for (size_t i = 0; i < kCounters; ++i)
+    AppendField(counters, kCounterNames[i], "", CounterValue(g_total, i));
+  for (size_t i = 0; i < kPeaks; ++i)
+    AppendField(counters, kPeakNames[i], "", g_total.peaks[i].load(std::memory_order_relaxed) / 1024);
+  lines.push_back(std::move(counters));
+
+  for (size_t i = 0; i < kCallbacks; ++i)
+  {
+    const CallbackStats& c = g_callbacks[i];
+    const uint64_t calls = c.calls.load(std::memory_order_relaxed);
+    const uint64_t totalUs = c.totalUs.load(std::memory_order_relaxed);
+    std::snprintf(buf, sizeof(buf), "callback=%s calls=%" PRIu64 " avg_ms=%.2f max_ms=%.1f le",
+                  kCallbackNames[i], calls,
+                  calls ? static_cast<double>(totalUs) / 1000.0 / static_cast<double>(calls) : 0.0,
+                  static_cast<double>(c.maxUs.load(std::memory_order_relaxed)) / 1000.0);
+    std::string line = buf;
+    for (size_t b = 0; b < kBuckets; ++b)
+    {
+      line += b == 0 ? "=" : ",";
+      line += kBucketNames[b];
+      line += ':';
+      line += std::to_string(c.buckets[b].load(std::memory_order_relaxed));
+    }
+    lines.push_back(std::move(line));
+  }
+  return lines;
+}
+} // namespace perf
+} // namespace xtream
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace xtream
+{
+// Process-wide load pipeline instrumentation: stage timers, counters, peak buffer sizes
+// and Kodi callback latency histograms. Every update is a relaxed atomic, so the calls
+// are cheap enough to leave in release builds. Values are kept twice: for the current
+// refresh (reset by BeginRefresh, reported as one log line) and since the addon started
+// (FormatReport).
+namespace perf
+{
+enum class Stage
+{
+  Categories,   // get_live_categories round trip and parse
+  StreamFetch,  // get_live_streams transfers (summed when fetched per category in parallel)
+  StreamParse,  // JSON scan into the stream table
+  Filter,       // separator, category and channel-name filters
+  Sanitize,     // channel name cleanup
+  ChannelCache, // channels.cache write
+  XmltvFetch,   // XMLTV transfer; includes the programme parse when streaming
+  XmltvParse,   // buffered XMLTV parse, or mapping a streamed guide onto the streams
+  EpgCache,     // epg.cache write
+  Count
+};
+
+enum class Counter
+{
+  HttpBytes,  // response body bytes read, all requests
+  XmltvBytes, // XMLTV body bytes read
+  Streams,    // streams parsed from get_live_streams
+  Channels,   // channels published to Kodi
+  Programmes, // programmes published to Kodi
+  Count
+};
+
+enum class Peak
+{
+  HttpBody,   // largest buffered response body
+  XmltvBody,  // largest buffered (inflated) XMLTV document
+  StreamText, // stream table text arena
+  EpgText,    // EPG store text arena
+  Count
+};
+
+enum class Callback
+{
+  GetChannels,
+  GetChannelGroups,
+  GetChannelGroupMembers,
+  GetEPGForChannel,
+  GetChannelStreamProperties,
+  GetEPGTagStreamProperties,
+  Count
+};
+
+void AddTime(Stage stage, std::chrono::steady_clock::duration elapsed);
+void Add(Counter counter, uint64_t value);
+void NotePeak(Peak peak, uint64_t bytes);
+void RecordCallback(Callback callback, std::chrono::steady_clock::duration elapsed);
+
+// Times its scope into `stage`.
+class ScopedStage
+{
+public:
+  explicit ScopedStage(Stage stage) : m_stage(stage), m_start(std::chrono::steady_clock::now()) {}
+  ~ScopedStage() { AddTime(m_stage, std::chrono::steady_clock::now() - m_start); }
+  ScopedStage(const ScopedStage&) = delete;
+  ScopedStage& operator=(const ScopedStage&) = delete;
+
+private:
+  Stage m_stage;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+// Times its scope into the histogram for `callback`.
+class ScopedCallback
+{
+public:
+  explicit ScopedCallback(Callback callback)
+    : m_callback(callback), m_start(std::chrono::steady_clock::now())
+  {
+  }
+  ~ScopedCallback() { RecordCallback(m_callback, std::chrono::steady_clock::now() - m_start); }
+  ScopedCallback(const ScopedCallback&) = delete;
+  ScopedCallback& operator=(const ScopedCallback&) = delete;
+
+private:
+  Callback m_callback;
+  std::chrono::steady_clock::time_point m_start;
+};
+
+// Sums many short intervals of a hot loop locally and records them as one run of
+// `stage` when it goes out of scope.
+class StageAccumulator
+{
+public:
+  explicit StageAccumulator(Stage stage) : m_stage(stage) {}
+  ~StageAccumulator() { AddTime(m_stage, m_total); }
+  StageAccumulator(const StageAccumulator&) = delete;
+  StageAccumulator& operator=(const StageAccumulator&) = delete;
+
+  void Add(std::chrono::steady_clock::duration elapsed) { m_total += elapsed; }
+
+private:
+  Stage m_stage;
+  std::chrono::steady_clock::duration m_total{0};
+};
+
+// The memory governor's budget and estimated peak growth for the current refresh
+// (see memory_budget.h).
+void NoteMemoryPlan(uint64_t budgetBytes, uint64_t estimatedGrowthBytes);
+
+// Clears the per-refresh values and records the process's resident set and its peak.
+// Refreshes run one at a time on the worker thread.
+void BeginRefresh();
+
+// The current refresh as one key=value line, every key always present:
+// "refresh=<kind> total_ms=... categories_ms=... http_kb=... peak_http_body_kb=...
+// mem_budget_kb=... mem_estimate_kb=... mem_rss_start_kb=... mem_rss_peak_kb=...
+// mem_growth_kb=...". mem_growth_kb is the measured counterpart of mem_estimate_kb, the
+// peak minus the start; 0 when the refresh stayed below the process's earlier peak, or
+// where the platform reports no peak.
+std::string FormatRefresh(const char* kind, std::chrono::steady_clock::duration total);
+
+// Totals since start: one line per stage, counters, peaks and one per callback with its
+// latency histogram.
+std::vector<std::string> FormatReport();
+} // namespace perf
+} // namespace xtream
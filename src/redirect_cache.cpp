@@ -0,0 +1,89 @@
+#include "redirect_cache.h"
+
+#include <utility>
+
+namespace xtream
+{
+RedirectCache::RedirectCache(ResolveFn resolve, std::chrono::steady_clock::duration ttl)
+  : m_resolve(std::move(resolve)), m_ttl(ttl)
+{
+}
+
+RedirectCache::~RedirectCache()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+    m_queue.clear();
+  }
+  m_cv.notify_all();
+  if (m_thread.joinable())
+    m_thread.join();
+}
+
+std::string RedirectCache::Take(const std::string& url)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  const auto it = m_entries.find(url);
+  if (it == m_entries.end())
+    return {};
+  std::string resolved;
+  if (it->second.expires > std::chrono::steady_clock::now())
+    resolved = std::move(it->second.resolved);
+  m_entries.erase(it);
+  return resolved;
+}
+
+void RedirectCache::Warm(std::vector<std::string> urls)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_stop)
+      return;
+    const auto now = std::chrono::steady_clock::now();
+    // Expired entries are only ever dropped here or by Take.
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+      it = it->second.expires <= now ? m_entries.erase(it) : std::next(it);
+    m_queue.clear();
+    for (auto& url : urls)
+    {
+      if (!url.empty() && !m_entries.count(url))
+        m_queue.push_back(std::move(url));
+    }
+    if (!m_thread.joinable())
+      m_thread = std::thread([this]() { Run(); });
+  }
+  m_cv.notify_one();
+}
+
+void RedirectCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_entries.clear();
+  m_queue.clear();
+  ++m_epoch;
+}
+
+void RedirectCache::Run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+  {
+    m_cv.wait(lock, [this]() { return m_stop || !m_queue.empty(); });
+    if (m_stop)
+      return;
+    std::string url = std::move(m_queue.front());
+    m_queue.erase(m_queue.begin());
+    const uint64_t epoch = m_epoch;
+
+    lock.unlock();
+    std::string resolved = m_resolve(url);
+    lock.lock();
+
+    // A resolution that landed where it started saves nothing; one that straddled a
+    // Clear may belong to old settings.
+    if (!m_stop && epoch == m_epoch && !resolved.empty() && resolved != url)
+      m_entries[url] = Entry{std::move(resolved), std::chrono::steady_clock::now() + m_ttl};
+  }
+}
+} // namespace xtream
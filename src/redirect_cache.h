@@ -0,0 +1,60 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace xtream
+{
+// Live stream URLs resolved ahead of a tune. Many panels answer /live/... with a
+// redirect to a load-balanced edge; resolving the neighbours of the channel being
+// watched in the background lets the next zap start on the edge directly. Entries
+// expire after `ttl` and are handed out once, since some edges embed short-lived or
+// single-use tokens. Thread-safe.
+class RedirectCache
+{
+public:
+  // Returns the URL `url` finally lands on, or empty when it couldn't be resolved.
+  using ResolveFn = std::function<std::string(const std::string& url)>;
+
+  RedirectCache(ResolveFn resolve, std::chrono::steady_clock::duration ttl);
+  ~RedirectCache();
+  RedirectCache(const RedirectCache&) = delete;
+  RedirectCache& operator=(const RedirectCache&) = delete;
+
+  // The resolved URL for `url` if one is fresh, removing it; otherwise empty.
+  std::string Take(const std::string& url);
+
+  // Queues `urls` for background resolution, replacing whatever is still queued; URLs
+  // with a fresh entry are skipped.
+  void Warm(std::vector<std::string> urls);
+
+  // Drops every entry and anything queued.
+  void Clear();
+
+private:
+  struct Entry
+  {
+    std::string resolved;
+    std::chrono::steady_clock::time_point expires;
+  };
+
+  void Run();
+
+  ResolveFn m_resolve;
+  std::chrono::steady_clock::duration m_ttl;
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::unordered_map<std::string, Entry> m_entries;
+  std::vector<std::string> m_queue;
+  uint64_t m_epoch = 0; // bumped by Clear
+  bool m_stop = false;
+  std::thread m_thread; // started on the first Warm
+};
+} // namespace xtream
@@ -0,0 +1,561 @@
+#include "stream_json.h"
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define XTREAM_JSON_SSE2 1
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define XTREAM_JSON_NEON 1
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+using xtream::StreamTableBuilder;
+using xtream::StreamTextRef;
+
+#if defined(XTREAM_JSON_SSE2)
+unsigned CountTrailingZeros(uint32_t v)
+{
+#if defined(_MSC_VER)
+  unsigned long index = 0;
+  _BitScanForward(&index, v);
+  return static_cast<unsigned>(index);
+#else
+  return static_cast<unsigned>(__builtin_ctz(v));
+#endif
+}
+#endif
+
+// Returns the first '"' or '\\' in [p, end), or end. This is where string scanning
+// spends its time (names and escaped icon URLs), so it looks at 16 bytes at a time.
+const char* FindQuoteOrBackslash(const char* p, const char* end)
+{
+#if defined(XTREAM_JSON_SSE2)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  while (end - p >= 16)
+  {
+    const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    const int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)));
+    if (mask != 0)
+      return p + CountTrailingZeros(static_cast<uint32_t>(mask));
+    p += 16;
+  }
+#elif defined(XTREAM_JSON_NEON)
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  while (end - p >= 16)
+  {
+    const uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(p));
+    const uint8x16_t hit = vorrq_u8(vceqq_u8(v, quote), vceqq_u8(v, backslash));
+    // Narrow each byte to 4 bits so the whole comparison fits in one 64-bit lane.
+    const uint64_t mask =
+        vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(hit), 4)), 0);
+    if (mask != 0)
+      return p + (__builtin_ctzll(mask) >> 2);
+    p += 16;
+  }
+#endif
+  while (p < end && *p != '"' && *p != '\\')
+    ++p;
+  return p;
+}
+
+bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+bool IsDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+int HexVal(char ch)
+{
+  if (ch >= '0' && ch <= '9')
+    return ch - '0';
+  if (ch >= 'a' && ch <= 'f')
+    return 10 + (ch - 'a');
+  if (ch >= 'A' && ch <= 'F')
+    return 10 + (ch - 'A');
+  return -1;
+}
+
+// Four hex digits at p, or -1.
+int Hex4(const char* p)
+{
+  const int h1 = HexVal(p[0]);
+  const int h2 = HexVal(p[1]);
+  const int h3 = HexVal(p[2]);
+  const int h4 = HexVal(p[3]);
+  if (h1 < 0 || h2 < 0 || h3 < 0 || h4 < 0)
+    return -1;
+  return (h1 << 12) | (h2 << 8) | (h3 << 4) | h4;
+}
+
+void AppendUtf8(std::string& dst, uint32_t cp)
+{
+  if (cp <= 0x7F)
+  {
+    dst.push_back(static_cast<char>(cp));
+  }
+  else if (cp <= 0x7FF)
+  {
+    dst.push_back(static_cast<char>(0xC0 | ((cp >> 6) & 0x1F)));
+    dst.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+  else if (cp <= 0xFFFF)
+  {
+    dst.push_back(static_cast<char>(0xE0 | ((cp >> 12) & 0x0F)));
+    dst.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    dst.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+  else
+  {
+    dst.push_back(static_cast<char>(0xF0 | ((cp >> 18) & 0x07)));
+    dst.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    dst.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    dst.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  }
+}
+
+enum class Field
+{
+  None,
+  StreamId,
+  CategoryId,
+  Number,
+  Name,
+  Icon,
+  EpgChannelId,
+  TvArchive,
+  TvArchiveDuration
+};
+
+Field MatchKey(std::string_view key)
+{
+  switch (key.size())
+  {
+    case 3:
+      return key == "num" ? Field::Number : Field::None;
+    case 4:
+      return key == "name" ? Field::Name : Field::None;
+    case 9:
+      return key == "stream_id" ? Field::StreamId : Field::None;
+    case 10:
+      return key == "tv_archive" ? Field::TvArchive : Field::None;
+    case 11:
+      if (key == "category_id")
+        return Field::CategoryId;
+      return key == "stream_icon" ? Field::Icon : Field::None;
+    case 14:
+      return key == "epg_channel_id" ? Field::EpgChannelId : Field::None;
+    case 19:
+      return key == "tv_archive_duration" ? Field::TvArchiveDuration : Field::None;
+    default:
+      return Field::None;
+  }
+}
+
+// Walks the response once, decoding into the builder. Value rules match the per-field
+// extractors in xtream_client.cpp: numbers may be quoted, booleans may be true/false,
+// 0/1 or "0"/"1", and a value of the wrong type leaves the field at its default.
+class LiveStreamScanner
+{
+public:
+  LiveStreamScanner(const char* begin, const char* end, StreamTableBuilder& out)
+    : m_p(begin), m_end(end), m_out(out), m_text(out.Text())
+  {
+  }
+
+  bool Parse()
+  {
+    SkipSpace();
+    if (m_p >= m_end || *m_p != '[')
+      return false;
+    ++m_p;
+
+    bool any = false;
+    while (m_p < m_end)
+    {
+      const char c = *m_p;
+      if (c == '{')
+      {
+        any = true;
+        const char* objStart = m_p;
+        const size_t textMark = m_text.size();
+        StreamTableBuilder::Row row;
+        bool hasId = false;
+        if (!ParseObject(row, hasId))
+        {
+          // Malformed object: resynchronise after its closing brace, keeping what was
+          // read. A truncated one (no closing brace) is dropped.
+          m_p = objStart;
+          if (!SkipBraces())
+            hasId = false;
+        }
+        if (hasId)
+          m_out.Add(row);
+        else
+          m_text.resize(textMark); // drop the text of a skipped object
+      }
+      else if (c == '"')
+      {
+        SkipString();
+      }
+      else if (c == ']')
+      {
+        break;
+      }
+      else
+      {
+        ++m_p;
+      }
+    }
+    return any;
+  }
+
+private:
+  void SkipSpace()
+  {
+    while (m_p < m_end && IsSpace(*m_p))
+      ++m_p;
+  }
+
+  // At '"': leaves m_p after the closing quote. False on an unterminated string.
+  bool SkipString()
+  {
+    ++m_p;
+    while (true)
+    {
+      m_p = FindQuoteOrBackslash(m_p, m_end);
+      if (m_p >= m_end)
+        return false;
+      if (*m_p == '"')
+      {
+        ++m_p;
+        return true;
+      }
+      m_p += 2; // backslash and the escaped character
+    }
+  }
+
+  // At '"': raw bytes between the quotes (keys are matched undecoded).
+  bool ReadRawString(std::string_view& out)
+  {
+    const char* begin = m_p + 1;
+    if (!SkipString())
+      return false;
+    out = std::string_view(begin, static_cast<size_t>(m_p - 1 - begin));
+    return true;
+  }
+
+  // At '"': decodes onto the end of the text buffer and points ref at the result.
+  bool DecodeString(StreamTextRef& ref)
+  {
+    // Bodies are capped far below 4 GB, so offsets always fit.
+    const size_t start = m_text.size();
+    const bool ok = DecodeStringInto(m_text);
+    ref.offset = static_cast<uint32_t>(start);
+    ref.length = static_cast<uint32_t>(m_text.size() - start);
+    return ok;
+  }
+
+  bool DecodeStringInto(std::string& dst)
+  {
+    ++m_p;
+    while (true)
+    {
+      const char* stop = FindQuoteOrBackslash(m_p, m_end);
+      dst.append(m_p, static_cast<size_t>(stop - m_p));
+      m_p = stop;
+      if (m_p >= m_end)
+        return false;
+      if (*m_p == '"')
+      {
+        ++m_p;
+        return true;
+      }
+      if (m_end - m_p < 2)
+      {
+        m_p = m_end;
+        return false;
+      }
+
+      const char c = m_p[1];
+      m_p += 2;
+      switch (c)
+      {
+        case 'b':
+          dst.push_back('\b');
+          break;
+        case 'f':
+          dst.push_back('\f');
+          break;
+        case 'n':
+          dst.push_back('\n');
+          break;
+        case 'r':
+          dst.push_back('\r');
+          break;
+        case 't':
+          dst.push_back('\t');
+          break;
+        case 'u':
+          DecodeUnicodeEscape(dst);
+          break;
+        default:
+          // '"', '\\', '/' and unknown escapes: keep the character verbatim.
+          dst.push_back(c);
+          break;
+      }
+    }
+  }
+
+  // m_p is just past "\u". Emits the code point (joining a surrogate pair) or, when the
+  // digits are malformed, a literal 'u' and leaves the digits to be copied as text.
+  void DecodeUnicodeEscape(std::string& dst)
+  {
+    const int cu = (m_end - m_p > 3) ? Hex4(m_p) : -1;
+    if (cu < 0)
+    {
+      dst.push_back('u');
+      return;
+    }
+    m_p += 4;
+
+    if (cu >= 0xD800 && cu <= 0xDBFF && m_end - m_p > 5 && m_p[0] == '\\' && m_p[1] == 'u')
+    {
+      const int lo = Hex4(m_p + 2);
+      if (lo >= 0xDC00 && lo <= 0xDFFF)
+      {
+        AppendUtf8(dst, 0x10000 + ((static_cast<uint32_t>(cu - 0xD800) << 10) |
+                                   static_cast<uint32_t>(lo - 0xDC00)));
+        m_p += 6;
+        return;
+      }
+    }
+
+    if (cu >= 0xD800 && cu <= 0xDFFF)
+      AppendUtf8(dst, 0xFFFD); // lone surrogate
+    else
+      AppendUtf8(dst, static_cast<uint32_t>(cu));
+  }
+
+  // Skips a nested object or array, counting both bracket kinds outside strings.
+  bool SkipContainer()
+  {
+    int depth = 0;
+    while (m_p < m_end)
+    {
+      const char c = *m_p;
+      if (c == '"')
+      {
+        if (!SkipString())
+          return false;
+        continue;
+      }
+      ++m_p;
+      if (c == '{' || c == '[')
+        ++depth;
+      else if ((c == '}' || c == ']') && --depth == 0)
+        return true;
+    }
+    return false;
+  }
+
+  // Error recovery: the same brace-only counting the span iterator used.
+  bool SkipBraces()
+  {
+    int depth = 0;
+    while (m_p < m_end)
+    {
+      const char c = *m_p;
+      if (c == '"')
+      {
+        if (!SkipString())
+          return false;
+        continue;
+      }
+      ++m_p;
+      if (c == '{')
+        ++depth;
+      else if (c == '}' && --depth == 0)
+        return true;
+    }
+    return false;
+  }
+
+  bool SkipValue()
+  {
+    if (m_p >= m_end)
+      return false;
+    if (*m_p == '"')
+      return SkipString();
+    if (*m_p == '{' || *m_p == '[')
+      return SkipContainer();
+    while (m_p < m_end && *m_p != ',' && *m_p != '}' && *m_p != ']' && !IsSpace(*m_p))
+      ++m_p;
+    return m_p < m_end;
+  }
+
+  // Reads an optionally quoted, optionally negative integer prefix at m_p.
+  bool PeekInt(int& out) const
+  {
+    const char* p = m_p;
+    if (p < m_end && *p == '"')
+      ++p;
+    bool neg = false;
+    if (p < m_end && *p == '-')
+    {
+      neg = true;
+      ++p;
+    }
+    uint64_t v = 0;
+    bool any = false;
+    while (p < m_end && IsDigit(*p))
+    {
+      any = true;
+      v = v * 10 + static_cast<uint64_t>(*p - '0');
+      ++p;
+    }
+    if (!any)
+      return false;
+    const int64_t sv = static_cast<int64_t>(v);
+    out = static_cast<int>(neg ? -sv : sv);
+    return true;
+  }
+
+  bool PeekBool(bool& out) const
+  {
+    const size_t left = static_cast<size_t>(m_end - m_p);
+    if (left >= 4 && std::memcmp(m_p, "true", 4) == 0)
+    {
+      out = true;
+      return true;
+    }
+    if (left >= 5 && std::memcmp(m_p, "false", 5) == 0)
+    {
+      out = false;
+      return true;
+    }
+    const char* p = m_p;
+    if (p < m_end && *p == '"')
+      ++p;
+    if (p < m_end && (*p == '1' || *p == '0'))
+    {
+      out = (*p == '1');
+      return true;
+    }
+    return false;
+  }
+
+  // At '{'. hasId reports whether stream_id was read, even if the object is malformed.
+  bool ParseObject(StreamTableBuilder::Row& s, bool& hasId)
+  {
+    ++m_p;
+    SkipSpace();
+    if (m_p < m_end && *m_p == '}')
+    {
+      ++m_p;
+      return true;
+    }
+
+    unsigned seen = 0; // the first occurrence of a key wins
+    while (m_p < m_end)
+    {
+      std::string_view key;
+      if (*m_p != '"' || !ReadRawString(key))
+        return false;
+      SkipSpace();
+      if (m_p >= m_end || *m_p != ':')
+        return false;
+      ++m_p;
+      SkipSpace();
+
+      const Field field = MatchKey(key);
+      const unsigned bit = 1u << static_cast<unsigned>(field);
+      bool consumed = false;
+      if (field != Field::None && (seen & bit) == 0)
+      {
+        seen |= bit;
+        switch (field)
+        {
+          case Field::StreamId:
+            hasId = PeekInt(s.id);
+            break;
+          case Field::CategoryId:
+            PeekInt(s.categoryId);
+            break;
+          case Field::Number:
+            PeekInt(s.number);
+            break;
+          case Field::TvArchiveDuration:
+            PeekInt(s.tvArchiveDuration);
+            break;
+          case Field::TvArchive:
+            PeekBool(s.tvArchive);
+            break;
+          case Field::Name:
+          case Field::Icon:
+          case Field::EpgChannelId:
+            if (m_p < m_end && *m_p == '"')
+            {
+              StreamTextRef& dst = (field == Field::Name)   ? s.name
+                                   : (field == Field::Icon) ? s.icon
+                                                            : s.epgChannelId;
+              if (!DecodeString(dst))
+                return false;
+              consumed = true;
+            }
+            break;
+          case Field::None:
+            break;
+        }
+      }
+      if (!consumed && !SkipValue())
+        return false;
+
+      SkipSpace();
+      if (m_p >= m_end)
+        return false;
+      if (*m_p == ',')
+      {
+        ++m_p;
+        SkipSpace();
+        continue;
+      }
+      if (*m_p == '}')
+      {
+        ++m_p;
+        return true;
+      }
+      return false;
+    }
+    return false;
+  }
+
+  const char* m_p;
+  const char* m_end;
+  StreamTableBuilder& m_out;
+  std::string& m_text;
+};
+} // namespace
+
+namespace xtream
+{
+bool ParseLiveStreamsJson(std::string_view json, StreamTableBuilder& out)
+{
+  LiveStreamScanner scanner(json.data(), json.data() + json.size(), out);
+  return scanner.Parse();
+}
+} // namespace xtream
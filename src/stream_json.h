@@ -0,0 +1,15 @@
+#pragma once
+
+#include "stream_table.h"
+
+#include <string_view>
+
+namespace xtream
+{
+// One-pass parser for the get_live_streams response (a top-level JSON array of stream
+// objects). Known keys are decoded straight into the builder's rows and text buffer as
+// the object is walked; everything else is skipped. Objects without a parsable
+// stream_id are dropped. Appends to `out` and returns false when the body is not an
+// array of objects.
+bool ParseLiveStreamsJson(std::string_view json, StreamTableBuilder& out);
+} // namespace xtream
@@ -0,0 +1,78 @@
+#include "stream_table.h"
+
+#include <limits>
+
+namespace xtream
+{
+const LiveStream* StreamTable::Find(int id) const
+{
+  const auto it = m_indexById.find(id);
+  return it != m_indexById.end() ? &m_streams[it->second] : nullptr;
+}
+
+StreamTextRef StreamTableBuilder::Append(std::string_view s)
+{
+  StreamTextRef ref;
+  if (s.empty() || m_text.size() + s.size() > std::numeric_limits<uint32_t>::max())
+    return ref;
+  ref.offset = static_cast<uint32_t>(m_text.size());
+  ref.length = static_cast<uint32_t>(s.size());
+  m_text.append(s.data(), s.size());
+  return ref;
+}
+
+void StreamTableBuilder::Append(const StreamTable& table)
+{
+  for (const LiveStream& s : table)
+  {
+    Row row;
+    row.id = s.id;
+    row.categoryId = s.categoryId;
+    row.number = s.number;
+    row.name = Append(s.name);
+    row.icon = Append(s.icon);
+    row.epgChannelId = Append(s.epgChannelId);
+    row.tvArchive = s.tvArchive;
+    row.tvArchiveDuration = s.tvArchiveDuration;
+    m_rows.push_back(row);
+  }
+}
+
+void StreamTableBuilder::Reserve(size_t streams, size_t textBytes)
+{
+  m_rows.reserve(streams);
+  m_text.reserve(textBytes);
+}
+
+StreamTable StreamTableBuilder::Build()
+{
+  m_text.shrink_to_fit();
+  // Views are taken from the final buffer, after the move.
+  auto text = std::make_shared<const std::string>(std::move(m_text));
+  const std::string_view all(*text);
+
+  StreamTable table;
+  table.m_streams.reserve(m_rows.size());
+  table.m_indexById.reserve(m_rows.size());
+  for (const Row& row : m_rows)
+  {
+    LiveStream s;
+    s.id = row.id;
+    s.categoryId = row.categoryId;
+    s.number = row.number;
+    s.name = all.substr(row.name.offset, row.name.length);
+    s.icon = all.substr(row.icon.offset, row.icon.length);
+    s.epgChannelId = all.substr(row.epgChannelId.offset, row.epgChannelId.length);
+    s.tvArchive = row.tvArchive;
+    s.tvArchiveDuration = row.tvArchiveDuration;
+    // emplace keeps the first row for a duplicated id.
+    table.m_indexById.emplace(s.id, static_cast<uint32_t>(table.m_streams.size()));
+    table.m_streams.push_back(s);
+  }
+  table.m_text = std::move(text);
+
+  m_text.clear();
+  std::vector<Row>().swap(m_rows);
+  return table;
+}
+} // namespace xtream
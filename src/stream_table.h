@@ -0,0 +1,84 @@
+#pragma once
+
+#include "xtream_client.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace xtream
+{
+// Text reference into a StreamTableBuilder's buffer.
+struct StreamTextRef
+{
+  uint32_t offset = 0;
+  uint32_t length = 0;
+};
+
+// Immutable stream list: fixed-size LiveStream records whose text views all point into
+// one shared buffer. Copies share the buffer, so a table can be published by pointer
+// and kept alive by whoever still reads it. An id index is built with the table, so
+// per-channel callbacks look a stream up in O(1) instead of scanning.
+class StreamTable
+{
+public:
+  using const_iterator = std::vector<LiveStream>::const_iterator;
+
+  const_iterator begin() const { return m_streams.begin(); }
+  const_iterator end() const { return m_streams.end(); }
+  size_t size() const { return m_streams.size(); }
+  bool empty() const { return m_streams.empty(); }
+  const LiveStream& operator[](size_t i) const { return m_streams[i]; }
+
+  size_t TextBytes() const { return m_text ? m_text->size() : 0; }
+
+  // The first stream with `id` (matching the order a scan would find), or nullptr.
+  const LiveStream* Find(int id) const;
+  const LiveStream* FindByUid(unsigned int uid) const { return Find(static_cast<int>(uid)); }
+
+private:
+  friend class StreamTableBuilder;
+
+  std::shared_ptr<const std::string> m_text;
+  std::vector<LiveStream> m_streams;
+  std::unordered_map<int, uint32_t> m_indexById;
+};
+
+// Collects stream rows with their text appended to a single buffer, then freezes them
+// into a StreamTable. Parsers decode strings straight into Text() and keep references.
+class StreamTableBuilder
+{
+public:
+  struct Row
+  {
+    int id = 0;
+    int categoryId = 0;
+    int number = 0;
+    StreamTextRef name;
+    StreamTextRef icon;
+    StreamTextRef epgChannelId;
+    bool tvArchive = false;
+    int tvArchiveDuration = 0;
+  };
+
+  std::string& Text() { return m_text; }
+  StreamTextRef Append(std::string_view s);
+
+  void Add(const Row& row) { m_rows.push_back(row); }
+  // Copies every stream of `table`, in order. Reserve first when merging several.
+  void Append(const StreamTable& table);
+  void Reserve(size_t streams, size_t textBytes);
+
+  size_t size() const { return m_rows.size(); }
+
+  // Builds the table and resets the builder.
+  StreamTable Build();
+
+private:
+  std::string m_text;
+  std::vector<Row> m_rows;
+};
+} // namespace xtream
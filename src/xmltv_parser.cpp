@@ -0,0 +1,1213 @@
+#include "xmltv_parser.h"
+
+#include "epg_name_match.h"
+#include "xmltv_time.h"
+
+#include <kodi/General.h>
+#include <pugixml.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+constexpr size_t kReadChunkBytes = 64 * 1024;
+constexpr size_t kMaxElementBytes = 4 * 1024 * 1024; // a single <programme> is a few KB at most
+constexpr size_t kCompactThresholdBytes = 256 * 1024;
+constexpr size_t kMinParallelChunkBytes = 1024 * 1024; // smaller slices aren't worth a thread
+constexpr unsigned kChunksPerThread = 4;               // evens out chunks of uneven density
+
+std::string Trim(std::string s)
+{
+  auto isSpace = [](unsigned char c) { return std::isspace(c) != 0; };
+  while (!s.empty() && isSpace(static_cast<unsigned char>(s.front())))
+    s.erase(s.begin());
+  while (!s.empty() && isSpace(static_cast<unsigned char>(s.back())))
+    s.pop_back();
+  return s;
+}
+
+std::string ToLower(std::string s)
+{
+  std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
+    return static_cast<char>(std::tolower(c));
+  });
+  return s;
+}
+
+std::string NormalizeChannelNameForEpg(const std::string& in)
+{
+  // Trim and collapse whitespace
+  std::string s = Trim(in);
+  if (s.empty())
+    return s;
+
+  // Decode a few common HTML entities
+  auto replace_all = [](std::string& t, const char* from, const char* to) {
+    const std::string a(from);
+    const std::string b(to);
+    size_t pos = 0;
+    while ((pos = t.find(a, pos)) != std::string::npos)
+    {
+      t.replace(pos, a.size(), b);
+      pos += b.size();
+    }
+  };
+  replace_all(s, "&amp;", "&");
+  replace_all(s, "&quot;", "\"");
+  replace_all(s, "&#039;", "'");
+  replace_all(s, "&lt;", "<");
+  replace_all(s, "&gt;", ">");
+
+  std::string collapsed;
+  collapsed.reserve(s.size());
+  bool prevSpace = false;
+  for (unsigned char ch : s)
+  {
+    if (std::isspace(ch))
+    {
+      if (!prevSpace)
+        collapsed.push_back(' ');
+      prevSpace = true;
+      continue;
+    }
+    prevSpace = false;
+    collapsed.push_back(static_cast<char>(ch));
+  }
+
+  collapsed = Trim(collapsed);
+
+  // Strip category prefix like "UK | Channel" -> "Channel"
+  const std::string sep = " | ";
+  const size_t pos = collapsed.rfind(sep);
+  if (pos != std::string::npos && pos + sep.size() < collapsed.size())
+    collapsed = Trim(collapsed.substr(pos + sep.size()));
+
+  return collapsed;
+}
+
+// Reads an attribute value straight from an element's raw opening tag, without parsing
+// the element. Only plain values are found; anything unusual (entities, a '>' inside a
+// value, non-UTF-8 input) makes it return false and the caller parses properly.
+bool PeekRawAttribute(const char* begin, size_t size, std::string_view name, std::string_view& out)
+{
+  const char* tagEnd = static_cast<const char*>(std::memchr(begin, '>', size));
+  if (!tagEnd)
+    return false;
+  const std::string_view tag(begin, static_cast<size_t>(tagEnd - begin));
+  for (size_t pos = tag.find(name); pos != std::string_view::npos; pos = tag.find(name, pos + 1))
+  {
+    const size_t eq = pos + name.size();
+    if (pos == 0 || !std::isspace(static_cast<unsigned char>(tag[pos - 1])) || eq + 1 >= tag.size() ||
+        tag[eq] != '=' || (tag[eq + 1] != '"' && tag[eq + 1] != '\''))
+      continue;
+    const size_t valueStart = eq + 2;
+    const size_t valueEnd = tag.find(tag[eq + 1], valueStart);
+    if (valueEnd == std::string_view::npos)
+      return false;
+    out = tag.substr(valueStart, valueEnd - valueStart);
+    return out.find('&') == std::string_view::npos;
+  }
+  return false;
+}
+
+// Resolves an XMLTV channel to stream ids. The exact tiers try epg_channel_id, then a
+// numeric id that is a stream id, then the normalised display name. The inexact tiers
+// then try the EpgNameKey of the display name, a match remembered in the match table,
+// and finally a fuzzy name match whose result the table remembers. Inexact tiers only
+// hand out streams no other XMLTV channel has claimed. Counts how each one matched.
+class StreamResolver
+{
+public:
+  StreamResolver(const xtream::StreamTable& streams, xtream::EpgMatchTable* matches)
+    : m_streams(streams), m_matches(matches)
+  {
+    if (m_matches)
+      m_matches->BeginPass();
+
+    // Index stream ids, normalised names and provider EPG ids for matching
+    for (const auto& stream : streams)
+    {
+      if (stream.id > 0)
+      {
+        m_streamIds.insert(stream.id);
+        const std::string normName = NormalizeChannelNameForEpg(std::string(stream.name));
+        if (!normName.empty())
+          m_streamNameToIds[ToLower(normName)].push_back(stream.id);
+
+        if (!stream.epgChannelId.empty())
+          m_xmltvIdToStreamIds[std::string(stream.epgChannelId)].push_back(stream.id);
+      }
+    }
+  }
+
+  // `declared` is false for ids only seen on programmes; those don't count as channels.
+  std::vector<int> Resolve(const std::string& xmltvId,
+                           const std::string& displayNameNormalized,
+                           bool declared)
+  {
+    std::vector<int> ids = ResolveExact(xmltvId, displayNameNormalized, declared);
+    if (ids.empty())
+      ids = ResolveInexact(xmltvId, displayNameNormalized, declared);
+    return ids;
+  }
+
+  // Resolve in two steps, for callers that see every channel up front and can let all
+  // exact matches claim their streams first. ResolveInexact only for channels
+  // ResolveExact left empty.
+  std::vector<int> ResolveExact(const std::string& xmltvId,
+                                const std::string& displayNameNormalized,
+                                bool declared)
+  {
+    if (declared)
+      m_totalXmltvChannels++;
+    std::vector<int> ids = ResolveStreamIds(xmltvId, displayNameNormalized);
+    m_claimed.insert(ids.begin(), ids.end());
+    return ids;
+  }
+
+  std::vector<int> ResolveInexact(const std::string& xmltvId,
+                                  const std::string& displayNameNormalized,
+                                  bool declared)
+  {
+    std::vector<int> ids;
+    const std::string key =
+        displayNameNormalized.empty() ? std::string() : xtream::EpgNameKey(displayNameNormalized);
+    if (!key.empty())
+    {
+      xtream::EpgNameIndex& index = NameIndex();
+      std::vector<int> remembered;
+      if (const std::vector<int>* exact = index.FindKey(key))
+      {
+        ids = Unclaimed(*exact);
+        m_mappedByKey += ids.empty() ? 0 : 1;
+      }
+      else if (m_matches && m_matches->Lookup(xmltvId, key, index, remembered))
+      {
+        ids = Unclaimed(remembered);
+        m_mappedByRemembered += ids.empty() ? 0 : 1;
+      }
+      else
+      {
+        const std::vector<int> found = index.FindFuzzy(key);
+        if (m_matches)
+          m_matches->Remember(xmltvId, key, index, found);
+        ids = Unclaimed(found);
+        m_mappedByFuzzy += ids.empty() ? 0 : 1;
+      }
+    }
+    m_claimed.insert(ids.begin(), ids.end());
+    if (ids.empty() && declared)
+      m_unmapped++;
+    return ids;
+  }
+
+  // Call once every channel has been resolved: the match table forgets channels the
+  // guide no longer has.
+  void FinishPass()
+  {
+    if (m_matches)
+      m_matches->EndPass();
+  }
+
+  void LogChannelMapping() const
+  {
+    kodi::Log(ADDON_LOG_INFO,
+              "pvr.dispatcharr: XMLTV channel mapping: total=%d, epg_id=%d, numeric=%d, name=%d, "
+              "key=%d, remembered=%d, fuzzy=%d, unmapped=%d",
+              m_totalXmltvChannels, m_mappedByEpgId, m_mappedByNumericId, m_mappedByName,
+              m_mappedByKey, m_mappedByRemembered, m_mappedByFuzzy, m_unmapped);
+  }
+
+private:
+  // Built on first use; guides whose channels all match exactly never pay for it.
+  xtream::EpgNameIndex& NameIndex()
+  {
+    if (!m_nameIndexBuilt)
+    {
+      for (const auto& stream : m_streams)
+      {
+        if (stream.id > 0)
+          m_nameIndex.Add(stream.id, NormalizeChannelNameForEpg(std::string(stream.name)));
+      }
+      m_nameIndexBuilt = true;
+    }
+    return m_nameIndex;
+  }
+
+  std::vector<int> Unclaimed(const std::vector<int>& ids) const
+  {
+    std::vector<int> out;
+    for (int id : ids)
+    {
+      if (!m_claimed.count(id))
+        out.push_back(id);
+    }
+    return out;
+  }
+
+  std::vector<int> ResolveStreamIds(const std::string& xmltvId,
+                                    const std::string& displayNameNormalized)
+  {
+    // Prefer explicit epg_channel_id mapping from stream list
+    const auto epgIdIt = m_xmltvIdToStreamIds.find(xmltvId);
+    if (epgIdIt != m_xmltvIdToStreamIds.end() && !epgIdIt->second.empty())
+    {
+      m_mappedByEpgId++;
+      return epgIdIt->second;
+    }
+
+    char* end = nullptr;
+    const long numericId = std::strtol(xmltvId.c_str(), &end, 10);
+    if (end && *end == '\0' && numericId > 0)
+    {
+      const int streamId = static_cast<int>(numericId);
+      if (m_streamIds.find(streamId) != m_streamIds.end())
+      {
+        m_mappedByNumericId++;
+        return {streamId};
+      }
+    }
+
+    if (!displayNameNormalized.empty())
+    {
+      const auto nameIt = m_streamNameToIds.find(ToLower(displayNameNormalized));
+      if (nameIt != m_streamNameToIds.end() && !nameIt->second.empty())
+      {
+        m_mappedByName++;
+        return nameIt->second;
+      }
+    }
+    return {};
+  }
+
+  const xtream::StreamTable& m_streams;
+  xtream::EpgMatchTable* m_matches;
+  std::unordered_set<int> m_streamIds;
+  std::unordered_map<std::string, std::vector<int>> m_streamNameToIds;
+  std::unordered_map<std::string, std::vector<int>> m_xmltvIdToStreamIds;
+  std::unordered_set<int> m_claimed; // streams some XMLTV channel already maps to
+  xtream::EpgNameIndex m_nameIndex;
+  bool m_nameIndexBuilt = false;
+  int m_totalXmltvChannels = 0;
+  int m_mappedByNumericId = 0;
+  int m_mappedByEpgId = 0;
+  int m_mappedByName = 0;
+  int m_mappedByKey = 0;
+  int m_mappedByRemembered = 0;
+  int m_mappedByFuzzy = 0;
+  int m_unmapped = 0;
+};
+
+// Feeds XMLTV channels and programmes to an EpgStoreBuilder. With a resolver, declared
+// channels are held until ResolveChannels (or the first programme) maps them all in two
+// steps, as MapXMLTV does, so no inexact match depends on document order; unmapped ones
+// are skipped. Without one (collect mode) every channel is kept and recorded so the
+// mapping can run later. Shared by the DOM and streaming front-ends so both produce
+// identical results.
+class XmltvMapper
+{
+public:
+  XmltvMapper(xtream::EpgStoreBuilder& builder, StreamResolver* resolver,
+              std::vector<xtream::XmltvGuideChannel>* collected,
+              const xtream::XmltvParseOptions& options)
+    : m_builder(builder), m_resolver(resolver), m_collected(collected),
+      m_notBefore(options.notBefore), m_notAfter(options.notAfter)
+  {
+    if (!options.lazyTextPath.empty() && !m_builder.EnableLazyText(options.lazyTextPath))
+      kodi::Log(ADDON_LOG_WARNING, "pvr.dispatcharr: can't write %s, keeping EPG text in memory",
+                options.lazyTextPath.c_str());
+  }
+
+  bool HasHorizon() const { return m_notBefore != 0 || m_notAfter != 0; }
+
+  bool InHorizon(time_t start, time_t end) const
+  {
+    return (m_notBefore == 0 || end > m_notBefore) && (m_notAfter == 0 || start < m_notAfter);
+  }
+
+  // True when the raw <programme> element is outside the horizon and can be dropped
+  // unparsed. AddProgramme makes the same decision for the rest. Const, so parallel
+  // parse workers can call it.
+  bool RawOutsideHorizon(const char* begin, size_t size) const
+  {
+    std::string_view start;
+    std::string_view stop;
+    time_t startTime = 0;
+    time_t endTime = 0;
+    if (!PeekRawAttribute(begin, size, "start", start) || !PeekRawAttribute(begin, size, "stop", stop) ||
+        !xtream::ParseXmltvTime(start, startTime) || !xtream::ParseXmltvTime(stop, endTime))
+      return false;
+    return !InHorizon(startTime, endTime);
+  }
+
+  // Streaming fast path for RawOutsideHorizon, counting what it drops.
+  bool SkipRawProgramme(const char* begin, size_t size)
+  {
+    if (!RawOutsideHorizon(begin, size))
+      return false;
+    ++m_outOfHorizon;
+    return true;
+  }
+
+  void CountOutOfHorizon(size_t count) { m_outOfHorizon += count; }
+  size_t OutOfHorizon() const { return m_outOfHorizon; }
+
+  void AddChannel(const pugi::xml_node& channelNode)
+  {
+    const char* idAttr = channelNode.attribute("id").value();
+    if (!idAttr || idAttr[0] == '\0')
+      return;
+
+    const std::string xmltvId = idAttr;
+    m_lastXmltvId.clear();
+
+    // Get display name
+    const auto& displayNameNode = channelNode.child("display-name");
+    std::string displayNameNormalized;
+    if (displayNameNode)
+      displayNameNormalized = NormalizeChannelNameForEpg(displayNameNode.child_value());
+
+    if (m_resolver && !m_resolved)
+    {
+      m_pending.push_back({xmltvId, displayNameNormalized});
+      return;
+    }
+    m_xmltvIdToChannel[xmltvId] = OpenChannel(xmltvId, displayNameNormalized, true);
+  }
+
+  // Maps the channels declared so far: every exact match claims its streams before any
+  // inexact tier runs. Channels declared later (after programmes) resolve as they
+  // arrive. Call before parallel workers read the map.
+  void ResolveChannels()
+  {
+    if (!m_resolver || m_resolved)
+      return;
+    m_resolved = true;
+
+    std::vector<std::vector<int>> ids(m_pending.size());
+    for (size_t i = 0; i < m_pending.size(); ++i)
+      ids[i] = m_resolver->ResolveExact(m_pending[i].id, m_pending[i].displayName, true);
+    for (size_t i = 0; i < m_pending.size(); ++i)
+    {
+      if (ids[i].empty())
+        ids[i] = m_resolver->ResolveInexact(m_pending[i].id, m_pending[i].displayName, true);
+    }
+    // Builder channels open in document order; a repeated id keeps its last declaration.
+    for (size_t i = 0; i < m_pending.size(); ++i)
+      m_xmltvIdToChannel[m_pending[i].id] = MapChannel(ids[i]);
+    std::vector<PendingChannel>().swap(m_pending);
+  }
+
+  void AddProgramme(const pugi::xml_node& programmeNode)
+  {
+    const char* channelAttr = programmeNode.attribute("channel").value();
+    if (!channelAttr || channelAttr[0] == '\0')
+      return;
+
+    xtream::EpgProgramme programme;
+
+    // Parse start and stop times (format: YYYYMMDDHHmmss +TZ)
+    xtream::ParseXmltvTime(programmeNode.attribute("start").value(), programme.startTime);
+    xtream::ParseXmltvTime(programmeNode.attribute("stop").value(), programme.endTime);
+
+    // Checked before the channel lookup so a programme dropped here costs the same as
+    // one SkipRawProgramme dropped.
+    if (HasHorizon() && !InHorizon(programme.startTime, programme.endTime))
+    {
+      ++m_outOfHorizon;
+      return;
+    }
+
+    if (!SelectChannel(channelAttr) || !ValidTimes(programme))
+      return;
+
+    // Text fields point into the parser buffer; the builder copies them into its arena.
+    ReadProgrammeText(programmeNode, programme);
+
+    // Stored once per XMLTV channel; every mapped stream shares the list.
+    m_builder.AddProgramme(m_lastChannel, programme);
+  }
+
+  // AddProgramme for a programme a parallel parse worker has already read and checked
+  // against the horizon.
+  void AddParsedProgramme(std::string_view channelId, const xtream::EpgProgramme& programme)
+  {
+    if (!SelectChannel(channelId) || !ValidTimes(programme))
+      return;
+    m_builder.AddProgramme(m_lastChannel, programme);
+  }
+
+  // Read-only lookup for parallel parse workers: false only for a channel already known
+  // to map nowhere, whose programmes can be dropped without reading them.
+  bool MayMap(std::string_view channelId) const
+  {
+    const auto it = m_xmltvIdToChannel.find(std::string(channelId));
+    return it == m_xmltvIdToChannel.end() || it->second != kUnmapped;
+  }
+
+  static bool ValidTimes(const xtream::EpgProgramme& programme)
+  {
+    return programme.startTime != 0 && programme.endTime != 0 && programme.endTime > programme.startTime;
+  }
+
+  static void ReadProgrammeText(const pugi::xml_node& programmeNode, xtream::EpgProgramme& programme)
+  {
+    const auto& titleNode = programmeNode.child("title");
+    if (titleNode)
+      programme.title = titleNode.child_value();
+
+    const auto& descNode = programmeNode.child("desc");
+    if (descNode)
+      programme.description = descNode.child_value();
+
+    // Sub-title (episode name)
+    const auto& subTitleNode = programmeNode.child("sub-title");
+    if (subTitleNode)
+      programme.episodeName = subTitleNode.child_value();
+
+    const auto& iconNode = programmeNode.child("icon");
+    if (iconNode)
+      programme.iconPath = iconNode.attribute("src").value();
+
+    // Category (genre)
+    const auto& categoryNode = programmeNode.child("category");
+    if (categoryNode)
+      programme.genreString = categoryNode.child_value();
+  }
+
+  void LogChannelMapping() const
+  {
+    if (m_resolver)
+      m_resolver->LogChannelMapping();
+  }
+
+private:
+  static constexpr uint32_t kUnmapped = UINT32_MAX;
+
+  using ChannelMap = std::unordered_map<std::string, uint32_t>;
+
+  struct PendingChannel
+  {
+    std::string id;
+    std::string displayName;
+  };
+
+  // Makes `channelId` the current channel, opening it on first sight. Programmes are
+  // normally grouped by channel, so the previous lookup usually hits. Returns false
+  // when the channel maps nowhere.
+  bool SelectChannel(std::string_view channelId)
+  {
+    ResolveChannels();
+    if (m_lastXmltvId != channelId)
+    {
+      m_lastXmltvId.assign(channelId.data(), channelId.size());
+      auto mapIt = m_xmltvIdToChannel.find(m_lastXmltvId);
+      if (mapIt == m_xmltvIdToChannel.end())
+      {
+        // A programme can reference a channel that was never declared (or, when
+        // streaming, not declared yet). Map it by id alone; there is no display name.
+        mapIt = m_xmltvIdToChannel.emplace(m_lastXmltvId, OpenChannel(m_lastXmltvId, std::string(), false))
+                    .first;
+      }
+      m_lastChannel = mapIt->second;
+    }
+    return m_lastChannel != kUnmapped;
+  }
+
+  uint32_t OpenChannel(const std::string& xmltvId, const std::string& displayNameNormalized, bool declared)
+  {
+    if (!m_resolver)
+    {
+      const uint32_t channel = m_builder.AddChannel();
+      m_collected->push_back({xmltvId, displayNameNormalized, channel, declared});
+      return channel;
+    }
+
+    // Map XMLTV channel ID or display-name to stream ID for Kodi EPG lookup
+    return MapChannel(m_resolver->Resolve(xmltvId, displayNameNormalized, declared));
+  }
+
+  uint32_t MapChannel(const std::vector<int>& streamIds)
+  {
+    // Programmes of unmapped channels can never be shown; skip them while parsing.
+    if (streamIds.empty())
+      return kUnmapped;
+    const uint32_t channel = m_builder.AddChannel();
+    for (int streamId : streamIds)
+      m_builder.MapStream(streamId, channel);
+    return channel;
+  }
+
+  xtream::EpgStoreBuilder& m_builder;
+  StreamResolver* m_resolver;
+  std::vector<xtream::XmltvGuideChannel>* m_collected;
+  std::vector<PendingChannel> m_pending; // declared, not yet resolved
+  bool m_resolved = false;
+  ChannelMap m_xmltvIdToChannel; // XMLTV channel id -> builder channel (or kUnmapped)
+  std::string m_lastXmltvId;
+  uint32_t m_lastChannel = kUnmapped;
+  time_t m_notBefore = 0;
+  time_t m_notAfter = 0;
+  size_t m_outOfHorizon = 0;
+};
+
+bool FinishStore(xtream::EpgStoreBuilder& builder, xtream::EpgStore& epgStore)
+{
+  const size_t parsed = builder.ProgrammeCount();
+  epgStore = builder.Build();
+
+  kodi::Log(ADDON_LOG_INFO,
+            "pvr.dispatcharr: Parsed XMLTV - %d channels, %d programmes (%zu stored, %zu text bytes, "
+            "%zu on disk)",
+            static_cast<int>(epgStore.ChannelCount()), static_cast<int>(parsed),
+            epgStore.ProgrammeCount(), epgStore.ArenaBytes(), epgStore.LazyTextBytes());
+
+  return epgStore.ChannelCount() > 0;
+}
+
+bool StartsWith(const std::string& s, size_t pos, std::string_view prefix)
+{
+  return s.size() - pos >= prefix.size() && s.compare(pos, prefix.size(), prefix) == 0;
+}
+
+// Cuts complete top-level <channel>/<programme> elements out of a byte stream.
+// Everything else (prolog, comments, the <tv> wrapper) is skipped without buffering.
+class XmltvElementSplitter
+{
+public:
+  enum class Kind
+  {
+    Channel,
+    Programme
+  };
+
+  // Appends bytes and invokes fn(kind, begin, size) for every element completed by them.
+  // The element bytes are mutable and only valid during the callback.
+  template<typename Fn>
+  bool Feed(const char* data, size_t size, Fn&& fn)
+  {
+    m_buf.append(data, size);
+    m_peakBytes = std::max(m_peakBytes, m_buf.size());
+
+    while (true)
+    {
+      const size_t lt = m_buf.find('<', m_pos);
+      if (lt == std::string::npos)
+      {
+        m_pos = m_buf.size();
+        break;
+      }
+      m_pos = lt;
+      if (m_buf.size() - lt < 2)
+        break;
+
+      const char c = m_buf[lt + 1];
+      if (c == '!' || c == '?')
+      {
+        const std::string_view terminator = StartsWith(m_buf, lt, "<!--")        ? "-->"
+                                            : StartsWith(m_buf, lt, "<![CDATA[") ? "]]>"
+                                            : (c == '?')                         ? "?>"
+                                                                                 : ">";
+        const size_t end = m_buf.find(terminator.data(), lt + 2, terminator.size());
+        if (end == std::string::npos)
+          break;
+        // Pick up the declared encoding so fragments decode the same way a full parse would.
+        if (c == '?' && StartsWith(m_buf, lt, "<?xml"))
+          DetectEncoding(std::string_view(m_buf).substr(lt, end - lt));
+        m_pos = end + terminator.size();
+        continue;
+      }
+
+      const size_t tagEnd = FindTagEnd(lt);
+      if (tagEnd == std::string::npos)
+      {
+        if (m_buf.size() - lt > kMaxElementBytes)
+          return false;
+        break;
+      }
+
+      size_t nameEnd = lt + 1;
+      while (nameEnd < tagEnd && !std::isspace(static_cast<unsigned char>(m_buf[nameEnd])) &&
+             m_buf[nameEnd] != '/' && m_buf[nameEnd] != '>')
+        ++nameEnd;
+      const std::string_view name(m_buf.data() + lt + 1, nameEnd - lt - 1);
+
+      Kind kind;
+      if (name == "channel")
+        kind = Kind::Channel;
+      else if (name == "programme")
+        kind = Kind::Programme;
+      else
+      {
+        if (name == "tv")
+          m_sawRoot = true;
+        m_pos = tagEnd + 1;
+        continue;
+      }
+
+      size_t elemEnd = tagEnd + 1;
+      if (m_buf[tagEnd - 1] != '/')
+      {
+        const std::string_view closing = (kind == Kind::Channel) ? "</channel>" : "</programme>";
+        const size_t closePos = m_buf.find(closing.data(), tagEnd + 1, closing.size());
+        if (closePos == std::string::npos)
+        {
+          if (m_buf.size() - lt > kMaxElementBytes)
+            return false;
+          break;
+        }
+        elemEnd = closePos + closing.size();
+      }
+
+      fn(kind, &m_buf[lt], elemEnd - lt);
+      m_pos = elemEnd;
+    }
+
+    // Drop consumed bytes once enough have built up to make the move worthwhile.
+    if (m_pos == m_buf.size())
+    {
+      m_buf.clear();
+      m_pos = 0;
+    }
+    else if (m_pos >= kCompactThresholdBytes)
+    {
+      m_buf.erase(0, m_pos);
+      m_pos = 0;
+    }
+    return true;
+  }
+
+  bool SawRoot() const { return m_sawRoot; }
+  size_t PeakBytes() const { return m_peakBytes; }
+  pugi::xml_encoding Encoding() const { return m_encoding; }
+  // For a splitter that starts mid-document, after the prolog another one has seen.
+  void SetEncoding(pugi::xml_encoding encoding) { m_encoding = encoding; }
+
+private:
+  // Returns the index of the '>' closing the tag that starts at `lt`, skipping quoted
+  // attribute values, or npos when the tag is not complete yet.
+  size_t FindTagEnd(size_t lt) const
+  {
+    char quote = 0;
+    for (size_t i = lt + 1; i < m_buf.size(); ++i)
+    {
+      const char ch = m_buf[i];
+      if (quote)
+      {
+        if (ch == quote)
+          quote = 0;
+        continue;
+      }
+      if (ch == '"' || ch == '\'')
+        quote = ch;
+      else if (ch == '>')
+        return i;
+    }
+    return std::string::npos;
+  }
+
+  void DetectEncoding(std::string_view decl)
+  {
+    const size_t pos = decl.find("encoding=");
+    if (pos == std::string_view::npos || pos + 10 >= decl.size())
+      return;
+    const char quote = decl[pos + 9];
+    const size_t end = decl.find(quote, pos + 10);
+    if (end == std::string_view::npos)
+      return;
+    const std::string enc = ToLower(std::string(decl.substr(pos + 10, end - pos - 10)));
+    if (enc == "iso-8859-1" || enc == "latin1" || enc == "latin-1")
+      m_encoding = pugi::encoding_latin1;
+  }
+
+  std::string m_buf;
+  size_t m_pos = 0;
+  size_t m_peakBytes = 0;
+  bool m_sawRoot = false;
+  pugi::xml_encoding m_encoding = pugi::encoding_auto;
+};
+
+// Splits the byte stream into elements and hands them to the mapper.
+bool XmltvStreamParse(const xtream::XmltvReadFn& read, XmltvMapper& mapper)
+{
+  XmltvElementSplitter splitter;
+  pugi::xml_document fragment;
+  bool loggedMapping = false;
+  int malformed = 0;
+  uint64_t totalBytes = 0;
+
+  const bool horizon = mapper.HasHorizon();
+  auto onElement = [&](XmltvElementSplitter::Kind kind, char* begin, size_t size) {
+    if (horizon && kind == XmltvElementSplitter::Kind::Programme && mapper.SkipRawProgramme(begin, size))
+      return;
+    const pugi::xml_parse_result result =
+        fragment.load_buffer_inplace(begin, size, pugi::parse_default, splitter.Encoding());
+    if (!result)
+    {
+      ++malformed;
+      return;
+    }
+    const pugi::xml_node node = fragment.document_element();
+    if (kind == XmltvElementSplitter::Kind::Channel)
+    {
+      mapper.AddChannel(node);
+      return;
+    }
+    // XMLTV declares all channels before the first programme.
+    if (!loggedMapping)
+    {
+      mapper.ResolveChannels();
+      mapper.LogChannelMapping();
+      loggedMapping = true;
+    }
+    mapper.AddProgramme(node);
+  };
+
+  std::vector<char> chunk(kReadChunkBytes);
+  while (true)
+  {
+    const int64_t n = read(chunk.data(), chunk.size());
+    if (n < 0)
+    {
+      kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: XMLTV read failed after %llu bytes",
+                static_cast<unsigned long long>(totalBytes));
+      return false;
+    }
+    if (n == 0)
+      break;
+    totalBytes += static_cast<uint64_t>(n);
+    if (!splitter.Feed(chunk.data(), static_cast<size_t>(n), onElement))
+    {
+      kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: XMLTV element exceeded %zu bytes at offset %llu",
+                kMaxElementBytes, static_cast<unsigned long long>(totalBytes));
+      return false;
+    }
+  }
+
+  if (!splitter.SawRoot())
+  {
+    kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: XMLTV missing <tv> root element");
+    return false;
+  }
+
+  if (!loggedMapping)
+  {
+    mapper.ResolveChannels();
+    mapper.LogChannelMapping();
+  }
+  if (malformed > 0)
+    kodi::Log(ADDON_LOG_WARNING, "pvr.dispatcharr: skipped %d malformed XMLTV elements", malformed);
+  if (mapper.OutOfHorizon() > 0)
+    kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: skipped %zu programmes outside the EPG horizon",
+              mapper.OutOfHorizon());
+  kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: streamed %llu XMLTV bytes, peak buffer %zu bytes",
+            static_cast<unsigned long long>(totalBytes), splitter.PeakBytes());
+  return true;
+}
+
+// One slice of the <programme> region, parsed by a worker. Text is copied into the
+// chunk's own buffer so the merge can hand it to the builder after the fragment DOMs
+// are gone.
+struct ProgrammeChunk
+{
+  struct Entry
+  {
+    xtream::EpgStrRef channel;
+    xtream::EpgStrRef title;
+    xtream::EpgStrRef description;
+    xtream::EpgStrRef episodeName;
+    xtream::EpgStrRef iconPath;
+    xtream::EpgStrRef genreString;
+    time_t startTime = 0;
+    time_t endTime = 0;
+  };
+
+  size_t begin = 0;
+  size_t end = 0;
+  std::string text;
+  std::vector<Entry> entries;
+  size_t outOfHorizon = 0;
+  int malformed = 0;
+  bool sawChannel = false;
+  bool ok = true;
+
+  xtream::EpgStrRef Append(std::string_view s)
+  {
+    xtream::EpgStrRef ref;
+    ref.offset = static_cast<uint32_t>(text.size());
+    ref.length = static_cast<uint32_t>(s.size());
+    text.append(s.data(), s.size());
+    return ref;
+  }
+
+  std::string_view Text(const xtream::EpgStrRef& ref) const
+  {
+    return std::string_view(text).substr(ref.offset, ref.length);
+  }
+};
+
+// Returns the offset of the first "<programme" start tag at or after `from`, or npos.
+size_t FindProgrammeStart(std::string_view data, size_t from)
+{
+  constexpr std::string_view kTag = "<programme";
+  for (size_t pos = data.find(kTag, from); pos != std::string_view::npos; pos = data.find(kTag, pos + 1))
+  {
+    const size_t next = pos + kTag.size();
+    if (next < data.size() && (std::isspace(static_cast<unsigned char>(data[next])) || data[next] == '>' ||
+                               data[next] == '/'))
+      return pos;
+  }
+  return std::string_view::npos;
+}
+
+// Parses the programmes of data[chunk.begin, chunk.end). The mapper is only read.
+void ParseProgrammeChunk(std::string_view data,
+                         pugi::xml_encoding encoding,
+                         const XmltvMapper& mapper,
+                         ProgrammeChunk& chunk)
+{
+  XmltvElementSplitter splitter;
+  splitter.SetEncoding(encoding);
+  pugi::xml_document fragment;
+  const bool horizon = mapper.HasHorizon();
+  std::string lastChannel;
+  bool lastMayMap = true;
+
+  auto onElement = [&](XmltvElementSplitter::Kind kind, char* begin, size_t size) {
+    if (kind == XmltvElementSplitter::Kind::Channel)
+    {
+      chunk.sawChannel = true;
+      return;
+    }
+    if (horizon && mapper.RawOutsideHorizon(begin, size))
+    {
+      ++chunk.outOfHorizon;
+      return;
+    }
+    if (!fragment.load_buffer_inplace(begin, size, pugi::parse_default, encoding))
+    {
+      ++chunk.malformed;
+      return;
+    }
+    const pugi::xml_node node = fragment.document_element();
+    const char* channelAttr = node.attribute("channel").value();
+    if (!channelAttr || channelAttr[0] == '\0')
+      return;
+
+    xtream::EpgProgramme programme;
+    xtream::ParseXmltvTime(node.attribute("start").value(), programme.startTime);
+    xtream::ParseXmltvTime(node.attribute("stop").value(), programme.endTime);
+    if (horizon && !mapper.InHorizon(programme.startTime, programme.endTime))
+    {
+      ++chunk.outOfHorizon;
+      return;
+    }
+    if (lastChannel != channelAttr)
+    {
+      lastChannel = channelAttr;
+      lastMayMap = mapper.MayMap(lastChannel);
+    }
+    if (!lastMayMap)
+      return;
+
+    ProgrammeChunk::Entry entry;
+    entry.channel = chunk.Append(lastChannel);
+    entry.startTime = programme.startTime;
+    entry.endTime = programme.endTime;
+    // The merge still sees programmes with bad times (an undeclared channel is opened
+    // before they are dropped), but their text is never used.
+    if (XmltvMapper::ValidTimes(programme))
+    {
+      XmltvMapper::ReadProgrammeText(node, programme);
+      entry.title = chunk.Append(programme.title);
+      entry.description = chunk.Append(programme.description);
+      entry.episodeName = chunk.Append(programme.episodeName);
+      entry.iconPath = chunk.Append(programme.iconPath);
+      entry.genreString = chunk.Append(programme.genreString);
+    }
+    chunk.entries.push_back(entry);
+  };
+
+  for (size_t pos = chunk.begin; pos < chunk.end && chunk.ok;)
+  {
+    const size_t n = std::min(kReadChunkBytes, chunk.end - pos);
+    chunk.ok = splitter.Feed(data.data() + pos, n, onElement);
+    pos += n;
+  }
+}
+
+// Parses an in-memory document on up to `threads` threads: the prolog and <channel>
+// elements first, on this thread, so the channel map is complete; then the <programme>
+// region, cut at element boundaries into chunks that workers parse against the now
+// read-only map; then a merge in document order, so the result matches a sequential
+// parse. Sets `fallback` and returns false when the document doesn't suit the split
+// (no programmes, or <channel> elements after the first programme).
+bool ParseXmltvParallel(const std::string& xmltvData, XmltvMapper& mapper, unsigned threads, bool& fallback)
+{
+  fallback = false;
+  const std::string_view data(xmltvData);
+  const size_t first = FindProgrammeStart(data, 0);
+  if (first == std::string_view::npos)
+  {
+    fallback = true;
+    return false;
+  }
+
+  XmltvElementSplitter head;
+  pugi::xml_document fragment;
+  int malformed = 0;
+  auto onChannel = [&](XmltvElementSplitter::Kind kind, char* begin, size_t size) {
+    if (kind != XmltvElementSplitter::Kind::Channel)
+      return;
+    if (!fragment.load_buffer_inplace(begin, size, pugi::parse_default, head.Encoding()))
+    {
+      ++malformed;
+      return;
+    }
+    mapper.AddChannel(fragment.document_element());
+  };
+  for (size_t pos = 0; pos < first;)
+  {
+    const size_t n = std::min(kReadChunkBytes, first - pos);
+    if (!head.Feed(data.data() + pos, n, onChannel))
+    {
+      kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: XMLTV element exceeded %zu bytes", kMaxElementBytes);
+      return false;
+    }
+    pos += n;
+  }
+  if (!head.SawRoot())
+  {
+    kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: XMLTV missing <tv> root element");
+    return false;
+  }
+  mapper.ResolveChannels();
+
+  // Cut just after a "</programme>", so every chunk starts between elements.
+  const size_t region = data.size() - first;
+  const size_t chunkCount = std::max<size_t>(
+      1, std::min<size_t>(static_cast<size_t>(threads) * kChunksPerThread, region / kMinParallelChunkBytes));
+  std::vector<ProgrammeChunk> chunks;
+  chunks.reserve(chunkCount);
+  size_t begin = first;
+  for (size_t i = 1; i <= chunkCount && begin < data.size(); ++i)
+  {
+    size_t end = data.size();
+    if (i < chunkCount)
+    {
+      constexpr std::string_view kClose = "</programme>";
+      const size_t close = data.find(kClose, first + region / chunkCount * i);
+      if (close != std::string_view::npos)
+        end = std::max(begin, close + kClose.size());
+    }
+    chunks.emplace_back();
+    chunks.back().begin = begin;
+    chunks.back().end = end;
+    begin = end;
+  }
+
+  const pugi::xml_encoding encoding = head.Encoding();
+  const XmltvMapper& readOnly = mapper;
+  std::atomic<size_t> next{0};
+  auto work = [&]() {
+    for (size_t i = next.fetch_add(1); i < chunks.size(); i = next.fetch_add(1))
+      ParseProgrammeChunk(data, encoding, readOnly, chunks[i]);
+  };
+  const size_t workers = std::min(chunks.size(), static_cast<size_t>(threads));
+  std::vector<std::thread> pool;
+  pool.reserve(workers - 1);
+  for (size_t t = 1; t < workers; ++t)
+    pool.emplace_back(work);
+  work();
+  for (auto& t : pool)
+    t.join();
+
+  for (const auto& chunk : chunks)
+  {
+    if (!chunk.ok)
+    {
+      kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: XMLTV element exceeded %zu bytes at offset %zu",
+                kMaxElementBytes, chunk.begin);
+      return false;
+    }
+    if (chunk.sawChannel)
+    {
+      kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: XMLTV declares channels after programmes, parsing sequentially");
+      fallback = true;
+      return false;
+    }
+  }
+
+  mapper.LogChannelMapping();
+  size_t programmes = 0;
+  for (auto& chunk : chunks)
+  {
+    for (const auto& entry : chunk.entries)
+    {
+      xtream::EpgProgramme programme;
+      programme.startTime = entry.startTime;
+      programme.endTime = entry.endTime;
+      programme.title = chunk.Text(entry.title);
+      programme.description = chunk.Text(entry.description);
+      programme.episodeName = chunk.Text(entry.episodeName);
+      programme.iconPath = chunk.Text(entry.iconPath);
+      programme.genreString = chunk.Text(entry.genreString);
+      mapper.AddParsedProgramme(chunk.Text(entry.channel), programme);
+    }
+    programmes += chunk.entries.size();
+    mapper.CountOutOfHorizon(chunk.outOfHorizon);
+    malformed += chunk.malformed;
+    // Release each chunk as soon as the builder has its copy.
+    std::string().swap(chunk.text);
+    std::vector<ProgrammeChunk::Entry>().swap(chunk.entries);
+  }
+
+  if (malformed > 0)
+    kodi::Log(ADDON_LOG_WARNING, "pvr.dispatcharr: skipped %d malformed XMLTV elements", malformed);
+  if (mapper.OutOfHorizon() > 0)
+    kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: skipped %zu programmes outside the EPG horizon",
+              mapper.OutOfHorizon());
+  kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: parsed %zu XMLTV programmes in %zu chunks on %zu threads",
+            programmes, chunks.size(), workers);
+  return true;
+}
+} // namespace
+
+namespace xtream
+{
+bool ParseXMLTV(const std::string& xmltvData,
+                const StreamTable& streams,
+                EpgStore& epgStore,
+                const XmltvParseOptions& options)
+{
+  epgStore = EpgStore();
+
+  if (xmltvData.empty())
+    return false;
+
+  if (options.threads > 1 && xmltvData.size() >= 2 * kMinParallelChunkBytes)
+  {
+    StreamResolver resolver(streams, options.matches);
+    EpgStoreBuilder builder;
+    XmltvMapper mapper(builder, &resolver, nullptr, options);
+    bool fallback = false;
+    if (ParseXmltvParallel(xmltvData, mapper, options.threads, fallback))
+    {
+      resolver.FinishPass();
+      return FinishStore(builder, epgStore);
+    }
+    if (!fallback)
+      return false;
+  }
+
+  // Parse XML
+  pugi::xml_document doc;
+  std::vector<char> xmlBuffer(xmltvData.begin(), xmltvData.end());
+  xmlBuffer.push_back('\0');
+  pugi::xml_parse_result result = doc.load_buffer_inplace(
+      xmlBuffer.data(),
+      xmlBuffer.size() - 1,
+      pugi::parse_default | pugi::parse_declaration);
+
+  if (!result)
+  {
+    kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: Failed to parse XMLTV: %s (offset: %d)",
+              result.description(), static_cast<int>(result.offset));
+    return false;
+  }
+
+  const auto& tvNode = doc.child("tv");
+  if (!tvNode)
+  {
+    kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: XMLTV missing <tv> root element");
+    return false;
+  }
+
+  StreamResolver resolver(streams, options.matches);
+  xtream::EpgStoreBuilder builder;
+  XmltvMapper mapper(builder, &resolver, nullptr, options);
+
+  // First pass: Parse channel elements and match to our streams
+  for (const auto& channelNode : tvNode.children("channel"))
+    mapper.AddChannel(channelNode);
+  mapper.ResolveChannels();
+
+  mapper.LogChannelMapping();
+  resolver.FinishPass();
+
+  // Second pass: Parse programme elements
+  for (const auto& programmeNode : tvNode.children("programme"))
+    mapper.AddProgramme(programmeNode);
+  if (mapper.OutOfHorizon() > 0)
+    kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: skipped %zu programmes outside the EPG horizon",
+              mapper.OutOfHorizon());
+
+  return FinishStore(builder, epgStore);
+}
+
+bool ParseXMLTVStream(const XmltvReadFn& read,
+                      const StreamTable& streams,
+                      EpgStore& epgStore,
+                      const XmltvParseOptions& options)
+{
+  epgStore = EpgStore();
+
+  StreamResolver resolver(streams, options.matches);
+  EpgStoreBuilder builder;
+  XmltvMapper mapper(builder, &resolver, nullptr, options);
+  if (!XmltvStreamParse(read, mapper))
+    return false;
+  resolver.FinishPass();
+  return FinishStore(builder, epgStore);
+}
+
+bool ParseXMLTVStream(const XmltvReadFn& read, XmltvGuide& guide, const XmltvParseOptions& options)
+{
+  guide = XmltvGuide();
+
+  XmltvMapper mapper(guide.builder, nullptr, &guide.channels, options);
+  if (!XmltvStreamParse(read, mapper))
+    return false;
+  kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: collected %zu XMLTV channels, %zu programmes for mapping",
+            guide.channels.size(), guide.builder.ProgrammeCount());
+  return true;
+}
+
+bool MapXMLTV(XmltvGuide& guide, const StreamTable& streams, EpgStore& epgStore, EpgMatchTable* matches)
+{
+  epgStore = EpgStore();
+
+  // Every exact match claims its streams before any inexact tier runs.
+  StreamResolver resolver(streams, matches);
+  std::vector<const XmltvGuideChannel*> inexact;
+  for (const auto& ch : guide.channels)
+  {
+    const std::vector<int> ids = resolver.ResolveExact(ch.id, ch.displayName, ch.declared);
+    if (ids.empty())
+      inexact.push_back(&ch);
+    for (int streamId : ids)
+      guide.builder.MapStream(streamId, ch.channel);
+  }
+  for (const XmltvGuideChannel* ch : inexact)
+  {
+    for (int streamId : resolver.ResolveInexact(ch->id, ch->displayName, ch->declared))
+      guide.builder.MapStream(streamId, ch->channel);
+  }
+  resolver.FinishPass();
+  resolver.LogChannelMapping();
+
+  const bool ok = FinishStore(guide.builder, epgStore);
+  guide = XmltvGuide();
+  return ok;
+}
+} // namespace xtream
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "epg_store.h"
+#include "stream_table.h"
+#include "xtream_client.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace xtream
+{
+// Pull-style byte source for the streaming parser: fill up to `size` bytes into `buf`
+// and return the count, 0 at end of stream, or a negative value on a read error.
+using XmltvReadFn = std::function<int64_t(char* buf, size_t size)>;
+
+class EpgMatchTable;
+
+// What to keep while parsing. Programmes outside [notBefore, notAfter) are dropped
+// before any of their text is read; 0 leaves that side open. With lazyTextPath set,
+// descriptions and icons go to that file instead of memory (EpgStoreBuilder::EnableLazyText).
+// `threads` > 1 lets ParseXMLTV split the programmes of a large document across that
+// many threads; the streaming parsers keep to the download thread. `matches`, when
+// set, remembers fuzzy channel-name matches across parses (see EpgMatchTable).
+struct XmltvParseOptions
+{
+  time_t notBefore = 0;
+  time_t notAfter = 0;
+  std::string lazyTextPath;
+  unsigned threads = 1;
+  EpgMatchTable* matches = nullptr;
+};
+
+// Both parsers map XMLTV channels onto `streams` and replace `epgStore` with the result.
+// They return false on a parse error or when no programme could be mapped.
+
+// Whole-document parse (pugixml DOM). The body, a working copy and the DOM are all
+// resident at once, so prefer ParseXMLTVStream for large guides.
+bool ParseXMLTV(const std::string& xmltvData,
+                const StreamTable& streams,
+                EpgStore& epgStore,
+                const XmltvParseOptions& options = XmltvParseOptions());
+
+// Streaming parse: top-level <channel>/<programme> elements are cut out of the byte
+// stream and parsed one at a time as data arrives, so peak memory is bounded by the
+// largest single element rather than by the document.
+bool ParseXMLTVStream(const XmltvReadFn& read,
+                      const StreamTable& streams,
+                      EpgStore& epgStore,
+                      const XmltvParseOptions& options = XmltvParseOptions());
+
+// An XMLTV channel as seen by the parser, before it is matched to any stream.
+struct XmltvGuideChannel
+{
+  std::string id;
+  std::string displayName; // normalised; empty for ids only seen on programmes
+  uint32_t channel = 0;    // programme list handle in XmltvGuide::builder
+  bool declared = true;    // false when no <channel> element named it
+};
+
+// A guide parsed without a stream list. Every channel's programmes are kept, so the
+// download and parse can run before the streams are known and MapXMLTV attaches them
+// afterwards. Unmapped channels cost memory only until the mapping.
+struct XmltvGuide
+{
+  EpgStoreBuilder builder;
+  std::vector<XmltvGuideChannel> channels;
+};
+
+// Streaming parse into `guide` (no mapping). Returns false on a read or parse error.
+bool ParseXMLTVStream(const XmltvReadFn& read,
+                      XmltvGuide& guide,
+                      const XmltvParseOptions& options = XmltvParseOptions());
+
+// Maps a collected guide onto `streams` as the one-step parsers would, builds
+// `epgStore` from it and empties `guide`. Since every channel is known up front, all
+// exact matches claim their streams before the name-key and fuzzy tiers run, so an
+// inexact match never lands on a stream that has an exact one elsewhere in the guide.
+// Returns false when no programme could be mapped.
+bool MapXMLTV(XmltvGuide& guide,
+              const StreamTable& streams,
+              EpgStore& epgStore,
+              EpgMatchTable* matches = nullptr);
+} // namespace xtream
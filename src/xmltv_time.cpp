@@ -0,0 +1,153 @@
+#include "xmltv_time.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace
+{
+// Days since 1970-01-01 in the proleptic Gregorian calendar (H. Hinnant's
+// days_from_civil). Linear in `day`, so out-of-range days roll over the way timegm
+// normalises them; `month` must be 1-12.
+int64_t DaysFromCivil(int64_t year, unsigned month, int64_t day)
+{
+  year -= month <= 2 ? 1 : 0;
+  const int64_t era = (year >= 0 ? year : year - 399) / 400;
+  const int64_t yoe = year - era * 400;
+  const int64_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+  const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + doe - 719468;
+}
+
+// UTC epoch seconds for the broken-down fields, normalised like timegm.
+int64_t EpochSeconds(int64_t year, int64_t month, int64_t day, int64_t hour, int64_t minute, int64_t second)
+{
+  // Bring the month into 1-12, carrying into the year; everything below is linear.
+  int64_t m0 = month - 1;
+  year += m0 >= 0 ? m0 / 12 : -((11 - m0) / 12);
+  m0 -= (m0 >= 0 ? m0 / 12 : -((11 - m0) / 12)) * 12;
+  const int64_t days = DaysFromCivil(year, static_cast<unsigned>(m0 + 1), day);
+  return ((days * 24 + hour) * 60 + minute) * 60 + second;
+}
+
+// Eight bytes in memory order, first byte lowest. Compilers turn this into one load.
+uint64_t Load64(const char* p)
+{
+  uint64_t v = 0;
+  for (int i = 7; i >= 0; --i)
+    v = (v << 8) | static_cast<unsigned char>(p[i]);
+  return v;
+}
+
+// Checks eight ASCII digits at once and folds each pair into a two-digit value, so
+// 16-bit lane k of the result holds digits 2k and 2k+1 as a number (0-99).
+bool DigitPairs8(const char* p, uint64_t& pairs)
+{
+  constexpr uint64_t kOnes = 0x0101010101010101ULL;
+  const uint64_t v = Load64(p);
+  const uint64_t below = v - 0x30 * kOnes; // high bit set in a byte below '0'
+  const uint64_t above = v + 0x46 * kOnes; // high bit set in a byte above '9'
+  if ((v | below | above) & (0x80 * kOnes))
+    return false;
+  const uint64_t d = below;
+  pairs = (d * 10 + (d >> 8)) & 0x00ff00ff00ff00ffULL;
+  return true;
+}
+
+unsigned Lane(uint64_t pairs, int k)
+{
+  return static_cast<unsigned>((pairs >> (16 * k)) & 0xff);
+}
+
+bool IsDigit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+bool IsSpace(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// The layout every real guide uses: 14 digits, optional whitespace, then either the
+// end or a sign and four digits. Returns false for anything else.
+bool ParseFixed(std::string_view s, time_t& out)
+{
+  if (s.size() < 14)
+    return false;
+
+  // YYYYMMDD from bytes 0-7 and DDHHmmss from bytes 6-13.
+  uint64_t date = 0;
+  uint64_t time = 0;
+  if (!DigitPairs8(s.data(), date) || !DigitPairs8(s.data() + 6, time))
+    return false;
+  const unsigned month = Lane(date, 2);
+  if (month < 1 || month > 12)
+    return false;
+
+  size_t pos = 14;
+  while (pos < s.size() && IsSpace(s[pos]))
+    ++pos;
+  int64_t offset = 0;
+  if (pos < s.size())
+  {
+    const char sign = s[pos];
+    if ((sign != '+' && sign != '-') || s.size() - pos < 5 || !IsDigit(s[pos + 1]) ||
+        !IsDigit(s[pos + 2]) || !IsDigit(s[pos + 3]) || !IsDigit(s[pos + 4]))
+      return false;
+    const int hours = (s[pos + 1] - '0') * 10 + (s[pos + 2] - '0');
+    const int minutes = (s[pos + 3] - '0') * 10 + (s[pos + 4] - '0');
+    offset = hours * 3600 + minutes * 60;
+    if (sign == '-')
+      offset = -offset;
+  }
+
+  const int64_t year = Lane(date, 0) * 100 + Lane(date, 1);
+  // "20:00 +0100" is 19:00 UTC: subtract the offset from the local wall time.
+  out = static_cast<time_t>(EpochSeconds(year, month, Lane(date, 3), Lane(time, 1), Lane(time, 2),
+                                         Lane(time, 3)) -
+                            offset);
+  return true;
+}
+
+// General path for unusual strings (missing digits, leading spaces, odd offsets):
+// sscanf splits the fields exactly as the parser always did.
+bool ParseScanned(const char* s, time_t& out)
+{
+  int year = 0, month = 0, day = 0, hour = 0, minute = 0, second = 0;
+  int tzHours = 0, tzMins = 0;
+  char tzSign = '+';
+  if (sscanf(s, "%4d%2d%2d%2d%2d%2d %c%2d%2d", &year, &month, &day, &hour, &minute, &second, &tzSign,
+             &tzHours, &tzMins) < 6)
+    return false;
+
+  int64_t offset = tzHours * 3600 + tzMins * 60;
+  if (tzSign == '-')
+    offset = -offset;
+  out = static_cast<time_t>(EpochSeconds(year, month, day, hour, minute, second) - offset);
+  return true;
+}
+} // namespace
+
+namespace xtream
+{
+bool ParseXmltvTime(std::string_view s, time_t& out)
+{
+  if (s.empty())
+    return false;
+  if (ParseFixed(s, out))
+    return true;
+  // sscanf needs a terminated string; views from the parser are short attribute values.
+  return ParseScanned(std::string(s).c_str(), out);
+}
+
+bool ParseXmltvTime(const char* s, time_t& out)
+{
+  if (!s || s[0] == '\0')
+    return false;
+  if (ParseFixed(std::string_view(s, std::strlen(s)), out))
+    return true;
+  return ParseScanned(s, out);
+}
+} // namespace xtream
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <ctime>
+#include <string_view>
+
+namespace xtream
+{
+// Parses an XMLTV timestamp ("YYYYMMDDHHmmss +HHMM", the offset optional) into epoch
+// seconds. The usual fixed layout is decoded directly; anything else goes through the
+// general sscanf path, which accepts the same strings the parser always has. Returns
+// false when fewer than the six date/time fields can be read.
+bool ParseXmltvTime(std::string_view s, time_t& out);
+bool ParseXmltvTime(const char* s, time_t& out);
+} // namespace xtream
@@ -1,10 +1,15 @@
 #include "xtream_client.h"
+#include "xmltv_parser.h"
+#include "gzip_stream.h"
+#include "perf_stats.h"
+#include "stream_json.h"
+#include "stream_table.h"
 
 #include <kodi/Filesystem.h>
 #include <kodi/General.h>
-#include <pugixml.hpp>
 
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <cstdint>
 #include <cstdio>
@@ -12,13 +17,14 @@
 #include <cstdlib>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <thread>
 #include <vector>
 
 namespace
 {
 constexpr const char* kDefaultAddonUserAgent = "DispatcharrKodiAddon";
 constexpr size_t kMaxHttpBodyBytes = 50 * 1024 * 1024; // cap responses to protect memory (XMLTV can be large)
+constexpr size_t kMaxIconBytes = 2 * 1024 * 1024;
 
 std::string Trim(std::string s)
 {
@@ -38,57 +44,6 @@ std::string ToLower(std::string s)
   return s;
 }
 
-std::string NormalizeChannelNameForEpg(const std::string& in)
-{
-  // Trim and collapse whitespace
-  std::string s = Trim(in);
-  if (s.empty())
-    return s;
-
-  // Decode a few common HTML entities
-  auto replace_all = [](std::string& t, const char* from, const char* to) {
-    const std::string a(from);
-    const std::string b(to);
-    size_t pos = 0;
-    while ((pos = t.find(a, pos)) != std::string::npos)
-    {
-      t.replace(pos, a.size(), b);
-      pos += b.size();
-    }
-  };
-  replace_all(s, "&amp;", "&");
-  replace_all(s, "&quot;", "\"");
-  replace_all(s, "&#039;", "'");
-  replace_all(s, "&lt;", "<");
-  replace_all(s, "&gt;", ">");
-
-  std::string collapsed;
-  collapsed.reserve(s.size());
-  bool prevSpace = false;
-  for (unsigned char ch : s)
-  {
-    if (std::isspace(ch))
-    {
-      if (!prevSpace)
-        collapsed.push_back(' ');
-      prevSpace = true;
-      continue;
-    }
-    prevSpace = false;
-    collapsed.push_back(static_cast<char>(ch));
-  }
-
-  collapsed = Trim(collapsed);
-
-  // Strip category prefix like "UK | Channel" -> "Channel"
-  const std::string sep = " | ";
-  const size_t pos = collapsed.rfind(sep);
-  if (pos != std::string::npos && pos + sep.size() < collapsed.size())
-    collapsed = Trim(collapsed.substr(pos + sep.size()));
-
-  return collapsed;
-}
-
 bool IsUnreserved(unsigned char c)
 {
   if ((c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9'))
@@ -176,6 +131,21 @@ std::string BuildPlayerApiUrlWithAction(const xtream::Settings& settings, const
   return base + "&action=" + UrlEncode(action);
 }
 
+std::string BuildXmltvUrl(const xtream::Settings& settings)
+{
+  const std::string custom = Trim(settings.xmltvUrl);
+  if (!custom.empty())
+    return custom;
+
+  const std::string base = BuildBaseUrl(settings);
+  if (base.empty())
+    return {};
+
+  // Build XMLTV URL: http://domain:port/xmltv.php?username=X&password=Y
+  return base + "/xmltv.php?username=" + UrlEncode(settings.username) +
+         "&password=" + UrlEncode(settings.password);
+}
+
 std::string EffectiveUserAgent(const xtream::Settings& settings)
 {
   if (!settings.enableUserAgentSpoofing)
@@ -220,12 +190,22 @@ std::string RedactUrlCredentials(const std::string& url)
   return out;
 }
 
-bool ReadAll(kodi::vfs::CFile& file, std::string& out, size_t maxBytes)
+// `cancelled`, when set, is polled between reads; a cancelled read returns false with
+// `out` cleared.
+bool ReadAll(kodi::vfs::CFile& file,
+             std::string& out,
+             size_t maxBytes,
+             const std::function<bool()>& cancelled = {})
 {
   out.clear();
   char buf[16 * 1024];
   while (true)
   {
+    if (cancelled && cancelled())
+    {
+      out.clear();
+      return false;
+    }
     // Use int for portability across compilers (MSVC).
     const int n = file.Read(buf, sizeof(buf));
     if (n <= 0)
@@ -242,33 +222,56 @@ bool ReadAll(kodi::vfs::CFile& file, std::string& out)
   return ReadAll(file, out, std::numeric_limits<size_t>::max());
 }
 
-bool IsHttpStatusOk(const std::string& protocol)
+int HttpStatusCode(const std::string& protocol)
 {
   // protocol string looks like "HTTP/1.1 200 OK" or empty on some transports.
   const size_t firstSpace = protocol.find(' ');
   if (firstSpace == std::string::npos)
-    return false;
+    return 0;
   const size_t secondSpace = protocol.find(' ', firstSpace + 1);
   if (secondSpace == std::string::npos || secondSpace <= firstSpace + 1)
-    return false;
+    return 0;
 
   const std::string codeStr = protocol.substr(firstSpace + 1, secondSpace - firstSpace - 1);
   try
   {
-    const int code = std::stoi(codeStr);
-    return code >= 200 && code < 300;
+    return std::stoi(codeStr);
   }
   catch (...)
   {
-    return false;
+    return 0;
+  }
+}
+
+bool IsHttpStatusOk(const std::string& protocol)
+{
+  const int code = HttpStatusCode(protocol);
+  return code >= 200 && code < 300;
+}
+
+constexpr uint64_t kFnvOffset = 14695981039346656037ULL;
+
+// FNV-1a 64-bit, resumable by passing the previous result as `h`.
+uint64_t DeterministicHash64(std::string_view s, uint64_t h = kFnvOffset)
+{
+  constexpr uint64_t kPrime = 1099511628211ULL;
+  for (unsigned char c : s)
+  {
+    h ^= static_cast<uint64_t>(c);
+    h *= kPrime;
   }
+  return h;
 }
 
 struct HttpResult
 {
   bool ok = false;
+  int status = 0;
   std::string protocol;
   std::string body;
+  std::string etag;
+  std::string lastModified;
+  bool cancelled = false;
 };
 
 bool ReadVfsTextFile(const std::string& url, std::string& out)
@@ -346,16 +349,13 @@ bool ExtractSettingBool(const std::string& xml, const char* id, bool& out)
   return false;
 }
 
-HttpResult HttpGet(const std::string& url,
-                   const std::string& userAgent,
-                   int timeoutSeconds)
+bool OpenHttpGet(kodi::vfs::CFile& file,
+                 const std::string& url,
+                 const std::string& userAgent,
+                 int timeoutSeconds,
+                 bool acceptCompressed = false,
+                 const xtream::XmltvValidators* conditional = nullptr)
 {
-  HttpResult result;
-
-  const std::string redacted = RedactUrlCredentials(url);
-  kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: HTTP GET %s", redacted.c_str());
-
-  kodi::vfs::CFile file;
   file.CURLCreate(url);
 
   if (!userAgent.empty())
@@ -371,17 +371,66 @@ HttpResult HttpGet(const std::string& url,
   // Be tolerant of providers that redirect.
   file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "followlocation", "1");
 
-  if (!file.CURLOpen(0))
+  // curl inflates Content-Encoding as it reads, so callers still stream plain bytes.
+  if (acceptCompressed)
+    file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "acceptencoding", "gzip, deflate");
+
+  if (conditional)
+  {
+    if (!conditional->etag.empty())
+      file.CURLAddOption(ADDON_CURL_OPTION_HEADER, "If-None-Match", conditional->etag);
+    if (!conditional->lastModified.empty())
+      file.CURLAddOption(ADDON_CURL_OPTION_HEADER, "If-Modified-Since", conditional->lastModified);
+  }
+
+  return file.CURLOpen(0);
+}
+
+void ReadResponseValidators(kodi::vfs::CFile& file, std::string& etag, std::string& lastModified)
+{
+  etag = Trim(file.GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_HEADER, "ETag"));
+  lastModified = Trim(file.GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_HEADER, "Last-Modified"));
+}
+
+HttpResult HttpGet(const std::string& url,
+                   const std::string& userAgent,
+                   int timeoutSeconds,
+                   bool acceptCompressed = false,
+                   const xtream::XmltvValidators* conditional = nullptr,
+                   const std::function<bool()>& cancelled = {})
+{
+  HttpResult result;
+
+  const std::string redacted = RedactUrlCredentials(url);
+  kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: HTTP GET %s", redacted.c_str());
+
+  kodi::vfs::CFile file;
+  if (!OpenHttpGet(file, url, userAgent, timeoutSeconds, acceptCompressed, conditional))
     return result;
 
   result.protocol = file.GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_PROTOCOL, "");
-  if (!ReadAll(file, result.body, kMaxHttpBodyBytes))
+  result.status = HttpStatusCode(result.protocol);
+  if (conditional)
   {
+    ReadResponseValidators(file, result.etag, result.lastModified);
+    if (result.status == 304)
+      return result;
+  }
+
+  if (!ReadAll(file, result.body, kMaxHttpBodyBytes, cancelled))
+  {
+    if (cancelled && cancelled())
+    {
+      result.cancelled = true;
+      return result;
+    }
     kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: HTTP response exceeded %zu bytes for %s",
               kMaxHttpBodyBytes, redacted.c_str());
     result.protocol = result.protocol.empty() ? std::string("Body too large") : result.protocol;
     return result;
   }
+  xtream::perf::Add(xtream::perf::Counter::HttpBytes, result.body.size());
+  xtream::perf::NotePeak(xtream::perf::Peak::HttpBody, result.body.size());
 
   const bool looksHttpOk = IsHttpStatusOk(result.protocol);
   result.ok = looksHttpOk;
@@ -529,66 +578,6 @@ bool ExtractIntField(std::string_view obj, const std::string& key, int& out)
   return ParseIntAt(obj, pos + 1, out);
 }
 
-bool ExtractBoolField(std::string_view obj, const std::string& key, bool& out)
-{
-  size_t pos = 0;
-  if (!FindKeyPos(obj, key, pos))
-    return false;
-  pos = obj.find(':', pos);
-  if (pos == std::string::npos)
-    return false;
-  ++pos;
-  while (pos < obj.size() && std::isspace(static_cast<unsigned char>(obj[pos])))
-    ++pos;
-  if (pos >= obj.size())
-    return false;
-
-  // Check for boolean literals
-  if (obj.substr(pos, 4) == "true")
-  {
-    out = true;
-    return true;
-  }
-  if (obj.substr(pos, 5) == "false")
-  {
-    out = false;
-    return true;
-  }
-
-  // Check for numeric representation (1 = true, 0 = false)
-  if (obj[pos] == '1')
-  {
-    out = true;
-    return true;
-  }
-  if (obj[pos] == '0')
-  {
-    out = false;
-    return true;
-  }
-
-  // Check for string representation
-  if (obj[pos] == '"')
-  {
-    ++pos;
-    if (pos < obj.size())
-    {
-      if (obj[pos] == '1')
-      {
-        out = true;
-        return true;
-      }
-      if (obj[pos] == '0')
-      {
-        out = false;
-        return true;
-      }
-    }
-  }
-
-  return false;
-}
-
 bool ExtractStringField(std::string_view obj, const std::string& key, std::string& out)
 {
   size_t pos = 0;
@@ -802,17 +791,37 @@ namespace xtream
 Settings LoadSettings()
 {
   Settings s;
-  kodi::addon::GetSettingString("server", s.server);
-  kodi::addon::GetSettingInt("port", s.port);
-  kodi::addon::GetSettingString("username", s.username);
-  kodi::addon::GetSettingString("password", s.password);
-  kodi::addon::GetSettingString("dispatcharr_password", s.dispatcharrPassword);
-  kodi::addon::GetSettingInt("timeout_seconds", s.timeoutSeconds);
-  kodi::addon::GetSettingInt("catchup_start_offset_hours", s.catchupStartOffsetHours);
-  kodi::addon::GetSettingBoolean("enable_user_agent_spoofing", s.enableUserAgentSpoofing);
-  kodi::addon::GetSettingString("custom_user_agent", s.customUserAgent);
-  kodi::addon::GetSettingBoolean("enable_play_from_start", s.enablePlayFromStart);
-  kodi::addon::GetSettingBoolean("use_ffmpegdirect", s.useFFmpegDirect);
+  s.server = kodi::addon::GetSettingString("server", s.server);
+  s.port = kodi::addon::GetSettingInt("port", s.port);
+  s.username = kodi::addon::GetSettingString("username", s.username);
+  s.password = kodi::addon::GetSettingString("password", s.password);
+  s.dispatcharrPassword = kodi::addon::GetSettingString("dispatcharr_password", s.dispatcharrPassword);
+  s.timeoutSeconds = kodi::addon::GetSettingInt("timeout_seconds", s.timeoutSeconds);
+  s.maxParallelRequests = kodi::addon::GetSettingInt("max_parallel_requests", s.maxParallelRequests);
+  s.catchupStartOffsetHours = kodi::addon::GetSettingInt("catchup_start_offset_hours", s.catchupStartOffsetHours);
+  s.enableUserAgentSpoofing = kodi::addon::GetSettingBoolean("enable_user_agent_spoofing", s.enableUserAgentSpoofing);
+  s.customUserAgent = kodi::addon::GetSettingString("custom_user_agent", s.customUserAgent);
+  s.enablePlayFromStart = kodi::addon::GetSettingBoolean("enable_play_from_start", s.enablePlayFromStart);
+  s.useFFmpegDirect = kodi::addon::GetSettingBoolean("use_ffmpegdirect", s.useFFmpegDirect);
+  s.fastZapping = kodi::addon::GetSettingBoolean("fast_zapping", s.fastZapping);
+  s.httpCompression = kodi::addon::GetSettingBoolean("http_compression", s.httpCompression);
+  s.xmltvUrl = kodi::addon::GetSettingString("xmltv_url", s.xmltvUrl);
+  s.xmltvExtraUrls = kodi::addon::GetSettingString("xmltv_extra_urls", s.xmltvExtraUrls);
+  s.epgStreamingParse = kodi::addon::GetSettingBoolean("epg_streaming_parse", s.epgStreamingParse);
+  s.epgDaysPast = kodi::addon::GetSettingInt("epg_days_past", s.epgDaysPast);
+  s.epgDaysFuture = kodi::addon::GetSettingInt("epg_days_future", s.epgDaysFuture);
+  s.epgLazyText = kodi::addon::GetSettingBoolean("epg_lazy_text", s.epgLazyText);
+  s.epgParseThreads = kodi::addon::GetSettingInt("epg_parse_threads", s.epgParseThreads);
+  s.memoryBudgetMb = kodi::addon::GetSettingInt("memory_budget_mb", s.memoryBudgetMb);
+  s.channelRefreshMinutes = kodi::addon::GetSettingInt("channel_refresh_minutes", s.channelRefreshMinutes);
+  s.epgRefreshMinutes = kodi::addon::GetSettingInt("epg_refresh_minutes", s.epgRefreshMinutes);
+  s.streamFormat = kodi::addon::GetSettingString("stream_format", s.streamFormat);
+  s.channelNumbering = kodi::addon::GetSettingString("channel_numbering", s.channelNumbering);
+  s.channelFilterPatterns = kodi::addon::GetSettingString("channel_filter_patterns", s.channelFilterPatterns);
+  s.categoryFilterMode = kodi::addon::GetSettingString("category_filter_mode", s.categoryFilterMode);
+  s.categoryFilterPatterns = kodi::addon::GetSettingString("category_filter_patterns", s.categoryFilterPatterns);
+  s.filterChannelSeparators =
+      kodi::addon::GetSettingBoolean("filter_channel_separators", s.filterChannelSeparators);
 
   // Kodi sometimes doesn't transfer settings to binary addons early during startup.
   // Always read persisted settings.xml from addon_data and overlay any values found.
@@ -831,14 +840,47 @@ Settings LoadSettings()
       if (ExtractSettingValue(xml, "dispatcharr_password", tmp))
         s.dispatcharrPassword = tmp;
       ExtractSettingInt(xml, "timeout_seconds", s.timeoutSeconds);
+      ExtractSettingInt(xml, "max_parallel_requests", s.maxParallelRequests);
       ExtractSettingInt(xml, "catchup_start_offset_hours", s.catchupStartOffsetHours);
       ExtractSettingBool(xml, "enable_user_agent_spoofing", s.enableUserAgentSpoofing);
       if (ExtractSettingValue(xml, "custom_user_agent", tmp))
         s.customUserAgent = tmp;
       ExtractSettingBool(xml, "enable_play_from_start", s.enablePlayFromStart);
       ExtractSettingBool(xml, "use_ffmpegdirect", s.useFFmpegDirect);
+      ExtractSettingBool(xml, "fast_zapping", s.fastZapping);
+      ExtractSettingBool(xml, "http_compression", s.httpCompression);
+      if (ExtractSettingValue(xml, "xmltv_url", tmp))
+        s.xmltvUrl = tmp;
+      if (ExtractSettingValue(xml, "xmltv_extra_urls", tmp))
+        s.xmltvExtraUrls = tmp;
+      ExtractSettingBool(xml, "epg_streaming_parse", s.epgStreamingParse);
+      ExtractSettingInt(xml, "epg_days_past", s.epgDaysPast);
+      ExtractSettingInt(xml, "epg_days_future", s.epgDaysFuture);
+      ExtractSettingBool(xml, "epg_lazy_text", s.epgLazyText);
+      ExtractSettingInt(xml, "epg_parse_threads", s.epgParseThreads);
+      ExtractSettingInt(xml, "memory_budget_mb", s.memoryBudgetMb);
+      ExtractSettingInt(xml, "channel_refresh_minutes", s.channelRefreshMinutes);
+      ExtractSettingInt(xml, "epg_refresh_minutes", s.epgRefreshMinutes);
+      if (ExtractSettingValue(xml, "stream_format", tmp) && !tmp.empty())
+        s.streamFormat = tmp;
+      if (ExtractSettingValue(xml, "channel_numbering", tmp) && !tmp.empty())
+        s.channelNumbering = tmp;
+      if (ExtractSettingValue(xml, "channel_filter_patterns", tmp))
+        s.channelFilterPatterns = tmp;
+      if (ExtractSettingValue(xml, "category_filter_mode", tmp) && !tmp.empty())
+        s.categoryFilterMode = tmp;
+      if (ExtractSettingValue(xml, "category_filter_patterns", tmp))
+        s.categoryFilterPatterns = tmp;
+      ExtractSettingBool(xml, "filter_channel_separators", s.filterChannelSeparators);
     }
   }
+  s.maxParallelRequests = std::max(1, std::min(s.maxParallelRequests, 16));
+  s.channelRefreshMinutes = std::max(0, s.channelRefreshMinutes);
+  s.epgRefreshMinutes = std::max(0, s.epgRefreshMinutes);
+  s.epgDaysPast = std::max(0, std::min(s.epgDaysPast, 31));
+  s.epgDaysFuture = std::max(0, std::min(s.epgDaysFuture, 31));
+  s.epgParseThreads = std::max(0, std::min(s.epgParseThreads, 16));
+  s.memoryBudgetMb = std::max(0, std::min(s.memoryBudgetMb, 65536));
   return s;
 }
 
@@ -864,6 +906,7 @@ TestResult TestConnection(const Settings& settings)
 
 FetchResult FetchLiveCategories(const Settings& settings, std::vector<LiveCategory>& out)
 {
+  const perf::ScopedStage timing(perf::Stage::Categories);
   out.clear();
 
   const std::string url = BuildPlayerApiUrlWithAction(settings, "get_live_categories");
@@ -871,7 +914,7 @@ FetchResult FetchLiveCategories(const Settings& settings, std::vector<LiveCatego
     return {false, "Failed to build categories URL"};
 
   const std::string ua = EffectiveUserAgent(settings);
-  const HttpResult http = HttpGet(url, ua, settings.timeoutSeconds);
+  const HttpResult http = HttpGet(url, ua, settings.timeoutSeconds, settings.httpCompression);
   if (!http.ok)
     return {false, http.protocol.empty() ? std::string("Failed to fetch categories") : http.protocol};
 
@@ -891,9 +934,9 @@ FetchResult FetchLiveCategories(const Settings& settings, std::vector<LiveCatego
   return {true, http.protocol.empty() ? std::string("OK") : http.protocol};
 }
 
-FetchResult FetchLiveStreams(const Settings& settings, int categoryId, std::vector<LiveStream>& out)
+FetchResult FetchLiveStreams(const Settings& settings, int categoryId, StreamTable& out)
 {
-  out.clear();
+  out = StreamTable();
 
   std::string url = BuildPlayerApiUrlWithAction(settings, "get_live_streams");
   if (url.empty())
@@ -905,38 +948,103 @@ FetchResult FetchLiveStreams(const Settings& settings, int categoryId, std::vect
   }
 
   const std::string ua = EffectiveUserAgent(settings);
-  const HttpResult http = HttpGet(url, ua, settings.timeoutSeconds);
+  HttpResult http;
+  {
+    const perf::ScopedStage timing(perf::Stage::StreamFetch);
+    http = HttpGet(url, ua, settings.timeoutSeconds, settings.httpCompression);
+  }
   if (!http.ok)
     return {false, http.protocol.empty() ? std::string("Failed to fetch streams") : http.protocol};
 
-  if (!ForEachTopLevelObjectSpan(http.body, [&](size_t start, size_t end) {
-        std::string_view obj(http.body.data() + start, end - start);
-        LiveStream s;
-        if (!ExtractIntField(obj, "stream_id", s.id))
-          return;
-        ExtractIntField(obj, "category_id", s.categoryId);
-        ExtractIntField(obj, "num", s.number);
-        ExtractStringField(obj, "name", s.name);
-        ExtractStringField(obj, "stream_icon", s.icon);
-        ExtractStringField(obj, "epg_channel_id", s.epgChannelId);
-        ExtractBoolField(obj, "tv_archive", s.tvArchive);
-        ExtractIntField(obj, "tv_archive_duration", s.tvArchiveDuration);
-        out.push_back(std::move(s));
-      }))
+  const perf::ScopedStage timing(perf::Stage::StreamParse);
+  // A stream object is a few hundred bytes of JSON, of which names, icons and EPG ids
+  // are a fraction; sizing up front avoids regrowing either buffer for large lists.
+  StreamTableBuilder builder;
+  builder.Reserve(http.body.size() / 384, http.body.size() / 3);
+  if (!ParseLiveStreamsJson(http.body, builder))
     return {false, "Streams response was not a JSON array"};
 
-  if (out.empty())
+  if (builder.size() == 0)
     return {false, "No streams parsed"};
 
+  perf::Add(perf::Counter::Streams, builder.size());
+  out = builder.Build();
+
   return {true, http.protocol.empty() ? std::string("OK") : http.protocol};
 }
 
+FetchResult FetchLiveStreamsForCategories(const Settings& settings,
+                                          const std::vector<int>& categoryIds,
+                                          StreamTable& out)
+{
+  out = StreamTable();
+  if (categoryIds.empty())
+    return {true, "OK"};
+
+  // Each slot is written by exactly one worker; merging afterwards keeps the order stable.
+  std::vector<StreamTable> perCategory(categoryIds.size());
+  std::vector<FetchResult> results(categoryIds.size());
+  std::atomic<size_t> next{0};
+  std::atomic<bool> failed{false};
+
+  auto work = [&]() {
+    while (!failed.load())
+    {
+      const size_t i = next.fetch_add(1);
+      if (i >= categoryIds.size())
+        return;
+      results[i] = FetchLiveStreams(settings, categoryIds[i], perCategory[i]);
+      if (!results[i].ok)
+        failed.store(true);
+    }
+  };
+
+  const size_t workers = std::min(categoryIds.size(),
+                                  static_cast<size_t>(std::max(1, settings.maxParallelRequests)));
+  std::vector<std::thread> threads;
+  threads.reserve(workers - 1);
+  for (size_t t = 1; t < workers; ++t)
+    threads.emplace_back(work);
+  work();
+  for (auto& t : threads)
+    t.join();
+
+  // Slots after a failure may never have been fetched; report the earliest failure.
+  const size_t claimed = std::min(next.load(), categoryIds.size());
+  for (size_t i = 0; i < claimed; ++i)
+  {
+    if (!results[i].ok)
+    {
+      kodi::Log(ADDON_LOG_WARNING, "pvr.dispatcharr: category %d stream fetch failed (%s)",
+                categoryIds[i], results[i].details.c_str());
+      return results[i];
+    }
+  }
+
+  size_t streams = 0;
+  size_t textBytes = 0;
+  for (const auto& table : perCategory)
+  {
+    streams += table.size();
+    textBytes += table.TextBytes();
+  }
+  StreamTableBuilder merged;
+  merged.Reserve(streams, textBytes);
+  for (const auto& table : perCategory)
+    merged.Append(table);
+  out = merged.Build();
+
+  kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: fetched %zu streams from %zu categories (%zu parallel)",
+            out.size(), categoryIds.size(), workers);
+  return {true, "OK"};
+}
+
 FetchResult FetchAllLiveStreams(const Settings& settings,
                                 std::vector<LiveCategory>& categories,
-                                std::vector<LiveStream>& streams)
+                                StreamTable& streams)
 {
   categories.clear();
-  streams.clear();
+  streams = StreamTable();
 
   std::vector<LiveCategory> cats;
   const FetchResult catsRes = FetchLiveCategories(settings, cats);
@@ -944,7 +1052,7 @@ FetchResult FetchAllLiveStreams(const Settings& settings,
     return catsRes;
 
   // Prefer single-call variant: vastly faster and scales to 40k+ channels.
-  std::vector<LiveStream> streamsAll;
+  StreamTable streamsAll;
   const FetchResult allRes = FetchLiveStreams(settings, 0, streamsAll);
   if (allRes.ok)
   {
@@ -953,17 +1061,15 @@ FetchResult FetchAllLiveStreams(const Settings& settings,
     return {true, allRes.details};
   }
 
-  std::vector<LiveStream> all;
+  std::vector<int> catIds;
+  catIds.reserve(cats.size());
   for (const auto& c : cats)
-  {
-    std::vector<LiveStream> s;
-    const FetchResult r = FetchLiveStreams(settings, c.id, s);
-    if (!r.ok)
-    {
-      return r;
-    }
-    all.insert(all.end(), s.begin(), s.end());
-  }
+    catIds.push_back(c.id);
+
+  StreamTable all;
+  const FetchResult r = FetchLiveStreamsForCategories(settings, catIds, all);
+  if (!r.ok)
+    return r;
 
   categories = std::move(cats);
   streams = std::move(all);
@@ -1052,314 +1158,261 @@ std::string BuildCatchupUrlTemplate(const Settings& settings, int streamId, int
   return AppendUserAgentHeader(url, settings);
 }
 
-FetchResult FetchXMLTVEpg(const Settings& settings, std::string& xmltvData)
+std::vector<std::string> XmltvSourceUrls(const Settings& settings)
+{
+  std::vector<std::string> urls{BuildXmltvUrl(settings)};
+  const std::string& extra = settings.xmltvExtraUrls;
+  size_t start = 0;
+  while (start <= extra.size() && urls.size() < kMaxXmltvSources)
+  {
+    size_t end = extra.find_first_of(",\n", start);
+    if (end == std::string::npos)
+      end = extra.size();
+    const std::string url = Trim(extra.substr(start, end - start));
+    if (!url.empty() && std::find(urls.begin(), urls.end(), url) == urls.end())
+      urls.push_back(url);
+    start = end + 1;
+  }
+  return urls;
+}
+
+FetchResult FetchXMLTVEpg(const Settings& settings,
+                          std::string& xmltvData,
+                          XmltvValidators* validators,
+                          const std::function<bool()>& cancelled)
+{
+  return FetchXMLTVEpg(settings, BuildXmltvUrl(settings), xmltvData, validators, cancelled);
+}
+
+FetchResult FetchXMLTVEpg(const Settings& settings,
+                          const std::string& url,
+                          std::string& xmltvData,
+                          XmltvValidators* validators,
+                          const std::function<bool()>& cancelled)
 {
   xmltvData.clear();
 
-  const std::string base = BuildBaseUrl(settings);
-  if (base.empty())
+  if (url.empty())
     return {false, "Failed to build base URL"};
 
-  // Build XMLTV URL: http://domain:port/xmltv.php?username=X&password=Y
-  std::string url = base + "/xmltv.php?username=" + UrlEncode(settings.username) +
-                    "&password=" + UrlEncode(settings.password);
-
   const std::string ua = EffectiveUserAgent(settings);
-  const HttpResult http = HttpGet(url, ua, settings.timeoutSeconds);
-  
+  HttpResult http = HttpGet(url, ua, settings.timeoutSeconds, settings.httpCompression, validators, cancelled);
+  if (http.cancelled)
+    return {false, "XMLTV fetch cancelled"};
+
+  if (validators && http.status == 304)
+    return {true, http.protocol, true};
+
   if (!http.ok)
     return {false, http.protocol.empty() ? std::string("Failed to fetch XMLTV") : http.protocol};
 
-  xmltvData = http.body;
+  xmltvData = std::move(http.body);
+  perf::Add(perf::Counter::XmltvBytes, xmltvData.size());
   
   // Basic validation - check if it looks like XML
   if (xmltvData.empty())
     return {false, "XMLTV response is empty"};
-    
-  if (xmltvData.find("<?xml") == std::string::npos && xmltvData.find("<tv") == std::string::npos)
-    return {false, "XMLTV response doesn't appear to be XML"};
-
-  return {true, http.protocol.empty() ? std::string("OK") : http.protocol};
-}
-
-bool ParseXMLTV(const std::string& xmltvData, 
-                const std::vector<LiveStream>& streams,
-                std::vector<ChannelEpg>& channelEpgs)
-{
-  channelEpgs.clear();
-
-  if (xmltvData.empty())
-    return false;
 
-  // Parse XML
-  pugi::xml_document doc;
-  std::vector<char> xmlBuffer(xmltvData.begin(), xmltvData.end());
-  xmlBuffer.push_back('\0');
-  pugi::xml_parse_result result = doc.load_buffer_inplace(
-      xmlBuffer.data(),
-      xmlBuffer.size() - 1,
-      pugi::parse_default | pugi::parse_declaration);
-  
-  if (!result)
-  {
-    kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: Failed to parse XMLTV: %s (offset: %d)", 
-              result.description(), static_cast<int>(result.offset));
-    return false;
-  }
-
-  const auto& tvNode = doc.child("tv");
-  if (!tvNode)
+  // The hash covers the body as transferred, matching the streaming path.
+  bool sameBody = false;
+  if (validators)
   {
-    kodi::Log(ADDON_LOG_ERROR, "pvr.dispatcharr: XMLTV missing <tv> root element");
-    return false;
+    const uint64_t bodyHash = DeterministicHash64(xmltvData);
+    sameBody = validators->bodyHash != 0 && validators->bodyHash == bodyHash;
+    validators->etag = http.etag;
+    validators->lastModified = http.lastModified;
+    validators->bodyHash = bodyHash;
   }
 
-  // Create a lookup map of stream ID to stream name for matching
-  std::unordered_map<int, std::string> streamIdToName;
-  std::unordered_map<std::string, std::vector<int>> streamNameToIds;
-  std::unordered_map<std::string, std::vector<int>> xmltvIdToStreamIds;
-  for (const auto& stream : streams)
+  if (LooksGzip(xmltvData.data(), xmltvData.size()))
   {
-    if (stream.id > 0)
-    {
-      streamIdToName[stream.id] = stream.name;
-      const std::string normName = NormalizeChannelNameForEpg(stream.name);
-      if (!normName.empty())
-        streamNameToIds[ToLower(normName)].push_back(stream.id);
-
-      if (!stream.epgChannelId.empty())
-        xmltvIdToStreamIds[stream.epgChannelId].push_back(stream.id);
-    }
+    if (!GzipSupported())
+      return {false, "XMLTV is gzip compressed but this build has no zlib support"};
+    if (sameBody)
+      return {true, "body unchanged", true};
+    std::string inflated;
+    if (!GunzipString(xmltvData, inflated))
+      return {false, "Failed to decompress gzip XMLTV"};
+    kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: inflated gzip XMLTV %zu -> %zu bytes",
+              xmltvData.size(), inflated.size());
+    xmltvData = std::move(inflated);
   }
-
-  // First pass: Parse channel elements and match to our streams
-  std::unordered_map<std::string, ChannelEpg> epgMap;
-  std::unordered_map<std::string, std::vector<std::string>> xmltvIdToMappedIds;
-  int totalXmltvChannels = 0;
-  int mappedByNumericId = 0;
-  int mappedByEpgId = 0;
-  int mappedByName = 0;
-  int unmapped = 0;
-  
-  for (const auto& channelNode : tvNode.children("channel"))
-  {
-    const char* idAttr = channelNode.attribute("id").value();
-    if (!idAttr || idAttr[0] == '\0')
-      continue;
-
-    ChannelEpg epg;
-    const std::string xmltvId = idAttr;
-    totalXmltvChannels++;
-    
-    // Get display name
-    const auto& displayNameNode = channelNode.child("display-name");
-    std::string displayNameNormalized;
-    if (displayNameNode)
-    {
-      epg.displayName = displayNameNode.child_value();
-      displayNameNormalized = NormalizeChannelNameForEpg(epg.displayName);
-    }
+  perf::NotePeak(perf::Peak::XmltvBody, xmltvData.size());
     
-    // Get icon
-    const auto& iconNode = channelNode.child("icon");
-    if (iconNode)
-    {
-      const char* srcAttr = iconNode.attribute("src").value();
-      if (srcAttr && srcAttr[0] != '\0')
-        epg.iconPath = srcAttr;
-    }
+  if (xmltvData.find("<?xml") == std::string::npos && xmltvData.find("<tv") == std::string::npos)
+    return {false, "XMLTV response doesn't appear to be XML"};
 
-    // Map XMLTV channel ID or display-name to stream ID for Kodi EPG lookup
-    std::vector<std::string> mappedIds;
-    bool matched = false;
+  if (sameBody)
+    return {true, "body unchanged", true};
 
-    // Prefer explicit epg_channel_id mapping from stream list
-    const auto epgIdIt = xmltvIdToStreamIds.find(xmltvId);
-    if (epgIdIt != xmltvIdToStreamIds.end() && !epgIdIt->second.empty())
-    {
-      for (int streamId : epgIdIt->second)
-        mappedIds.push_back(std::to_string(streamId));
-      matched = true;
-      mappedByEpgId++;
-    }
+  return {true, http.protocol.empty() ? std::string("OK") : http.protocol};
+}
 
-    char* end = nullptr;
-    const long numericId = std::strtol(xmltvId.c_str(), &end, 10);
-    if (!matched && end && *end == '\0' && numericId > 0)
-    {
-      const int streamId = static_cast<int>(numericId);
-      if (streamIdToName.find(streamId) != streamIdToName.end())
-      {
-        mappedIds.push_back(std::to_string(streamId));
-        matched = true;
-        mappedByNumericId++;
-      }
-    }
+FetchResult FetchAndParseXMLTVGuide(const Settings& settings,
+                                    XmltvGuide& guide,
+                                    XmltvValidators* validators,
+                                    const std::function<bool()>& cancelled,
+                                    const XmltvParseOptions* options)
+{
+  return FetchAndParseXMLTVGuide(settings, BuildXmltvUrl(settings), guide, validators, cancelled, options);
+}
 
-    if (!matched && !displayNameNormalized.empty())
-    {
-      const auto nameIt = streamNameToIds.find(ToLower(displayNameNormalized));
-      if (nameIt != streamNameToIds.end() && !nameIt->second.empty())
-      {
-        for (int streamId : nameIt->second)
-          mappedIds.push_back(std::to_string(streamId));
-        matched = true;
-        mappedByName++;
-      }
-    }
+FetchResult FetchAndParseXMLTVGuide(const Settings& settings,
+                                    const std::string& url,
+                                    XmltvGuide& guide,
+                                    XmltvValidators* validators,
+                                    const std::function<bool()>& cancelled,
+                                    const XmltvParseOptions* options)
+{
+  if (url.empty())
+    return {false, "Failed to build base URL"};
 
-    if (!matched)
-      unmapped++;
+  const std::string redacted = RedactUrlCredentials(url);
+  kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: HTTP GET %s (streaming)", redacted.c_str());
 
-    if (mappedIds.empty())
+  kodi::vfs::CFile file;
+  if (!OpenHttpGet(file, url, EffectiveUserAgent(settings), settings.timeoutSeconds,
+                   settings.httpCompression, validators))
+    return {false, "Failed to fetch XMLTV"};
+
+  const std::string protocol = file.GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_PROTOCOL, "");
+  if (validators && HttpStatusCode(protocol) == 304)
+    return {true, protocol, true};
+  if (!IsHttpStatusOk(protocol))
+    return {false, protocol.empty() ? std::string("Failed to fetch XMLTV") : protocol};
+
+  // No body size cap here: the parser only ever holds one element, not the document.
+  // The body hash is taken on the fly; an identical body still costs the parse (there
+  // is no buffered copy to check first) but the result is dropped without publishing.
+  // A body that is itself a gzip file (xmltv.xml.gz) is inflated chunk by chunk on
+  // its way into the parser.
+  uint64_t totalBytes = 0;
+  uint64_t bodyHash = kFnvOffset;
+  bool aborted = false;
+  XmltvGuide parsedGuide;
+  const XmltvParseOptions noOptions;
+  AutoInflateReader reader([&](char* buf, size_t size) -> int64_t {
+    if (cancelled && cancelled())
     {
-      // Keep XMLTV id to allow debugging but it won't match any stream id.
-      epg.id = xmltvId;
-      epgMap[epg.id] = epg;
-      xmltvIdToMappedIds[xmltvId] = {xmltvId};
-      continue;
+      aborted = true;
+      return -1;
     }
-
-    xmltvIdToMappedIds[xmltvId] = mappedIds;
-    for (const auto& mappedId : mappedIds)
+    const ssize_t n = file.Read(buf, size);
+    if (n > 0)
     {
-      ChannelEpg& target = epgMap[mappedId];
-      if (target.id.empty())
-        target.id = mappedId;
-      if (target.displayName.empty())
-        target.displayName = epg.displayName;
-      if (target.iconPath.empty())
-        target.iconPath = epg.iconPath;
+      totalBytes += static_cast<uint64_t>(n);
+      if (validators)
+        bodyHash = DeterministicHash64(std::string_view(buf, static_cast<size_t>(n)), bodyHash);
     }
-  }
-
-  kodi::Log(ADDON_LOG_INFO,
-            "pvr.dispatcharr: XMLTV channel mapping: total=%d, epg_id=%d, numeric=%d, name=%d, unmapped=%d",
-            totalXmltvChannels, mappedByEpgId, mappedByNumericId, mappedByName, unmapped);
-
-  // Second pass: Parse programme elements
-  int programmeCount = 0;
-  
-  for (const auto& programmeNode : tvNode.children("programme"))
+    return static_cast<int64_t>(n);
+  });
+  const bool parsed = ParseXMLTVStream(
+      [&](char* buf, size_t size) -> int64_t { return reader.Read(buf, size); }, parsedGuide,
+      options ? *options : noOptions);
+  perf::Add(perf::Counter::HttpBytes, totalBytes);
+  perf::Add(perf::Counter::XmltvBytes, totalBytes);
+
+  if (aborted)
+    return {false, "XMLTV fetch cancelled"};
+  if (totalBytes == 0)
+    return {false, "XMLTV response is empty"};
+  if (reader.UnsupportedGzip())
+    return {false, "XMLTV is gzip compressed but this build has no zlib support"};
+  if (!parsed)
+    return {false, "Failed to parse XMLTV"};
+  if (reader.IsCompressed())
+    kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: XMLTV was gzip compressed (%llu bytes transferred)",
+              static_cast<unsigned long long>(totalBytes));
+
+  if (validators)
   {
-    const char* channelAttr = programmeNode.attribute("channel").value();
-    if (!channelAttr || channelAttr[0] == '\0')
-      continue;
-
-    const std::string xmltvChannelId = channelAttr;
-    const auto mapIt = xmltvIdToMappedIds.find(xmltvChannelId);
-    if (mapIt == xmltvIdToMappedIds.end() || mapIt->second.empty())
-      continue;
-    
-    EpgEntry entry;
-    entry.channelId = xmltvChannelId;
-
-    // Parse start and stop times (format: YYYYMMDDHHmmss +TZ)
-    const char* startAttr = programmeNode.attribute("start").value();
-    const char* stopAttr = programmeNode.attribute("stop").value();
-    
-    if (startAttr && startAttr[0] != '\0')
-    {
-      // Parse XMLTV time format: 20260121120000 +0000
-      struct tm tm = {};
-      int tzHours = 0, tzMins = 0;
-      char tzSign = '+';
-      if (sscanf(startAttr, "%4d%2d%2d%2d%2d%2d %c%2d%2d", 
-                 &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
-                 &tm.tm_hour, &tm.tm_min, &tm.tm_sec,
-                 &tzSign, &tzHours, &tzMins) >= 6)
-      {
-        tm.tm_year -= 1900;
-        tm.tm_mon -= 1;
-        tm.tm_isdst = 0;
-        // timegm interprets the parsed time as UTC
-        // But the parsed time is actually in the specified timezone (e.g., +0100)
-        // To get the actual UTC time: we need to subtract the offset
-        // Example: "20:00 +0100" means 20:00 in UTC+1 = 19:00 in UTC
-        // timegm gives us 20:00 UTC, so we subtract 1 hour to get 19:00 UTC
-        entry.startTime = timegm(&tm);
-        int tzOffsetSeconds = (tzHours * 3600 + tzMins * 60);
-        if (tzSign == '-')
-          tzOffsetSeconds = -tzOffsetSeconds;
-        entry.startTime -= tzOffsetSeconds;
-      }
-    }
-    
-    if (stopAttr && stopAttr[0] != '\0')
-    {
-      struct tm tm = {};
-      int tzHours = 0, tzMins = 0;
-      char tzSign = '+';
-      if (sscanf(stopAttr, "%4d%2d%2d%2d%2d%2d %c%2d%2d", 
-                 &tm.tm_year, &tm.tm_mon, &tm.tm_mday,
-                 &tm.tm_hour, &tm.tm_min, &tm.tm_sec,
-                 &tzSign, &tzHours, &tzMins) >= 6)
-      {
-        tm.tm_year -= 1900;
-        tm.tm_mon -= 1;
-        tm.tm_isdst = 0;
-        entry.endTime = timegm(&tm);
-        int tzOffsetSeconds = (tzHours * 3600 + tzMins * 60);
-        if (tzSign == '-')
-          tzOffsetSeconds = -tzOffsetSeconds;
-        entry.endTime -= tzOffsetSeconds;
-      }
-    }
-
-    // Skip entries with invalid times
-    if (entry.startTime == 0 || entry.endTime == 0 || entry.endTime <= entry.startTime)
-      continue;
-
-    // Parse title
-    const auto& titleNode = programmeNode.child("title");
-    if (titleNode)
-      entry.title = titleNode.child_value();
-
-    // Parse description
-    const auto& descNode = programmeNode.child("desc");
-    if (descNode)
-      entry.description = descNode.child_value();
-
-    // Parse sub-title (episode name)
-    const auto& subTitleNode = programmeNode.child("sub-title");
-    if (subTitleNode)
-      entry.episodeName = subTitleNode.child_value();
+    const bool sameBody = validators->bodyHash != 0 && validators->bodyHash == bodyHash;
+    ReadResponseValidators(file, validators->etag, validators->lastModified);
+    validators->bodyHash = bodyHash;
+    if (sameBody)
+      return {true, "body unchanged", true};
+  }
 
-    // Parse icon
-    const auto& iconNode = programmeNode.child("icon");
-    if (iconNode)
-    {
-      const char* srcAttr = iconNode.attribute("src").value();
-      if (srcAttr && srcAttr[0] != '\0')
-        entry.iconPath = srcAttr;
-    }
+  guide = std::move(parsedGuide);
+  return {true, protocol.empty() ? std::string("OK") : protocol};
+}
 
-    // Parse category (genre)
-    const auto& categoryNode = programmeNode.child("category");
-    if (categoryNode)
-      entry.genreString = categoryNode.child_value();
+std::string ResolveStreamRedirect(const Settings& settings, const std::string& url)
+{
+  // Kodi "|Header=value" options aren't part of the request; they ride along unchanged.
+  const size_t pipe = url.find('|');
+  const std::string target = url.substr(0, pipe);
+  const std::string options = pipe == std::string::npos ? std::string() : url.substr(pipe);
+  if (target.empty())
+    return {};
 
-    // Add entry to each mapped stream's EPG (keyed by start time)
-    for (const auto& mappedId : mapIt->second)
-    {
-      auto epgIt = epgMap.find(mappedId);
-      if (epgIt == epgMap.end())
-        continue;
-      epgIt->second.entries[entry.startTime] = entry;
-      programmeCount++;
-    }
-  }
+  // A HEAD with redirects off reads only the panel's 3xx answer. Following it would
+  // open the edge stream itself, taking a provider connection slot and spending the
+  // edge token before the player gets to use it.
+  const int timeoutSeconds = std::min(settings.timeoutSeconds > 0 ? settings.timeoutSeconds : 5, 5);
+  const std::string t = std::to_string(timeoutSeconds);
+  const std::string userAgent = EffectiveUserAgent(settings);
+  kodi::vfs::CFile file;
+  file.CURLCreate(target);
+  if (!userAgent.empty())
+    file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "user-agent", userAgent);
+  file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "connection-timeout", t);
+  file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "timeout", t);
+  file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "customrequest", "HEAD");
+  file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "followlocation", "0");
+  file.CURLAddOption(ADDON_CURL_OPTION_PROTOCOL, "redirect-limit", "0");
+  if (!file.CURLOpen(0))
+    return {};
+  const int status = HttpStatusCode(file.GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_PROTOCOL, ""));
+  const std::string location = Trim(file.GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_HEADER, "Location"));
+  file.Close();
+  if (status < 300 || status >= 400 || location.empty())
+    return {};
 
-  // Convert map to vector (only channels with EPG entries)
-  for (const auto& kv : epgMap)
+  // Location may be relative to the panel.
+  std::string resolved;
+  if (location.find("://") != std::string::npos)
+    resolved = location;
+  else
   {
-    if (!kv.second.entries.empty())
-      channelEpgs.push_back(kv.second);
+    const size_t scheme = target.find("://");
+    if (scheme == std::string::npos)
+      return {};
+    if (location.compare(0, 2, "//") == 0)
+      resolved = target.substr(0, scheme + 1) + location;
+    else if (location[0] == '/')
+      resolved = target.substr(0, target.find('/', scheme + 3)) + location;
+    else
+      resolved = target.substr(0, target.rfind('/') + 1) + location;
   }
+  if (resolved == target)
+    return {};
+  kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: stream %s redirects to %s",
+            RedactUrlCredentials(target).c_str(), RedactUrlCredentials(resolved).c_str());
+  return resolved + options;
+}
 
-  kodi::Log(ADDON_LOG_INFO, "pvr.dispatcharr: Parsed XMLTV - %d channels, %d programmes",
-            static_cast<int>(channelEpgs.size()), programmeCount);
+FetchResult FetchIcon(const Settings& settings, const std::string& url, std::string& body)
+{
+  body.clear();
+  // Logged at debug level only: a large list fetches thousands of these.
+  kodi::Log(ADDON_LOG_DEBUG, "pvr.dispatcharr: HTTP GET %s (icon)", RedactUrlCredentials(url).c_str());
 
-  return !channelEpgs.empty();
+  kodi::vfs::CFile file;
+  if (!OpenHttpGet(file, url, EffectiveUserAgent(settings), settings.timeoutSeconds))
+    return {false, "Failed to fetch icon"};
+  const std::string protocol = file.GetPropertyValue(ADDON_FILE_PROPERTY_RESPONSE_PROTOCOL, "");
+  // Some transports report no status line; an empty body still counts as a failure.
+  if (!protocol.empty() && !IsHttpStatusOk(protocol))
+    return {false, protocol};
+  if (!ReadAll(file, body, kMaxIconBytes))
+  {
+    body.clear();
+    return {false, "Icon too large"};
+  }
+  perf::Add(perf::Counter::HttpBytes, body.size());
+  if (body.empty())
+    return {false, "Icon response is empty"};
+  return {true, protocol.empty() ? std::string("OK") : protocol};
 }
 } // namespace xtream
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
 #include <ctime>
 
 namespace xtream
@@ -15,6 +17,7 @@ struct Settings
   std::string password;
   std::string dispatcharrPassword; // Separate password for API
   int timeoutSeconds = 30;
+  int maxParallelRequests = 4;   // per-category stream fetches in flight at once
 
   bool enableUserAgentSpoofing = false;
   std::string customUserAgent;
@@ -22,6 +25,28 @@ struct Settings
   int catchupStartOffsetHours = 0;
   bool enablePlayFromStart = true;
   bool useFFmpegDirect = false;
+  bool fastZapping = false; // resolve the neighbouring channels' stream redirects ahead of a zap
+
+  std::string streamFormat = "ts";           // "ts" or "hls"
+  std::string channelNumbering = "provider"; // "provider" or "sequential"
+  std::string channelFilterPatterns;         // comma-separated channel name patterns ('*' wildcards)
+  std::string categoryFilterMode = "all";    // "all", "include" or "exclude"
+  std::string categoryFilterPatterns;        // comma-separated category name patterns
+  bool filterChannelSeparators = true;       // hide "#####" separator channels
+
+  bool httpCompression = true;   // ask for gzip/deflate transfer encoding
+  std::string xmltvUrl;          // custom XMLTV location (.xml or .xml.gz); empty = provider xmltv.php
+  std::string xmltvExtraUrls;    // comma-separated supplementary XMLTV locations, lower priority
+
+  bool epgStreamingParse = true; // parse XMLTV while downloading instead of buffering it
+  int epgDaysPast = 7;           // keep programmes ending at most this many days ago; 0 = no limit
+  int epgDaysFuture = 7;         // keep programmes starting within this many days; 0 = no limit
+  bool epgLazyText = false;      // keep descriptions and icons on disk until Kodi asks for them
+  int epgParseThreads = 0;       // threads for an in-memory XMLTV parse; 0 = automatic
+  int memoryBudgetMb = 0;        // refreshes switch to leaner guide modes above this; 0 = automatic
+
+  int channelRefreshMinutes = 720; // background channel list reload; 0 = only on demand
+  int epgRefreshMinutes = 240;     // background guide refresh; 0 = only with channel reloads
 };
 
 struct TestResult
@@ -36,68 +61,107 @@ struct LiveCategory
   std::string name;
 };
 
+// Fixed-size stream record. The text views point into the StreamTable that holds the
+// record (stream_table.h) and live as long as that table.
 struct LiveStream
 {
   int id = 0;
   int categoryId = 0;
   int number = 0;
-  std::string name;
-  std::string icon;
-  std::string epgChannelId; // XMLTV channel id from provider (if available)
+  std::string_view name;
+  std::string_view icon;
+  std::string_view epgChannelId; // XMLTV channel id from provider (if available)
   
   // Catchup/Archive support
   bool tvArchive = false;
   int tvArchiveDuration = 0; // Duration in hours
 };
 
-struct EpgEntry
-{
-  std::string channelId;      // Maps to stream ID or tvg-id
-  time_t startTime = 0;
-  time_t endTime = 0;
-  std::string title;
-  std::string description;
-  std::string episodeName;    // Sub-title
-  std::string iconPath;
-  std::string genreString;
-  int genreType = 0;
-  int genreSubType = 0;
-  int year = 0;
-  int starRating = 0;
-  int seasonNumber = -1;
-  int episodeNumber = -1;
-};
-
-struct ChannelEpg
-{
-  std::string id;                          // Channel ID (tvg-id or stream ID)
-  std::string displayName;                 // Channel display name
-  std::string iconPath;                    // Channel icon from EPG
-  std::map<time_t, EpgEntry> entries;      // EPG entries keyed by start time
-};
+class EpgStore;        // epg_store.h
+class StreamTable;     // stream_table.h
+struct XmltvGuide;     // xmltv_parser.h
+struct XmltvParseOptions; // xmltv_parser.h
 
 struct FetchResult
 {
   bool ok = false;
   std::string details;
+  bool unchanged = false; // conditional fetch: the source matches the validators passed in
+};
+
+// Identifies the last XMLTV body that was parsed. etag/lastModified are sent back as
+// If-None-Match/If-Modified-Since; bodyHash catches unchanged bodies from servers that
+// send neither header.
+struct XmltvValidators
+{
+  std::string etag;
+  std::string lastModified;
+  uint64_t bodyHash = 0;
+
+  bool Empty() const { return etag.empty() && lastModified.empty() && bodyHash == 0; }
 };
 
 Settings LoadSettings();
 TestResult TestConnection(const Settings& settings);
 
 FetchResult FetchLiveCategories(const Settings& settings, std::vector<LiveCategory>& out);
-FetchResult FetchLiveStreams(const Settings& settings, int categoryId, std::vector<LiveStream>& out);
+FetchResult FetchLiveStreams(const Settings& settings, int categoryId, StreamTable& out);
+// Fetches several categories with at most settings.maxParallelRequests requests in
+// flight. `out` is concatenated in categoryIds order regardless of completion order.
+// Stops handing out work at the first failure and returns that failure.
+FetchResult FetchLiveStreamsForCategories(const Settings& settings,
+                                          const std::vector<int>& categoryIds,
+                                          StreamTable& out);
 FetchResult FetchAllLiveStreams(const Settings& settings,
                                 std::vector<LiveCategory>& categories,
-                                std::vector<LiveStream>& streams);
+                                StreamTable& streams);
 
 std::string BuildLiveStreamUrl(const Settings& settings, int streamId, const std::string& streamFormat);
 std::string BuildCatchupUrl(const Settings& settings, int streamId, time_t startTime, time_t endTime, const std::string& streamFormat);
 std::string BuildCatchupUrlTemplate(const Settings& settings, int streamId, int durationMinutes, const std::string& streamFormat);
 
-// EPG/XMLTV functions
-FetchResult FetchXMLTVEpg(const Settings& settings, std::string& xmltvData);
-bool ParseXMLTV(const std::string& xmltvData, 
-                const std::vector<LiveStream>& streams,
-                std::vector<ChannelEpg>& channelEpgs);
+// EPG/XMLTV functions (parsers live in xmltv_parser.h)
+constexpr size_t kMaxXmltvSources = 8;
+
+// The guide sources in priority order: the main XMLTV location (custom or xmltv.php,
+// empty when it can't be built) followed by the supplementary ones, duplicates
+// dropped, at most kMaxXmltvSources in all.
+std::vector<std::string> XmltvSourceUrls(const Settings& settings);
+
+// With `validators`, the request is conditional on the values passed in and they are
+// updated from the response. An unchanged source returns ok with `unchanged` set and,
+// for the parsing variant, leaves `guide` untouched. `cancelled` is polled between reads.
+FetchResult FetchXMLTVEpg(const Settings& settings,
+                          std::string& xmltvData,
+                          XmltvValidators* validators = nullptr,
+                          const std::function<bool()>& cancelled = {});
+// The same against `url`, one of XmltvSourceUrls.
+FetchResult FetchXMLTVEpg(const Settings& settings,
+                          const std::string& url,
+                          std::string& xmltvData,
+                          XmltvValidators* validators = nullptr,
+                          const std::function<bool()>& cancelled = {});
+// Parses while downloading into a stream-independent guide (see MapXMLTV), so it can
+// run alongside the stream list fetch. `cancelled` is polled between reads; `options`
+// may be null for a full, in-memory parse.
+FetchResult FetchAndParseXMLTVGuide(const Settings& settings,
+                                    XmltvGuide& guide,
+                                    XmltvValidators* validators = nullptr,
+                                    const std::function<bool()>& cancelled = {},
+                                    const XmltvParseOptions* options = nullptr);
+FetchResult FetchAndParseXMLTVGuide(const Settings& settings,
+                                    const std::string& url,
+                                    XmltvGuide& guide,
+                                    XmltvValidators* validators = nullptr,
+                                    const std::function<bool()>& cancelled = {},
+                                    const XmltvParseOptions* options = nullptr);
+
+// Sends a HEAD for a live stream URL without following redirects and returns the 3xx
+// Location it answers with (with the original "|" options), or empty when it doesn't
+// redirect or the request fails. The target of the redirect is never opened. Used to
+// resolve neighbouring channels ahead of a zap.
+std::string ResolveStreamRedirect(const Settings& settings, const std::string& url);
+
+// Downloads one channel logo into `body` (capped at 2 MB) with the configured user agent.
+FetchResult FetchIcon(const Settings& settings, const std::string& url, std::string& body);
 } // namespace xtream